@@ -0,0 +1,43 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+namespace meta {
+class AST;
+}
+
+namespace meta::analysers {
+
+/**
+ * Infers purity and recursion facts of the functions from the resolved call graph and marks
+ * functions with FuncFlags::pure and FuncFlags::noRecurse. Functions without body are pure only
+ * when annotated with @pure or loaded from a module file with this flag set. Functions with loops
+ * or recursive calls are never inferred pure since their termination is not proven, @pure
+ * annotation promises it.
+ *
+ * Calls in tail position are marked with Call::setTailCall. Throws SemanticError if a function
+ * annotated with @tailrec calls itself not from a tail position or a function annotated with @region
+ * returns an array which could be allocated in its region.
+ *
+ * @note Must be called after resolve and processMeta so that calls are bound to the declarations
+ * and explicit annotations are already applied.
+ */
+void inferAttributes(AST* ast);
+
+} // namespace meta::analysers
@@ -0,0 +1,203 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <typeindex>
+#include <vector>
+
+#include "parser/binaryop.h"
+#include "parser/call.h"
+#include "parser/for.h"
+#include "parser/function.h"
+#include "parser/index.h"
+#include "parser/memberaccess.h"
+#include "parser/metaparser.h"
+#include "parser/newarray.h"
+#include "parser/return.h"
+#include "parser/while.h"
+
+#include "typesystem/type.h"
+
+#include "analysers/attributes.h"
+#include "analysers/semanticerror.h"
+
+namespace meta::analysers {
+namespace {
+
+using CallGraph = std::map<Function*, std::set<Function*>>;
+
+/// Tarjan's algorithm. Components are produced with callees before callers.
+class SCCFinder {
+public:
+    explicit SCCFinder(const CallGraph& graph): mGraph(graph) {
+        for (const auto& node: graph) {
+            if (mIndex.count(node.first) == 0)
+                visit(node.first);
+        }
+    }
+
+    const std::vector<std::vector<Function*>>& components() const {return mComponents;}
+
+private:
+    struct State {
+        size_t index;
+        size_t lowlink;
+        bool onStack;
+    };
+
+    void visit(Function* func) {
+        State& state = mIndex[func] = {mNext, mNext, true};
+        ++mNext;
+        mStack.push_back(func);
+        auto it = mGraph.find(func);
+        if (it != mGraph.end()) {
+            for (Function* callee: it->second) {
+                if (mGraph.count(callee) == 0)
+                    continue; // declarations without body
+                auto calleeState = mIndex.find(callee);
+                if (calleeState == mIndex.end()) {
+                    visit(callee);
+                    state.lowlink = std::min(state.lowlink, mIndex[callee].lowlink);
+                } else if (calleeState->second.onStack)
+                    state.lowlink = std::min(state.lowlink, calleeState->second.index);
+            }
+        }
+        if (state.lowlink != state.index)
+            return;
+        std::vector<Function*> component;
+        Function* member;
+        do {
+            member = mStack.back();
+            mStack.pop_back();
+            mIndex[member].onStack = false;
+            component.push_back(member);
+        } while (member != func);
+        mComponents.push_back(std::move(component));
+    }
+
+    const CallGraph& mGraph;
+    std::map<Function*, State> mIndex;
+    std::vector<Function*> mStack;
+    std::vector<std::vector<Function*>> mComponents;
+    size_t mNext = 0;
+};
+
+void markTailCalls(Function* func) {
+    walk<Return, TopDown>(*func->body(), [](Return* node) {
+        if (node->value() && node->value()->getVisitableType() == std::type_index(typeid(Call)))
+            static_cast<Call*>(node->value())->setTailCall(true);
+        return false;
+    });
+    if (!(func->flags() & FuncFlags::tailRec))
+        return;
+    walk<Call, TopDown>(*func->body(), [func](Call* call) {
+        if (call->function() == func && !call->tailCall())
+            throw SemanticError(
+                call, "Recursive call of '%s' is not in tail position and can't be eliminated as required by @tailrec",
+                func->name()
+            );
+        return true;
+    });
+}
+
+/// Arrays are shared mutable memory: functions allocating or accessing them are not pure. String
+/// concatenation allocates as well.
+bool accessesMemory(Function* func) {
+    const auto ops = func->body()->getChildren<BinaryOp>(infinitDepth);
+    const auto members = func->body()->getChildren<MemberAccess>(infinitDepth);
+    return
+        !func->body()->getChildren<Index>(infinitDepth).empty() ||
+        !func->body()->getChildren<NewArray>(infinitDepth).empty() ||
+        std::any_of(ops.begin(), ops.end(), [](BinaryOp* op) {
+            return op->type() && *op->type() == typesystem::Type{typesystem::Type::String};
+        }) ||
+        // Array reductions read elements while struct members are parts of the values
+        std::any_of(members.begin(), members.end(), [](MemberAccess* member) {
+            return !member->targetStruct() && member->memberName() != "length";
+        })
+    ;
+}
+
+/// Unused results of pure calls are removed by optimizer so only functions known to terminate are pure
+bool mayLoop(Function* func) {
+    return
+        !func->body()->getChildren<While>(infinitDepth).empty() ||
+        !func->body()->getChildren<For>(infinitDepth).empty()
+    ;
+}
+
+} // anonymous namespace
+
+void inferAttributes(AST* ast) {
+    CallGraph graph;
+    std::set<Function*> impure;
+    walk<Function, TopDown>(*ast, [&graph, &impure](Function* func) {
+        if ((func->flags() & FuncFlags::alwaysInline) && (func->flags() & FuncFlags::noInline))
+            throw SemanticError(func, "Function '%s' can't be both @inline and @noinline", func->name());
+        if (!func->body())
+            return false;
+        markTailCalls(func);
+        const bool returnsArray = func->type() && (func->type()->properties() & typesystem::TypeProp::array);
+        if ((func->flags() & FuncFlags::region) && returnsArray)
+            throw SemanticError(func, "Function '%s' can't return arrays allocated in its @region", func->name());
+        if (accessesMemory(func) || mayLoop(func))
+            impure.insert(func);
+        auto& callees = graph[func];
+        walk<Call, TopDown>(*func->body(), [&callees](Call* call) {
+            callees.insert(call->function());
+            return true;
+        });
+        return false;
+    });
+
+    for (const auto& component: SCCFinder{graph}.components()) {
+        // Callees from other components are already processed. Members of the component are
+        // assumed pure unless some of them calls impure function or they call each other: recursion
+        // termination is not proven.
+        bool pure = true;
+        bool recursive = component.size() > 1;
+        bool noRecurse = !recursive;
+        for (Function* func: component) {
+            pure = pure && impure.count(func) == 0;
+            for (Function* callee: graph[func]) {
+                const bool member = std::find(component.begin(), component.end(), callee) != component.end();
+                if (member) {
+                    recursive = true;
+                    noRecurse = false;
+                }
+                else {
+                    pure = pure && (callee->flags() & FuncFlags::pure);
+                    noRecurse = noRecurse && (callee->flags() & FuncFlags::noRecurse);
+                }
+            }
+        }
+        pure = pure && !recursive;
+        for (Function* func: component) {
+            if (pure)
+                func->flags() |= FuncFlags::pure;
+            if (noRecurse)
+                func->flags() |= FuncFlags::noRecurse;
+        }
+    }
+}
+
+} // namespace meta::analysers
@@ -0,0 +1,34 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+namespace meta {
+class AST;
+}
+
+namespace meta::analysers {
+
+/**
+ * Evaluates integer and boolean expressions with constant operands and prunes if statements with
+ * constant conditions replacing folded subtrees with Number and Literal nodes.
+ *
+ * @note Must be called after type checking since it relies on expression types.
+ */
+void foldConstants(AST* ast);
+
+} // namespace meta::analysers
@@ -0,0 +1,409 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <typeindex>
+#include <vector>
+
+#include "utils/types.h"
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+#include "parser/unexpectednode.h"
+
+#include "analysers/constfolder.h"
+
+namespace meta::analysers {
+namespace {
+
+utils::optional<int> intValue(Expression* expr) {
+    if (expr->getVisitableType() != std::type_index(typeid(Number)))
+        return utils::nullopt;
+    return static_cast<Number*>(expr)->value();
+}
+
+utils::optional<bool> boolValue(Expression* expr) {
+    if (expr->getVisitableType() != std::type_index(typeid(Literal)))
+        return utils::nullopt;
+    return static_cast<Literal*>(expr)->value() == Literal::trueVal;
+}
+
+/// Truncate result the same way 32 bit integer arithmetic does in the generated code
+int wrap(int64_t val) {
+    return static_cast<int32_t>(static_cast<uint32_t>(val));
+}
+
+struct PurityChecker {
+    bool operator() (Node*) {return false;}
+    bool operator() (Number*) {return true;}
+    bool operator() (Literal*) {return true;}
+    bool operator() (StrLiteral*) {return true;}
+    bool operator() (Var*) {return true;}
+    bool operator() (PrefixOp* node) {return dispatch(*this, node->operand());}
+    bool operator() (BinaryOp* node) {
+        return dispatch(*this, node->left()) && dispatch(*this, node->right());
+    }
+};
+
+/// Returns true if expression evaluation has no side effects
+bool isPure(Expression* expr) {
+    return dispatch(PurityChecker{}, expr);
+}
+
+bool terminates(Node* statement) {
+    if (statement->getVisitableType() == std::type_index(typeid(Return)))
+        return true;
+    if (statement->getVisitableType() == std::type_index(typeid(CodeBlock))) {
+        const auto& statements = static_cast<CodeBlock*>(statement)->statements();
+        return std::any_of(statements.begin(), statements.end(), [](Node* child) {
+            return terminates(child);
+        });
+    }
+    return false;
+}
+
+class ExpressionFolder {
+public:
+    Expression* operator() (Node* node) {
+        throw UnexpectedNode(node, "Can't fold constants in non expression node");
+    }
+    Expression* operator() (Expression* node) {return node;}
+
+    Expression* operator() (PrefixOp* node) {
+        Expression* operand = fold(node->operand());
+        if (operand != node->operand())
+            node->setOperand(operand);
+        switch (node->operation()) {
+            case PrefixOp::positive: return operand;
+            case PrefixOp::negative:
+                if (auto val = intValue(operand))
+                    return number(node, wrap(-int64_t{*val}));
+                break;
+            case PrefixOp::boolnot:
+                if (auto val = boolValue(operand))
+                    return literal(node, !*val);
+                break;
+        }
+        // -(-x) and !(!x)
+        if (operand->getVisitableType() == std::type_index(typeid(PrefixOp))) {
+            auto inner = static_cast<PrefixOp*>(operand);
+            if (inner->operation() == node->operation())
+                return inner->operand();
+        }
+        return node;
+    }
+
+    Expression* operator() (BinaryOp* node) {
+        Expression* left = fold(node->left());
+        Expression* right = fold(node->right());
+        if (left != node->left())
+            node->setLeft(left);
+        if (right != node->right())
+            node->setRight(right);
+        const auto lnum = intValue(left);
+        const auto rnum = intValue(right);
+        const auto lbool = boolValue(left);
+        const auto rbool = boolValue(right);
+        switch (node->operation()) {
+            case BinaryOp::add:
+                if (lnum && rnum)
+                    return number(node, wrap(int64_t{*lnum} + *rnum));
+                if (lnum == 0)
+                    return right;
+                if (rnum == 0)
+                    return left;
+                break;
+            case BinaryOp::sub:
+                if (lnum && rnum)
+                    return number(node, wrap(int64_t{*lnum} - *rnum));
+                if (rnum == 0)
+                    return left;
+                break;
+            case BinaryOp::mul:
+                if (lnum && rnum)
+                    return number(node, wrap(int64_t{*lnum} * *rnum));
+                if (lnum == 1)
+                    return right;
+                if (rnum == 1)
+                    return left;
+                if ((lnum == 0 && isPure(right)) || (rnum == 0 && isPure(left)))
+                    return number(node, 0);
+                break;
+            case BinaryOp::div:
+                // division by zero and overflowing division are left to the runtime
+                if (rnum == 0 || (lnum == std::numeric_limits<int>::min() && rnum == -1))
+                    break;
+                if (lnum && rnum)
+                    return number(node, *lnum / *rnum);
+                if (rnum == 1)
+                    return left;
+                break;
+
+            case BinaryOp::equal:
+                if (lnum && rnum)
+                    return literal(node, *lnum == *rnum);
+                if (lbool && rbool)
+                    return literal(node, *lbool == *rbool);
+                break;
+            case BinaryOp::noteq:
+                if (lnum && rnum)
+                    return literal(node, *lnum != *rnum);
+                if (lbool && rbool)
+                    return literal(node, *lbool != *rbool);
+                break;
+            case BinaryOp::less:
+                if (lnum && rnum)
+                    return literal(node, *lnum < *rnum);
+                break;
+            case BinaryOp::lesseq:
+                if (lnum && rnum)
+                    return literal(node, *lnum <= *rnum);
+                break;
+            case BinaryOp::greater:
+                if (lnum && rnum)
+                    return literal(node, *lnum > *rnum);
+                break;
+            case BinaryOp::greatereq:
+                if (lnum && rnum)
+                    return literal(node, *lnum >= *rnum);
+                break;
+
+            case BinaryOp::boolAnd:
+                if (lbool && rbool)
+                    return literal(node, *lbool && *rbool);
+                if (lbool == true)
+                    return right;
+                if (rbool == true)
+                    return left;
+                // both operands are evaluated by the generated code so side effects must be preserved
+                if ((lbool == false && isPure(right)) || (rbool == false && isPure(left)))
+                    return literal(node, false);
+                break;
+            case BinaryOp::boolOr:
+                if (lbool && rbool)
+                    return literal(node, *lbool || *rbool);
+                if (lbool == false)
+                    return right;
+                if (rbool == false)
+                    return left;
+                if ((lbool == true && isPure(right)) || (rbool == true && isPure(left)))
+                    return literal(node, true);
+                break;
+        }
+        return node;
+    }
+
+    Expression* operator() (Assigment* node) {
+        fold(node->target()); // array element index could be folded
+        Expression* value = fold(node->value());
+        if (value != node->value())
+            node->setValue(value);
+        return node;
+    }
+
+    Expression* operator() (Index* node) {
+        Expression* array = fold(node->array());
+        if (array != node->array())
+            node->setArray(array);
+        Expression* index = fold(node->index());
+        if (index != node->index())
+            node->setIndex(index);
+        return node;
+    }
+
+    Expression* operator() (NewArray* node) {
+        Expression* size = fold(node->size());
+        if (size != node->size())
+            node->setSize(size);
+        return node;
+    }
+
+    Expression* operator() (MemberAccess* node) {
+        Expression* parent = fold(node->parent());
+        if (parent != node->parent())
+            node->setParent(parent);
+        return node;
+    }
+
+    Expression* operator() (Call* node) {
+        // Default argument values are shared between all call sites and the argument declaration
+        // memoization in fold guarantees that each of them is folded only once.
+        for (size_t pos = 0; pos < node->args().size(); ++pos) {
+            Expression* arg = fold(node->args()[pos].get());
+            if (arg != node->args()[pos].get())
+                node->setArg(pos, arg);
+        }
+        return node;
+    }
+
+    Expression* fold(Expression* expr) {
+        auto it = mFolded.find(expr);
+        if (it != mFolded.end())
+            return it->second.result.get();
+        Expression* res = dispatch(*this, expr);
+        mFolded.emplace(expr, FoldResult{expr, res});
+        return res;
+    }
+
+private:
+    Expression* number(Expression* origin, int value) {
+        auto res = new Number(origin->source(), origin->tokens(), value);
+        res->setType(origin->type());
+        return res;
+    }
+
+    Expression* literal(Expression* origin, bool value) {
+        auto res = new Literal(origin->source(), origin->tokens(), value ? Literal::trueVal : Literal::falseVal);
+        res->setType(origin->type());
+        return res;
+    }
+
+private:
+    struct FoldResult {
+        // keeps original node alive so its address is never reused by another node
+        Node::Ptr<Expression> original;
+        Node::Ptr<Expression> result;
+    };
+    std::map<Expression*, FoldResult> mFolded;
+};
+
+/// Returns statement to be used instead of the original one or nullptr if statement is eliminated
+struct StatementFolder {
+    ExpressionFolder& exprFolder;
+
+    Node::Ptr<Node> operator() (Node* node) {
+        throw UnexpectedNode(node, "Can't fold constants in the statement of unknown type");
+    }
+
+    Node::Ptr<Node> operator() (CodeBlock* node) {
+        std::vector<Node::Ptr<Node>> statements;
+        statements.reserve(node->statements().size());
+        for (Node* statement: node->statements()) {
+            const bool terminated = terminates(statement);
+            Node::Ptr<Node> folded = fold(statement);
+            if (!folded)
+                continue;
+            statements.push_back(folded);
+            // Code after the if statement pruned to return is unreachable. Unreachable code which was
+            // there before folding is left as is to be reported by reachability checker.
+            if (!terminated && terminates(folded))
+                break;
+        }
+        node->setStatements(std::move(statements));
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (If* node) {
+        Expression* cond = exprFolder.fold(node->condition());
+        if (cond != node->condition())
+            node->setCondition(cond);
+        if (auto val = boolValue(cond))
+            return fold(*val ? node->thenBlock() : node->elseBlock());
+
+        Node::Ptr<Node> thenBlock = fold(node->thenBlock());
+        if (thenBlock != node->thenBlock())
+            node->setThenBlock(thenBlock);
+        Node::Ptr<Node> elseBlock = fold(node->elseBlock());
+        if (elseBlock != node->elseBlock())
+            node->setElseBlock(elseBlock);
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (While* node) {
+        Expression* cond = exprFolder.fold(node->condition());
+        if (cond != node->condition())
+            node->setCondition(cond);
+        if (boolValue(cond) == false)
+            return nullptr; // body is never executed
+
+        Node::Ptr<Node> body = fold(node->body());
+        if (body != node->body())
+            node->setBody(body);
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (For* node) {
+        Node::Ptr<Node> init = fold(node->init());
+        Expression* cond = exprFolder.fold(node->condition());
+        if (cond != node->condition())
+            node->setCondition(cond);
+        if (boolValue(cond) == false)
+            return init; // only loop variable initialization is executed
+
+        Expression* step = exprFolder.fold(node->step());
+        if (step != node->step())
+            node->setStep(step);
+        Node::Ptr<Node> body = fold(node->body());
+        if (body != node->body())
+            node->setBody(body);
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (ExprStatement* node) {
+        Expression* expr = exprFolder.fold(node->expression());
+        if (isPure(expr))
+            return nullptr; // statement without side effects does nothing
+        if (expr != node->expression())
+            node->setExpression(expr);
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (VarDecl* node) {
+        if (!node->inited())
+            return node;
+        Expression* init = exprFolder.fold(node->initExpr());
+        if (init != node->initExpr())
+            node->setInitExpr(init);
+        return node;
+    }
+
+    Node::Ptr<Node> operator() (Return* node) {
+        if (!node->value())
+            return node;
+        Expression* value = exprFolder.fold(node->value());
+        if (value != node->value())
+            node->setValue(value);
+        return node;
+    }
+
+    Node::Ptr<Node> fold(Node* statement) {
+        if (!statement)
+            return nullptr;
+        return dispatch(*this, statement);
+    }
+};
+
+} // anonymous namespace
+
+void foldConstants(AST* ast) {
+    ExpressionFolder exprFolder;
+    StatementFolder statementFolder{exprFolder};
+    walk<Function, TopDown>(*ast, [&statementFolder](Function* func) {
+        for (auto arg: func->args())
+            statementFolder.fold(arg);
+        if (func->body())
+            statementFolder.fold(func->body());
+        return false;
+    });
+}
+
+} // namespace meta::analysers
@@ -0,0 +1,46 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace meta {
+class AST;
+}
+
+namespace meta::analysers {
+
+/// Arrays with more elements are always allocated by meta-rt
+constexpr int maxStackArrayElements = 512;
+
+/**
+ * Escape analysis: marks arrays "T[N]" with constant N up to maxStackArrayElements and non string
+ * elements with NewArray::setStackAllocated(true) when the array never outlives the function frame.
+ * Such array is either stored to a local variable or passed to a function of the same package which
+ * doesn't let its argument escape. The variable must only be indexed, asked for members, reassigned
+ * or passed to such functions. Arguments escape when they are returned, stored, written to, passed to
+ * extern functions, functions of other packages or self tail calls reusing the frame. Variables
+ * holding stack allocated arrays only are marked with VarFlags::stackArray.
+ *
+ * @returns number of array allocations moved to the stack
+ * @note Must be called after type checking and constant folding.
+ */
+size_t allocateArraysOnStack(AST* ast);
+
+} // namespace meta::analysers
@@ -0,0 +1,190 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "typesystem/type.h"
+
+#include "analysers/escapeanalysis.h"
+
+namespace meta::analysers {
+namespace {
+
+VarDecl* localArray(Expression* expr) {
+    auto var = dynamic_cast<Var*>(expr);
+    if (!var || !var->declaration() || !var->declaration()->type())
+        return nullptr;
+    return var->declaration()->type()->typeId() == typesystem::Type::Array ? var->declaration() : nullptr;
+}
+
+class EscapeAnalysis {
+public:
+    explicit EscapeAnalysis(AST* ast) {
+        walk<Function, TopDown>(*ast, [this](Function* func) {
+            if (func->body() && func->visibility() != Visibility::Extern)
+                mFunctions.push_back(func);
+            return false;
+        });
+    }
+
+    size_t run() {
+        // Arguments escape only if some use lets them escape: start from none and add escaping ones until
+        // nothing changes
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto func: mFunctions) {
+                for (auto decl: escaping(func)) {
+                    if (decl->flags() & VarFlags::argument)
+                        changed = mEscapingArgs.insert(decl).second || changed;
+                }
+            }
+        }
+        size_t res = 0;
+        for (auto func: mFunctions)
+            res += markStackArrays(func);
+        return res;
+    }
+
+private:
+    /// Function which could borrow array stored in the caller frame as its pos argument
+    bool borrows(Function* caller, Call* call, size_t pos) const {
+        Function* callee = call->function();
+        if (!callee || !callee->body() || callee->visibility() == Visibility::Extern)
+            return false;
+        // Results of the other packages analysis might change without recompilation of the caller
+        if (callee->package() != caller->package())
+            return false;
+        // Eliminated tail recursion reuses the frame arrays are stored in
+        if (call->tailCall() && callee == caller)
+            return false;
+        return pos < callee->args().size() && !mEscapingArgs.count(callee->args()[pos]);
+    }
+
+    /// Array variables of the function with uses which might let their values escape
+    std::set<VarDecl*> escaping(Function* func) const {
+        // Nodes don't know their parents so uses which don't let values escape are counted and compared
+        // with the total number of the variable uses
+        std::map<VarDecl*, size_t> allowed;
+        for (auto node: func->body()->getChildren<Index>(infinitDepth)) {
+            if (auto decl = localArray(node->array()))
+                ++allowed[decl];
+        }
+        for (auto node: func->body()->getChildren<Assigment>(infinitDepth)) {
+            // Written arguments are copied to the heap
+            auto element = dynamic_cast<Index*>(node->target());
+            auto decl = element ? localArray(element->array()) : nullptr;
+            if (decl && (decl->flags() & VarFlags::argument))
+                --allowed[decl];
+            if (auto target = localArray(node->target()))
+                ++allowed[target];
+        }
+        for (auto node: func->body()->getChildren<MemberAccess>(infinitDepth)) {
+            if (auto decl = localArray(node->parent()))
+                ++allowed[decl];
+        }
+        for (auto call: func->body()->getChildren<Call>(infinitDepth)) {
+            for (size_t pos = 0; pos < call->args().size(); ++pos) {
+                auto decl = localArray(call->args()[pos]);
+                if (decl && borrows(func, call, pos))
+                    ++allowed[decl];
+            }
+        }
+        std::map<VarDecl*, size_t> total;
+        for (auto node: func->body()->getChildren<Var>(infinitDepth)) {
+            if (auto decl = localArray(node))
+                ++total[decl];
+        }
+        std::set<VarDecl*> res;
+        for (const auto& uses: total) {
+            if (uses.second != allowed[uses.first])
+                res.insert(uses.first);
+        }
+        return res;
+    }
+
+    static bool fitsStack(NewArray* node) {
+        auto size = dynamic_cast<Number*>(node->size());
+        if (!size || size->value() < 0 || size->value() > maxStackArrayElements)
+            return false;
+        // String elements are released with the array control block, struct elements have default
+        // values and @soa layout which depends on the number of elements
+        if (!node->type())
+            return false;
+        const auto element = node->type()->element().typeId();
+        return element != typesystem::Type::String && element != typesystem::Type::Struct;
+    }
+
+    size_t markStackArrays(Function* func) {
+        const std::set<VarDecl*> escapingVars = escaping(func);
+        const auto isLocal = [&escapingVars](VarDecl* decl) {
+            return decl && !(decl->flags() & VarFlags::argument) && !escapingVars.count(decl);
+        };
+        size_t res = 0;
+        const auto mark = [&res](Expression* expr) {
+            auto array = dynamic_cast<NewArray*>(expr);
+            if (!array || !fitsStack(array))
+                return false;
+            array->setStackAllocated(true);
+            ++res;
+            return true;
+        };
+        // Variables which get heap allocated values as well keep reference counting
+        std::map<VarDecl*, bool> stackOnly;
+        for (auto decl: func->body()->getChildren<VarDecl>(infinitDepth)) {
+            if (!decl->type() || decl->type()->typeId() != typesystem::Type::Array || !isLocal(decl))
+                continue;
+            stackOnly[decl] = !decl->initExpr() || mark(decl->initExpr());
+        }
+        for (auto node: func->body()->getChildren<Assigment>(infinitDepth)) {
+            auto decl = localArray(node->target());
+            if (!isLocal(decl))
+                continue;
+            const bool stack = mark(node->value());
+            stackOnly[decl] = stackOnly[decl] && stack;
+        }
+        for (auto call: func->body()->getChildren<Call>(infinitDepth)) {
+            for (size_t pos = 0; pos < call->args().size(); ++pos) {
+                if (borrows(func, call, pos))
+                    mark(call->args()[pos]);
+            }
+        }
+        for (const auto& var: stackOnly) {
+            if (var.second)
+                var.first->flags() |= VarFlags::stackArray;
+        }
+        return res;
+    }
+
+    std::vector<Function*> mFunctions;
+    std::set<VarDecl*> mEscapingArgs;
+};
+
+} // anonymous namespace
+
+size_t allocateArraysOnStack(AST* ast) {
+    return EscapeAnalysis{ast}.run();
+}
+
+} // namespace meta::analysers
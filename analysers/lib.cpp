@@ -1,5 +1,9 @@
 #include "actions.hpp"
+#include "attributes.hpp"
+#include "constfolder.hpp"
+#include "escapeanalysis.hpp"
 #include "metaprocessor.hpp"
+#include "rangeanalysis.hpp"
 #include "reachabilitychecker.hpp"
 #include "resolver.hpp"
 #include "typechecker.hpp"
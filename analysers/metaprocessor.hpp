@@ -15,11 +15,14 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include "utils/contract.h"
 
 #include "parser/annotation.h"
 #include "parser/metaparser.h"
 #include "parser/function.h"
+#include "parser/newarray.h"
 
 #include "analysers/metaprocessor.h"
 #include "analysers/semanticerror.h"
@@ -27,6 +30,21 @@
 namespace meta {
 namespace analysers {
 
+namespace {
+
+/// Array data blocks are allocated by meta-rt with this alignment
+constexpr size_t maxArrayElementAlignment = 16;
+
+size_t elementAlignment(const typesystem::Aggregate& aggregate) {
+    size_t res = aggregate.layout().alignment;
+    // Columns of @soa arrays are aligned as their fields
+    for (const auto& field: aggregate.fields())
+        res = std::max(res, field.type.alignment());
+    return res;
+}
+
+} // anonymous namespace
+
 void processMeta(AST *ast)
 {
     walk<Annotation, TopDown>(*ast, [] (Annotation *node) {
@@ -34,12 +52,42 @@ void processMeta(AST *ast)
 
         /// @todo process user defined metas here
         const auto name = static_cast<std::string>(node->name());
-        auto attrSetter = node->target()->attributes().find(name);
-        if (attrSetter == node->target()->attributes().end())
+        const auto& attributes = node->target()->attributes();
+        const auto& argAttributes = node->target()->argAttributes();
+        if (node->argument()) {
+            auto argSetter = argAttributes.find(name);
+            if (argSetter == argAttributes.end()) {
+                if (attributes.count(name) != 0)
+                    throw SemanticError(node, "Attribute '%s' takes no arguments", name.c_str());
+                throw SemanticError(node, "Invalid attribute '%s'", name.c_str());
+            }
+            if (!argSetter->second(node->target(), *node->argument()))
+                throw SemanticError(node, "Invalid value %d of the attribute '%s'", *node->argument(), name.c_str());
+            return false;
+        }
+        auto attrSetter = attributes.find(name);
+        if (attrSetter == attributes.end()) {
+            if (argAttributes.count(name) != 0)
+                throw SemanticError(node, "Attribute '%s' requires an argument", name.c_str());
             throw SemanticError(node, "Invalid attribute '%s'", name.c_str());
+        }
         attrSetter->second(node->target());
         return false;
     });
+    // Struct layout is known once all the attributes are applied
+    walk<NewArray, TopDown>(*ast, [] (NewArray *node) {
+        const auto type = node->type();
+        if (!type || !type->aggregate())
+            return true;
+        const size_t alignment = elementAlignment(*type->aggregate());
+        if (alignment > maxArrayElementAlignment) {
+            throw SemanticError(
+                node, "Can't allocate array of the struct '%s' aligned to %u bytes, at most %u bytes alignment is supported",
+                type->aggregate()->typeName(), alignment, maxArrayElementAlignment
+            );
+        }
+        return true;
+    });
 }
 
 } // namespace analysers
@@ -0,0 +1,37 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+namespace meta {
+class AST;
+}
+
+namespace meta::analysers {
+
+/**
+ * Marks array element accesses a[i] which can't be out of bounds with Index::setBoundsChecked(false).
+ * Counted loops "for (int i = N; i < a.length; i = i + 1)" with non negative constant N keep the
+ * counter in the [0, a.length) range inside the body as long as the body assigns neither the counter
+ * nor the array variable.
+ *
+ * @note Must be called after type checking and constant folding.
+ */
+void eliminateBoundsChecks(AST* ast);
+
+} // namespace meta::analysers
@@ -0,0 +1,97 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "analysers/rangeanalysis.h"
+
+namespace meta::analysers {
+namespace {
+
+bool isVar(Expression* expr, VarDecl* decl) {
+    auto var = dynamic_cast<Var*>(expr);
+    return var != nullptr && var->declaration() == decl;
+}
+
+bool isNumber(Expression* expr, int value) {
+    auto num = dynamic_cast<Number*>(expr);
+    return num != nullptr && num->value() == value;
+}
+
+/// Checks for "i = i + 1" or "i = 1 + i"
+bool isIncrement(Expression* expr, VarDecl* counter) {
+    auto assigment = dynamic_cast<Assigment*>(expr);
+    if (!assigment || !isVar(assigment->target(), counter))
+        return false;
+    auto sum = dynamic_cast<BinaryOp*>(assigment->value());
+    if (!sum || sum->operation() != BinaryOp::add)
+        return false;
+    return
+        (isVar(sum->left(), counter) && isNumber(sum->right(), 1)) ||
+        (isNumber(sum->left(), 1) && isVar(sum->right(), counter))
+    ;
+}
+
+/// Returns array variable "a" if the loop counter is kept in [0, a.length) range or nullptr otherwise
+VarDecl* loopArray(For* loop) {
+    VarDecl* counter = loop->init();
+    if (!counter)
+        return nullptr;
+    auto start = dynamic_cast<Number*>(counter->initExpr());
+    if (!start || start->value() < 0)
+        return nullptr;
+    // Counter never overflows: it's incremented by one only while it's less than array length
+    if (!isIncrement(loop->step(), counter))
+        return nullptr;
+    auto cond = dynamic_cast<BinaryOp*>(loop->condition());
+    if (!cond || cond->operation() != BinaryOp::less || !isVar(cond->left(), counter))
+        return nullptr;
+    auto length = dynamic_cast<MemberAccess*>(cond->right());
+    if (!length || length->targetStruct() || length->memberName() != "length")
+        return nullptr;
+    auto array = dynamic_cast<Var*>(length->parent());
+    if (!array)
+        return nullptr;
+    for (auto assigment: loop->body()->getChildren<Assigment>(infinitDepth)) {
+        if (isVar(assigment->target(), counter) || isVar(assigment->target(), array->declaration()))
+            return nullptr;
+    }
+    return array->declaration();
+}
+
+} // anonymous namespace
+
+void eliminateBoundsChecks(AST* ast) {
+    walk<For, TopDown>(*ast, [](For* loop) {
+        if (!loop->body())
+            return false;
+        VarDecl* array = loopArray(loop);
+        if (!array)
+            return true;
+        for (auto index: loop->body()->getChildren<Index>(infinitDepth)) {
+            if (isVar(index->array(), array) && isVar(index->index(), loop->init()))
+                index->setBoundsChecked(false);
+        }
+        return true;
+    });
+}
+
+} // namespace meta::analysers
@@ -17,10 +17,12 @@
  */
 #include "parser/codeblock.h"
 #include "parser/exprstatement.h"
+#include "parser/for.h"
 #include "parser/if.h"
 #include "parser/function.h"
 #include "parser/return.h"
 #include "parser/vardecl.h"
+#include "parser/while.h"
 
 #include "typesystem/type.h"
 
@@ -40,6 +42,8 @@ public:
     virtual bool visit(ExprStatement *node) override;
     virtual bool visit(Return *node) override;
     virtual bool visit(If *node) override;
+    virtual bool visit(While *node) override;
+    virtual bool visit(For *node) override;
 
 private:
     void checkReturn(Node *node);
@@ -114,6 +118,26 @@ bool ReachabilityChecker::visit(If *node)
     return false;
 }
 
+bool ReachabilityChecker::visit(While *node)
+{
+    checkReturn(node);
+    if (node->body()) {
+        node->body()->walk(this);
+        mReturn = nullptr;
+    }
+    return false;
+}
+
+bool ReachabilityChecker::visit(For *node)
+{
+    checkReturn(node);
+    if (node->body()) {
+        node->body()->walk(this);
+        mReturn = nullptr;
+    }
+    return false;
+}
+
 void checkReachability(AST *ast)
 {
     ReachabilityChecker checker;
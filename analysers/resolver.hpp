@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cassert>
+#include <cctype>
 #include <map>
 #include <set>
 #include <algorithm>
@@ -53,6 +54,44 @@ bool isChildPackage(utils::string_view subpkg, utils::string_view parentpkg) {
     return part == parentpkg;
 }
 
+/// Struct member default values are evaluated at compile time
+bool constantDefault(Expression* expr) {
+    if (auto op = dynamic_cast<PrefixOp*>(expr))
+        return op->operation() != PrefixOp::boolnot && dynamic_cast<Number*>(op->operand()) != nullptr;
+    return dynamic_cast<Number*>(expr) != nullptr || dynamic_cast<Literal*>(expr) != nullptr;
+}
+
+bool isSpace(char ch) {return std::isspace(static_cast<unsigned char>(ch)) != 0;}
+
+utils::string_view trimmed(utils::string_view str) {
+    while (!str.empty() && isSpace(str.front()))
+        str.remove_prefix(1);
+    while (!str.empty() && isSpace(str.back()))
+        str.remove_suffix(1);
+    return str;
+}
+
+/// Struct name of the array element spelled as `struct Name` in the sources or nullopt for built in types
+utils::optional<utils::string_view> structElement(utils::string_view element) {
+    constexpr utils::string_view keyword = "struct"sv;
+    element = trimmed(element);
+    if (!utils::starts_with(element, keyword) || element.size() == keyword.size() || !isSpace(element[keyword.size()]))
+        return utils::nullopt;
+    return trimmed(element.substr(keyword.size()));
+}
+
+/// Element of the array type name `Element[]`, module files store struct arrays without the keyword
+utils::optional<utils::string_view> arrayElement(utils::string_view typeName) {
+    typeName = trimmed(typeName);
+    if (typeName.empty() || typeName.back() != ']')
+        return utils::nullopt;
+    typeName = trimmed(typeName.substr(0, typeName.size() - 1));
+    if (typeName.empty() || typeName.back() != '[')
+        return utils::nullopt;
+    typeName = typeName.substr(0, typeName.size() - 1);
+    return structElement(typeName).value_or(trimmed(typeName));
+}
+
 template<typename Decl>
 Decl* decl(const DeclRef<Decl>& val) {return val.decl;}
 
@@ -81,6 +120,89 @@ void fillPackageScope(Scope& scope, const Dictionary& dict, DeclFilter filter =
 
 struct Analyser {
     Dictionary& dict;
+    /// Function whose body is being resolved, owns slots of local variables
+    Function* currFunc = nullptr;
+    /// Scope of the built in types, parent of the package scopes
+    Scope* globalScope = nullptr;
+    /// Structs which members types are being resolved, used to detect structs containing themselves
+    std::set<Struct*> describing;
+    /// Functions loaded from module files which signatures are already resolved
+    std::set<Function*> loadedSignatures;
+
+    /// Returns type of the struct with the name specified or nullopt if there is no such struct visible
+    utils::optional<Type> structType(utils::string_view name, Scope& scope) {
+        for (auto* currscope = &scope; currscope != nullptr; currscope = currscope->parent) {
+            auto it = currscope->structs.find(name);
+            if (it == currscope->structs.end())
+                continue;
+            describe(it->decl);
+            return Type{it->decl};
+        }
+        return utils::nullopt;
+    }
+
+    /// Returns type named by the struct declarations: the struct itself or an array of its values
+    utils::optional<Type> userType(utils::string_view name, Scope& scope) {
+        auto element = arrayElement(name);
+        if (!element)
+            return structType(name, scope);
+        if (auto type = structType(*element, scope))
+            return Type::arrayOf(type->aggregate());
+        return utils::nullopt;
+    }
+
+    /// Resolves types of the struct members. Members are values of built in types or other structs
+    /// of the same package.
+    void describe(Struct* strct) {
+        if (strct->complete())
+            return;
+        if (!describing.insert(strct).second)
+            throw SemanticError(strct, "Struct '%s' contains itself", strct->name());
+        Scope pkgScope{globalScope, strct->package()};
+        fillPackageScope(pkgScope, dict);
+        std::vector<typesystem::Aggregate::Field> fields;
+        for (const auto& member: strct->members()) {
+            utils::optional<Type> type = pkgScope.findType(member->typeName());
+            if (!type)
+                type = userType(member->typeName(), pkgScope);
+            if (!type)
+                throw SemanticError(
+                    member.get(), "Member '%s' of the struct '%s' has unknown type '%s'",
+                    member->name(), strct->name(), member->typeName()
+                );
+            switch (type->typeId()) {
+            case Type::Int:
+            case Type::Bool:
+            case Type::Double:
+            case Type::Struct: break;
+            default:
+                // Refcounted members would make copying of struct values non trivial
+                throw SemanticError(
+                    member.get(), "Member '%s' of the struct '%s' can't be of type '%s'",
+                    member->name(), strct->name(), type->name()
+                );
+            }
+            if (member->inited() && !constantDefault(member->initExpr()))
+                throw SemanticError(
+                    member->initExpr(), "Default value of the member '%s' of the struct '%s' must be a literal",
+                    member->name(), strct->name()
+                );
+            member->setType(type);
+            fields.push_back({member->name(), *type});
+        }
+        strct->setFields(std::move(fields));
+        describing.erase(strct);
+    }
+
+    /// Sets types of the arguments and the return value named by struct declarations
+    void resolveSignature(Function* func, Scope& scope) {
+        if (auto type = userType(func->retType(), scope))
+            func->setDeclaredRetType(*type);
+        for (auto arg: func->args()) {
+            if (!arg->type())
+                arg->setType(userType(arg->typeName(), scope));
+        }
+    }
 
     void operator() (Node* node, Scope&) {
         trace(resolverTraceTag, node);
@@ -193,6 +315,7 @@ struct Analyser {
             );
         }
 
+        resolveSignature(node, scope);
         if (!node->body())
             return;
         Scope funcContext{&scope};
@@ -203,9 +326,12 @@ struct Analyser {
                     arg, "%s has more than one arguments with the same name '%s'",
                     declinfo(node), arg->name()
                 );
+            arg->setSlot(node->addSlot());
         }
+        currFunc = node;
         for (auto statement: node->body()->statements())
             dispatch(*this, statement, funcContext);
+        currFunc = nullptr;
     }
 
     void operator() (Call* node, Scope& scope) {
@@ -218,6 +344,13 @@ struct Analyser {
             /// @todo replace assert by proper support of function overload
             assert(std::distance(matches.begin(), matches.end()) == 1);
             node->setFunction(matches.begin()->decl);
+            // Declarations loaded from module files are not the part of the AST resolved
+            Function* func = node->function();
+            if (!func->body() && func->visibility() != Visibility::Extern && loadedSignatures.insert(func).second) {
+                Scope pkgScope{globalScope, func->package()};
+                fillPackageScope(pkgScope, dict);
+                resolveSignature(func, pkgScope);
+            }
             auto expectedArgs = node->function()->args();
             auto passedArgs = node->args();
             if (expectedArgs.size() != passedArgs.size()) {
@@ -244,14 +377,18 @@ struct Analyser {
 
     void operator() (VarDecl* node, Scope& scope) {
         trace(resolverTraceTag, node);
+        PRECONDITION(currFunc != nullptr);
         auto conflict = scope.find<VarStats>(node->name());
         if (conflict && (conflict->decl->flags() & VarFlags::argument))
             throwDeclConflict(node, conflict->decl);
         if (node->inited() && !(node->flags() & VarFlags::argument))
             dispatch(*this, node->initExpr(), scope);
+        if (!node->type())
+            node->setType(userType(node->typeName(), scope));
         auto res = scope.vars.emplace(MutableVarStats{node});
         if (!res.second)
             throwDeclConflict(node, res.first->get().decl);
+        node->setSlot(currFunc->addSlot());
     }
 
     void operator() (If* node, Scope& scope) {
@@ -267,6 +404,28 @@ struct Analyser {
         }
     }
 
+    void operator() (While* node, Scope& scope) {
+        trace(resolverTraceTag, node);
+        dispatch(*this, node->condition(), scope);
+        if (node->body()) {
+            Scope bodyscope{&scope};
+            dispatch(*this, node->body(), bodyscope);
+        }
+    }
+
+    void operator() (For* node, Scope& scope) {
+        trace(resolverTraceTag, node);
+        // loop variable is visible in the condition, step and body only
+        Scope loopscope{&scope};
+        dispatch(*this, node->init(), loopscope);
+        dispatch(*this, node->condition(), loopscope);
+        dispatch(*this, node->step(), loopscope);
+        if (node->body()) {
+            Scope bodyscope{&loopscope};
+            dispatch(*this, node->body(), bodyscope);
+        }
+    }
+
     void operator() (BinaryOp* node, Scope& scope) {
         trace(resolverTraceTag, node);
         dispatch(*this, node->left(), scope);
@@ -278,6 +437,30 @@ struct Analyser {
         dispatch(*this, node->operand(), scope);
     }
 
+    void operator() (Index* node, Scope& scope) {
+        trace(resolverTraceTag, node);
+        dispatch(*this, node->array(), scope);
+        dispatch(*this, node->index(), scope);
+    }
+
+    void operator() (NewArray* node, Scope& scope) {
+        trace(resolverTraceTag, node);
+        dispatch(*this, node->size(), scope);
+        // Arrays of built in types are typed by the type checker
+        auto element = structElement(node->elementTypeName());
+        if (!element)
+            return;
+        auto type = structType(*element, scope);
+        if (!type)
+            throw SemanticError(node, "Array of unknown struct '%s'", *element);
+        node->setType(Type::arrayOf(type->aggregate()));
+    }
+
+    void operator() (MemberAccess* node, Scope& scope) {
+        trace(resolverTraceTag, node);
+        dispatch(*this, node->parent(), scope);
+    }
+
     void operator() (Number* node, Scope&) {
         trace(resolverTraceTag, node);
     }
@@ -309,11 +492,22 @@ struct Analyser {
             stats->assignCount++;
             target->setDeclaration(stats->decl);
         } else if (node->target()->getVisitableType() == std::type_index(typeid(MemberAccess))) {
-            auto aggregate = static_cast<MemberAccess*>(node->target())->parent();
-            [[gnu::unused]]
-            auto aggregate_type = type_of(aggregate, scope);
-            throw UnexpectedNode(node->target(), "Member assigment is not yet implemented");
-        } else
+            // Struct members are modified in place so the struct must be stored in a local variable
+            // or be an element of an array variable
+            Expression* aggregate = static_cast<MemberAccess*>(node->target())->parent();
+            while (auto member = dynamic_cast<MemberAccess*>(aggregate))
+                aggregate = member->parent();
+            auto element = dynamic_cast<Index*>(aggregate);
+            auto var = dynamic_cast<Var*>(element ? element->array() : aggregate);
+            if (!var)
+                throw SemanticError(node, "Can't assign to a member of a temporary value");
+            dispatch(*this, node->target(), scope);
+            // Array arguments are copied on write
+            if (!element && (var->declaration()->flags() & VarFlags::argument))
+                throw SemanticError(node, "Attempt to modify function argument '%s'", var->name());
+        } else if (node->target()->getVisitableType() == std::type_index(typeid(Index)))
+            dispatch(*this, node->target(), scope); // array elements are modified in place
+        else
             throw UnexpectedNode(node->target(), "Unexpected assigment left side expression type");
         dispatch(*this, node->value(), scope);
     }
@@ -326,6 +520,7 @@ struct Analyser {
 
     void operator() (Struct* node, Scope&) {
         trace(resolverTraceTag, node);
+        describe(node);
     }
 
     void operator() (ExprStatement* node, Scope& scope) {
@@ -339,6 +534,7 @@ struct Analyser {
 void resolve(AST* ast, Dictionary& dict) {
     Analyser resolver{dict};
     Scope globalscope;
+    resolver.globalScope = &globalscope;
 
     Scope nullscope{&globalscope, "null"sv};
     fillPackageScope(nullscope, dict, DeclFilter::publicOnly);
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <iterator>
 #include <map>
+#include <string>
 
 #include "utils/mutable_wrapper.h"
 #include "utils/types.h"
@@ -29,9 +33,14 @@ struct DeclRef {
 struct VarStats {
     VarStats(VarDecl* decl):
         decl(decl),
-        assignCount((decl->flags() & VarFlags::argument) || decl->inited() ? 1 : 0)
+        assignCount((decl->flags() & VarFlags::argument) || decl->inited() || zeroInited(decl) ? 1 : 0)
     {}
 
+    /// Struct variables are initialized with the default values of the members
+    static bool zeroInited(VarDecl* decl) {
+        return decl->type() && decl->type()->typeId() == typesystem::Type::Struct;
+    }
+
     VarDecl* decl;
     unsigned assignCount;
     unsigned accessCount = 0;
@@ -80,6 +89,13 @@ struct Scope {
             if (it != scope->types.end())
                 return *it;
         }
+        // Type names are taken from the source as is: "int [ ]" names the same type as "int[]"
+        const auto space = [](char ch) {return std::isspace(static_cast<unsigned char>(ch)) != 0;};
+        if (std::any_of(name.begin(), name.end(), space)) {
+            std::string normalized;
+            std::remove_copy_if(name.begin(), name.end(), std::back_inserter(normalized), space);
+            return findType(utils::string_view{normalized.data(), normalized.size()});
+        }
         return utils::nullopt;
     }
 };
@@ -0,0 +1,276 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/call.h"
+#include "parser/function.h"
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/attributes.h"
+#include "analysers/metaprocessor.h"
+#include "analysers/resolver.h"
+#include "analysers/semanticerror.h"
+
+namespace meta::analysers::tests::attributes {
+namespace {
+
+std::map<std::string, Function*> analyse(Parser& parser, Actions& act, const utils::SourceFile& input) {
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    parser.parse(input);
+    auto ast = parser.ast();
+    resolve(ast, act.dictionary());
+    processMeta(ast);
+    inferAttributes(ast);
+    std::map<std::string, Function*> res;
+    for (auto func: ast->getChildren<Function>(infinitDepth))
+        res[std::string{func->name()}] = func;
+    return res;
+}
+
+TEST(InferAttributes, purity) {
+    const auto input = R"META(
+        package test;
+
+        extern int random();
+        @pure
+        extern int square(int x);
+
+        int sum(int x, int y) {return x + y;}
+        int sumSquares(int x, int y) {return sum(square(x), square(y));}
+        int noise(int x) {return x + random();}
+        int noisySum(int x) {return sum(x, noise(x));}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    std::map<std::string, Function*> funcs;
+    ASSERT_ANALYSE(funcs = analyse(parser, act, input));
+    EXPECT_FALSE(funcs.at("random")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("square")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("sum")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("sumSquares")->flags() & FuncFlags::pure);
+    EXPECT_FALSE(funcs.at("noise")->flags() & FuncFlags::pure);
+    EXPECT_FALSE(funcs.at("noisySum")->flags() & FuncFlags::pure);
+}
+
+TEST(InferAttributes, recursion) {
+    const auto input = R"META(
+        package test;
+
+        extern int callback(int x);
+
+        int fact(int n) {
+            if (n <= 1)
+                return 1;
+            return n*fact(n - 1);
+        }
+        bool isEven(int n) {
+            if (n == 0)
+                return true;
+            return isOdd(n - 1);
+        }
+        bool isOdd(int n) {
+            if (n == 0)
+                return false;
+            return isEven(n - 1);
+        }
+        int twice(int x) {return 2*x;}
+        int quad(int x) {return twice(twice(x));}
+        int external(int x) {return callback(x);}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    std::map<std::string, Function*> funcs;
+    ASSERT_ANALYSE(funcs = analyse(parser, act, input));
+    EXPECT_FALSE(funcs.at("fact")->flags() & FuncFlags::noRecurse);
+    // Recursion might never terminate
+    EXPECT_FALSE(funcs.at("fact")->flags() & FuncFlags::pure);
+    EXPECT_FALSE(funcs.at("isEven")->flags() & FuncFlags::noRecurse);
+    EXPECT_FALSE(funcs.at("isOdd")->flags() & FuncFlags::noRecurse);
+    EXPECT_FALSE(funcs.at("isOdd")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("twice")->flags() & FuncFlags::noRecurse);
+    EXPECT_TRUE(funcs.at("twice")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("quad")->flags() & FuncFlags::noRecurse);
+    // C code might call back into meta code
+    EXPECT_FALSE(funcs.at("external")->flags() & FuncFlags::noRecurse);
+}
+
+TEST(InferAttributes, termination) {
+    const auto input = R"META(
+        package test;
+
+        int spin(int x) {
+            int res = x;
+            while (res != 0)
+                res = res - 2;
+            return res;
+        }
+        int count(int n) {
+            int res = 0;
+            for (int i = 0; i < n; i = i + 1)
+                res = res + i;
+            return res;
+        }
+        int useSpin(int x) {return spin(x) + 1;}
+        @pure
+        int promised(int n) {
+            if (n <= 0)
+                return 0;
+            return promised(n - 1);
+        }
+        int usePromised(int n) {return promised(n) + 1;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    std::map<std::string, Function*> funcs;
+    ASSERT_ANALYSE(funcs = analyse(parser, act, input));
+    EXPECT_FALSE(funcs.at("spin")->flags() & FuncFlags::pure);
+    EXPECT_FALSE(funcs.at("count")->flags() & FuncFlags::pure);
+    EXPECT_FALSE(funcs.at("useSpin")->flags() & FuncFlags::pure);
+    // Explicit annotation promises termination
+    EXPECT_TRUE(funcs.at("promised")->flags() & FuncFlags::pure);
+    EXPECT_TRUE(funcs.at("usePromised")->flags() & FuncFlags::pure);
+}
+
+TEST(InferAttributes, annotations) {
+    const auto input = R"META(
+        package test;
+
+        @inline
+        int twice(int x) {return 2*x;}
+        @noinline @cold
+        int report(int x) {return x;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    std::map<std::string, Function*> funcs;
+    ASSERT_ANALYSE(funcs = analyse(parser, act, input));
+    EXPECT_TRUE(funcs.at("twice")->flags() & FuncFlags::alwaysInline);
+    EXPECT_FALSE(funcs.at("twice")->flags() & FuncFlags::noInline);
+    EXPECT_TRUE(funcs.at("report")->flags() & FuncFlags::noInline);
+    EXPECT_TRUE(funcs.at("report")->flags() & FuncFlags::cold);
+}
+
+TEST(InferAttributes, conflictingInlineAnnotations) {
+    const auto input = R"META(
+        package test;
+
+        @inline @noinline
+        int twice(int x) {return 2*x;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    try {
+        analyse(parser, act, input);
+        FAIL() << "Conflicting annotations were not detected";
+    } catch (const SemanticError& err) {
+        EXPECT_EQ(std::string{err.what()}, "Function 'twice' can't be both @inline and @noinline");
+    }
+}
+
+TEST(InferAttributes, tailCalls) {
+    const auto input = R"META(
+        package test;
+
+        @tailrec
+        int sumTo(int n, int acc) {
+            if (n <= 0)
+                return acc;
+            return sumTo(n - 1, acc + n);
+        }
+
+        int fib(int n) {
+            if (n < 2)
+                return n;
+            return fib(n - 1) + fib(n - 2);
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    std::map<std::string, Function*> funcs;
+    ASSERT_ANALYSE(funcs = analyse(parser, act, input));
+    EXPECT_TRUE(funcs.at("sumTo")->flags() & FuncFlags::tailRec);
+    const auto sumToCalls = funcs.at("sumTo")->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(sumToCalls.size(), 1u);
+    EXPECT_TRUE(sumToCalls[0]->tailCall());
+    const auto fibCalls = funcs.at("fib")->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(fibCalls.size(), 2u);
+    for (auto call: fibCalls)
+        EXPECT_FALSE(call->tailCall());
+}
+
+TEST(InferAttributes, tailrecWithoutTailCall) {
+    const auto input = R"META(
+        package test;
+
+        @tailrec
+        int factorial(int n) {
+            if (n <= 1)
+                return 1;
+            return n*factorial(n - 1);
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    try {
+        analyse(parser, act, input);
+        FAIL() << "Non tail recursive call was not detected";
+    } catch (const SemanticError& err) {
+        EXPECT_EQ(
+            std::string{err.what()},
+            "Recursive call of 'factorial' is not in tail position and can't be eliminated as required by @tailrec"
+        );
+    }
+}
+
+TEST(InferAttributes, regionArraysDontEscape) {
+    const auto input = R"META(
+        package test;
+
+        @region
+        int sum(int n) {
+            int[] values = int[n];
+            return values.length;
+        }
+
+        @region
+        int[] range(int n) {
+            return int[n];
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    try {
+        analyse(parser, act, input);
+        FAIL() << "Array returned from @region function was not detected";
+    } catch (const SemanticError& err) {
+        EXPECT_EQ(std::string{err.what()}, "Function 'range' can't return arrays allocated in its @region");
+    }
+}
+
+} // anonymous namespace
+} // namespace meta::analysers::tests::attributes
@@ -0,0 +1,227 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/constfolder.h"
+#include "analysers/resolver.h"
+
+namespace meta::analysers::tests::constfolder {
+namespace {
+
+TEST(ConstFolding, arithmetic) {
+    const auto input = R"META(
+        package test;
+
+        int foo() {return 2*3 + -(4 - 10)/2;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    auto returns = ast->getChildren<Return>(infinitDepth);
+    ASSERT_EQ(returns.size(), 1u);
+    auto num = dynamic_cast<Number*>(returns[0]->value());
+    ASSERT_NE(num, nullptr);
+    EXPECT_EQ(num->value(), 9);
+    ASSERT_TRUE(num->type());
+    EXPECT_EQ(num->type()->typeId(), typesystem::Type::Int);
+}
+
+TEST(ConstFolding, divisionByZeroIsNotFolded) {
+    const auto input = R"META(
+        package test;
+
+        int foo() {return 1/0;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    auto returns = ast->getChildren<Return>(infinitDepth);
+    ASSERT_EQ(returns.size(), 1u);
+    EXPECT_NE(dynamic_cast<BinaryOp*>(returns[0]->value()), nullptr);
+}
+
+TEST(ConstFolding, booleanSimplification) {
+    const auto input = R"META(
+        package test;
+
+        bool foo(int x) {return x > 0 && !false;}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    auto returns = ast->getChildren<Return>(infinitDepth);
+    ASSERT_EQ(returns.size(), 1u);
+    auto cmp = dynamic_cast<BinaryOp*>(returns[0]->value());
+    ASSERT_NE(cmp, nullptr);
+    EXPECT_EQ(cmp->operation(), BinaryOp::greater);
+}
+
+TEST(ConstFolding, sideEffectsPreserved) {
+    const auto input = R"META(
+        package test;
+
+        int bar() {return 1;}
+        int foo() {return 0*bar();}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    auto calls = ast->getChildren<Call>(infinitDepth);
+    EXPECT_EQ(calls.size(), 1u);
+}
+
+TEST(ConstFolding, ifPruning) {
+    const auto input = R"META(
+        package test;
+
+        int foo(int x) {
+            if (1 < 2)
+                return x;
+            return 0;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    EXPECT_TRUE(ast->getChildren<If>(infinitDepth).empty());
+    auto returns = ast->getChildren<Return>(infinitDepth);
+    ASSERT_EQ(returns.size(), 1u);
+    EXPECT_NE(dynamic_cast<Var*>(returns[0]->value()), nullptr);
+}
+
+TEST(ConstFolding, ifWithoutElsePruning) {
+    const auto input = R"META(
+        package test;
+
+        int foo(int x) {
+            if (false)
+                return 0;
+            return x;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    EXPECT_TRUE(ast->getChildren<If>(infinitDepth).empty());
+    auto returns = ast->getChildren<Return>(infinitDepth);
+    ASSERT_EQ(returns.size(), 1u);
+    EXPECT_NE(dynamic_cast<Var*>(returns[0]->value()), nullptr);
+}
+
+TEST(ConstFolding, loopPruning) {
+    const auto input = R"META(
+        package test;
+
+        extern void bar(int x);
+
+        int foo(int x) {
+            while (1 > 2)
+                bar(x);
+            for (int i = x; 2 < 1; i = i + 1)
+                bar(i);
+            for (int j = 0; j < x; j = j + (1 + 1))
+                bar(j);
+            return x;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    EXPECT_TRUE(ast->getChildren<While>(infinitDepth).empty());
+    auto loops = ast->getChildren<For>(infinitDepth);
+    ASSERT_EQ(loops.size(), 1u);
+    EXPECT_EQ(loops[0]->init()->name(), "j");
+    // loop variable of the pruned loop is still declared
+    EXPECT_EQ(ast->getChildren<VarDecl>(infinitDepth).size(), 4u);
+    EXPECT_EQ(ast->getChildren<Call>(infinitDepth).size(), 1u);
+}
+
+TEST(ConstFolding, defaultArgFoldedOnce) {
+    const auto input = R"META(
+        package test;
+
+        int dist(int x, int y = 2*3) {return x*x + y*y;}
+        int foo() {return dist(1);}
+        int bar() {return dist(2);}
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    auto funcs = ast->getChildren<Function>(infinitDepth);
+    ASSERT_EQ(funcs.size(), 3u);
+    auto defaultVal = dynamic_cast<Number*>(funcs[0]->args()[1]->initExpr());
+    ASSERT_NE(defaultVal, nullptr);
+    EXPECT_EQ(defaultVal->value(), 6);
+    auto calls = ast->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(calls.size(), 2u);
+    for (auto call: calls) {
+        ASSERT_EQ(call->args().size(), 2u);
+        EXPECT_EQ(call->args()[1].get(), defaultVal);
+    }
+}
+
+} // anonymous namespace
+} // namespace meta::analysers::tests::constfolder
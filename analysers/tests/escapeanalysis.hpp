@@ -0,0 +1,114 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/attributes.h"
+#include "analysers/constfolder.h"
+#include "analysers/escapeanalysis.h"
+#include "analysers/resolver.h"
+
+namespace meta::analysers::tests::escapeanalysis {
+namespace {
+
+TEST(EscapeAnalysis, stackArrays) {
+    const auto input = R"META(
+        package test;
+
+        int sum(int[] values) {
+            int res = 0;
+            for (int i = 0; i < values.length; i = i + 1)
+                res = res + values[i];
+            return res;
+        }
+
+        int[] keep(int[] values) {
+            return values;
+        }
+
+        int setFirst(int[] values) {
+            values[0] = 1;
+            return values[0];
+        }
+
+        int last(int[] values, int n) {
+            if (n == 0)
+                return values[values.length - 1];
+            return last(values, n - 1);
+        }
+
+        int[] make() {
+            int[] res = int[6];
+            return res;
+        }
+
+        int foo(int n) {
+            int[] local = int[1];
+            local[0] = n;
+            int[] kept = int[2];
+            int[] written = int[3];
+            int[] big = int[1000];
+            int[] dynamic = int[n];
+            int[] mixed = int[8];
+            mixed[0] = local.length;
+            mixed = make();
+            string[] names = string[7];
+            return
+                sum(local) + sum(int[5]) + keep(kept).length + setFirst(written) + sum(big) +
+                sum(dynamic) + sum(mixed) + names.length + last(int[9], 3)
+            ;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    ASSERT_ANALYSE(inferAttributes(ast));
+    size_t moved = 0;
+    ASSERT_ANALYSE(moved = allocateArraysOnStack(ast));
+    std::set<int> stackSizes;
+    for (auto array: ast->getChildren<NewArray>(infinitDepth)) {
+        if (array->stackAllocated())
+            stackSizes.insert(dynamic_cast<Number*>(array->size())->value());
+    }
+    EXPECT_EQ(stackSizes, (std::set<int>{1, 5, 8}));
+    EXPECT_EQ(moved, 3u);
+    std::set<std::string> stackVars;
+    for (auto var: ast->getChildren<VarDecl>(infinitDepth)) {
+        if (var->flags() & VarFlags::stackArray)
+            stackVars.insert(static_cast<std::string>(var->name()));
+    }
+    EXPECT_EQ(stackVars, (std::set<std::string>{"local"}));
+}
+
+} // anonymous namespace
+} // namespace meta::analysers::tests::escapeanalysis
@@ -0,0 +1,87 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/constfolder.h"
+#include "analysers/rangeanalysis.h"
+#include "analysers/resolver.h"
+
+namespace meta::analysers::tests::rangeanalysis {
+namespace {
+
+TEST(RangeAnalysis, boundsChecks) {
+    const auto input = R"META(
+        package test;
+
+        int foo(int[] values, int[] other, int x) {
+            int sum = 0;
+            for (int i = 0; i < values.length; i = i + 1)
+                sum = sum + values[i] + other[i] + values[x];
+            for (int j = 0; j < values.length; j = 1 + j) {
+                for (int k = 1; k < other.length; k = k + 1)
+                    sum = sum + values[j] + other[k];
+            }
+            for (int l = -1; l < values.length; l = l + 1)
+                sum = sum + values[l];
+            for (int m = 0; m < values.length; m = m + 1) {
+                sum = sum + values[m];
+                m = m + x;
+            }
+            for (int n = 0; n <= values.length; n = n + 1)
+                sum = sum + values[n];
+            return sum;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(foldConstants(ast));
+    ASSERT_ANALYSE(eliminateBoundsChecks(ast));
+    std::vector<std::pair<std::string, std::string>> unchecked;
+    for (auto index: ast->getChildren<Index>(infinitDepth)) {
+        if (!index->boundsChecked()) {
+            unchecked.emplace_back(
+                static_cast<std::string>(dynamic_cast<Var*>(index->array())->name()),
+                static_cast<std::string>(dynamic_cast<Var*>(index->index())->name())
+            );
+        }
+    }
+    const std::vector<std::pair<std::string, std::string>> expected = {
+        {"values", "i"}, {"values", "j"}, {"other", "k"}
+    };
+    EXPECT_EQ(unchecked, expected);
+}
+
+} // anonymous namespace
+} // namespace meta::analysers::tests::rangeanalysis
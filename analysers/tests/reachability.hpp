@@ -91,6 +91,20 @@ utils::ErrorTestData testData[] = {
             }
         )META"_fake_src,
         .errMsg = "Code is unreachable due to return statement at position 9:21"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            auto foo(int x) {
+                while (x > 0) {
+                    return x;
+                    x = x - 1;
+                }
+                return 0;
+            }
+        )META"_fake_src,
+        .errMsg = "Code is unreachable due to return statement at position 6:21"
     }
 };
 INSTANTIATE_TEST_CASE_P(semanticErrors, Reachability, ::testing::ValuesIn(testData));
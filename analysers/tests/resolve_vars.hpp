@@ -1,9 +1,12 @@
 #pragma once
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "utils/testtools.h"
 
+#include "parser/function.h"
 #include "parser/metaparser.h"
 #include "parser/var.h"
 #include "parser/vardecl.h"
@@ -76,5 +79,112 @@ TEST(ResolveVars, complexUsage) {
     }
 }
 
+TEST(ResolveVars, denseSlots) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        int foo(int x, int y) {
+            int a = x;
+            if (y > 0) {
+                int b = y;
+                a = a + b;
+            } else {
+                int c = a;
+                a = c - y;
+            }
+            return a;
+        }
+
+        int bar(int z) {
+            int d = z*2;
+            return d;
+        }
+    )META"_fake_src;
+
+    Parser parser;
+    Actions act;
+    parser.setNodeActions(&act);
+    parser.setParseActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    for (auto* func: ast->getChildren<Function>(infinitDepth)) {
+        const auto decls = func->getChildren<VarDecl>(infinitDepth);
+        ASSERT_EQ(func->slotsCount(), decls.size()) << func->name();
+        std::vector<bool> used(decls.size(), false);
+        for (auto* decl: decls) {
+            ASSERT_LT(decl->slot(), used.size()) << decl->name();
+            EXPECT_FALSE(used[decl->slot()]) << decl->name();
+            used[decl->slot()] = true;
+        }
+        for (size_t i = 0; i < func->args().size(); ++i)
+            EXPECT_EQ(func->args()[i]->slot(), i);
+    }
+}
+
+TEST(ResolveVars, loopScopes) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        int foo(int n) {
+            int sum = 0;
+            for (int i = 0; i < n; i = i + 1) {
+                int sq = i*i;
+                sum = sum + sq;
+            }
+            for (int i = n; i > 0; i = i - 1)
+                sum = sum - i;
+            while (sum > n) {
+                int half = sum/2;
+                sum = half;
+            }
+            return sum;
+        }
+    )META"_fake_src;
+
+    Parser parser;
+    Actions act;
+    parser.setNodeActions(&act);
+    parser.setParseActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    const auto loops = ast->getChildren<For>(infinitDepth);
+    ASSERT_EQ(loops.size(), 2u);
+    for (auto* loop: loops) {
+        for (auto* var: loop->getChildren<Var>(infinitDepth)) {
+            if (var->name() == "i")
+                EXPECT_EQ(var->declaration(), loop->init());
+        }
+    }
+    auto func = ast->getChildren<Function>(infinitDepth)[0];
+    EXPECT_EQ(func->slotsCount(), func->getChildren<VarDecl>(infinitDepth).size());
+}
+
+TEST(ResolveVars, loopVarNotVisibleAfterLoop) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        int foo(int n) {
+            for (int i = 0; i < n; i = i + 1)
+                ;
+            return i;
+        }
+    )META"_fake_src;
+
+    Parser parser;
+    Actions act;
+    parser.setNodeActions(&act);
+    parser.setParseActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    try {
+        resolve(ast, act.dictionary());
+        FAIL() << "Loop variable is accessible after the loop";
+    } catch (const SemanticError& err) {
+        EXPECT_STREQ(err.what(), "Undefined variable 'i'");
+    }
+}
+
 } // anonymous namespace
 } // namespace meta::analysers
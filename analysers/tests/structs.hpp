@@ -0,0 +1,338 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/metaprocessor.h"
+#include "analysers/resolver.h"
+#include "analysers/semanticerror.h"
+
+namespace meta::analysers::tests::structs {
+namespace {
+
+TEST(Structs, layout) {
+    const auto input = R"META(
+        package test;
+
+        struct Plain {bool flag; double value; int id;}
+
+        @reorder
+        struct Reordered {bool flag; double value; int id;}
+
+        @packed
+        struct Packed {bool flag; double value; int id;}
+
+        @align(32)
+        struct Aligned {int id; Reordered inner;}
+
+        struct Outer {bool flag; Aligned aligned;}
+
+        int foo(Outer outer) {
+            Outer copy = outer;
+            copy.aligned.inner.id = 5;
+            return copy.aligned.inner.id + outer.aligned.id;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(processMeta(ast));
+
+    auto structs = ast->getChildren<Struct>();
+    ASSERT_EQ(structs.size(), 5u);
+    struct Expected {
+        std::vector<size_t> offsets;
+        size_t size;
+        size_t alignment;
+    };
+    const Expected expected[] = {
+        {{0, 8, 16}, 24, 8},
+        {{12, 0, 8}, 16, 8},
+        {{0, 1, 9}, 13, 1},
+        {{0, 8}, 32, 32},
+        {{0, 32}, 64, 32}
+    };
+    for (size_t pos = 0; pos < structs.size(); ++pos) {
+        ASSERT_TRUE(structs[pos]->complete()) << structs[pos]->name();
+        const auto layout = structs[pos]->layout();
+        EXPECT_EQ(layout.offsets, expected[pos].offsets) << structs[pos]->name();
+        EXPECT_EQ(layout.size, expected[pos].size) << structs[pos]->name();
+        EXPECT_EQ(layout.alignment, expected[pos].alignment) << structs[pos]->name();
+    }
+
+    auto members = ast->getChildren<MemberAccess>(infinitDepth);
+    ASSERT_FALSE(members.empty());
+    for (MemberAccess* member: members) {
+        EXPECT_NE(member->targetStruct(), nullptr) << member->memberName();
+        EXPECT_NE(member->memberDecl(), nullptr) << member->memberName();
+    }
+}
+
+TEST(Structs, soaArrays) {
+    const auto input = R"META(
+        package test;
+
+        struct Point {int x; int y;}
+
+        @soa
+        struct Particle {bool alive; Point pos; double mass; int id;}
+
+        struct Particle[] moved(struct Particle[] particles, int dx) {
+            for (int i = 0; i < particles.length; i = i + 1)
+                particles[i].pos.x = particles[i].pos.x + dx;
+            return particles;
+        }
+
+        double heaviest(int count) {
+            struct Particle[] particles = moved(struct Particle[count], 1);
+            Particle first = particles[0];
+            particles[1] = first;
+            return particles[1].mass;
+        }
+    )META"_fake_src;
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    ASSERT_ANALYSE(resolve(ast, act.dictionary()));
+    ASSERT_ANALYSE(processMeta(ast));
+
+    auto structs = ast->getChildren<Struct>();
+    ASSERT_EQ(structs.size(), 2u);
+    Struct* particle = structs[1];
+    EXPECT_TRUE(particle->soa());
+    EXPECT_FALSE(structs[0]->soa());
+    const auto columns = particle->columns();
+    EXPECT_EQ(columns.order, (std::vector<size_t>{2, 1, 3, 0}));
+    EXPECT_EQ(columns.starts, (std::vector<size_t>{20, 8, 0, 16}));
+    EXPECT_EQ(columns.rowSize, 21u);
+
+    const auto arrayType = typesystem::Type::arrayOf(particle);
+    EXPECT_EQ(arrayType.name(), "Particle[]");
+    for (NewArray* node: ast->getChildren<NewArray>(infinitDepth))
+        EXPECT_EQ(node->type(), arrayType);
+    for (Index* node: ast->getChildren<Index>(infinitDepth))
+        EXPECT_EQ(node->type(), typesystem::Type{particle});
+    auto funcs = ast->getChildren<Function>();
+    ASSERT_EQ(funcs.size(), 2u);
+    EXPECT_EQ(funcs[0]->type(), arrayType);
+    EXPECT_EQ(funcs[0]->args()[0]->type(), arrayType);
+}
+
+class StructErrors: public utils::ErrorTest {};
+
+TEST_P(StructErrors, structErrors) {
+    const auto& param = GetParam();
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, param.input);
+    auto ast = parser.ast();
+    try {
+        resolve(ast, act.dictionary());
+        processMeta(ast);
+        FAIL() << "Error was not detected: " << param.errMsg;
+    } catch (const SemanticError &err) {
+        EXPECT_EQ(param.errMsg, err.what()) << err.what();
+    }
+}
+
+utils::ErrorTestData structErrorsData[] = {
+    {
+        .input = R"META(
+            package test;
+
+            struct A {B b;}
+            struct B {A a;}
+        )META"_fake_src,
+        .errMsg = "Struct 'A' contains itself"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {string name;}
+        )META"_fake_src,
+        .errMsg = "Member 'name' of the struct 'S' can't be of type 'string'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {int x = 1 + 2;}
+        )META"_fake_src,
+        .errMsg = "Default value of the member 'x' of the struct 'S' must be a literal"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {int x;}
+
+            int foo(S s) {return s.y;}
+        )META"_fake_src,
+        .errMsg = "Struct 'S' has no member 'y'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {int x;}
+
+            int foo(S s) {
+                s.x = 1;
+                return s.x;
+            }
+        )META"_fake_src,
+        .errMsg = "Attempt to modify function argument 's'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {int x;}
+
+            S make() {
+                S res;
+                return res;
+            }
+
+            int foo() {
+                make().x = 1;
+                return 0;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't assign to a member of a temporary value"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo() {
+                int[] values = int[2];
+                values.length = 1;
+                return values.length;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't assign to the member 'length' of the value of type 'int[]'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            struct S {int x;}
+
+            bool same(S lhs, S rhs) {return lhs == rhs;}
+        )META"_fake_src,
+        .errMsg = "Can't compare values of types 'S' and 'S'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @align(3)
+            struct S {int x;}
+        )META"_fake_src,
+        .errMsg = "Invalid value 3 of the attribute 'align'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @align
+            struct S {int x;}
+        )META"_fake_src,
+        .errMsg = "Attribute 'align' requires an argument"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @packed(1)
+            struct S {int x;}
+        )META"_fake_src,
+        .errMsg = "Attribute 'packed' takes no arguments"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int n) {
+                return struct S[n].length;
+            }
+        )META"_fake_src,
+        .errMsg = "Array of unknown struct 'S'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @soa
+            struct S {int x;}
+            struct T {struct S[] items;}
+        )META"_fake_src,
+        .errMsg = "Member 'items' of the struct 'T' can't be of type 'S[]'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @soa
+            struct S {int x;}
+
+            struct S[] make(int n) {return struct S[n];}
+
+            int foo() {
+                make(2)[0].x = 1;
+                return 0;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't assign to a member of a temporary value"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            @align(32)
+            struct S {int x;}
+
+            int foo(int n) {
+                return struct S[n].length;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't allocate array of the struct 'S' aligned to 32 bytes, at most 16 bytes alignment is supported"
+    }
+};
+INSTANTIATE_TEST_CASE_P(invalidStructs, StructErrors, ::testing::ValuesIn(structErrorsData));
+
+} // anonymous namespace
+} // namespace meta::analysers::tests::structs
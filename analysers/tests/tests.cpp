@@ -1,9 +1,14 @@
 #include "actions.hpp"
+#include "attributes.hpp"
+#include "constfolder.hpp"
+#include "escapeanalysis.hpp"
 #include "metaprocessor.hpp"
+#include "rangeanalysis.hpp"
 #include "reachability.hpp"
 #include "resolver.hpp"
 #include "resolve_call.hpp"
 #include "resolve_from_null.hpp"
 #include "resolve_imports.hpp"
 #include "resolve_vars.hpp"
+#include "structs.hpp"
 #include "typechecker.hpp"
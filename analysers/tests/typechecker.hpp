@@ -417,6 +417,154 @@ utils::ErrorTestData testData[] = {
         )META"_fake_src,
         .errMsg = "If statement can't work with condition of type 'int'"
     },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int x) {
+                while (x)
+                    x = x - 1;
+                return x;
+            }
+        )META"_fake_src,
+        .errMsg = "While statement can't work with condition of type 'int'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int n) {
+                int sum = 0;
+                for (int i = 0; i + n; i = i + 1)
+                    sum = sum + i;
+                return sum;
+            }
+        )META"_fake_src,
+        .errMsg = "For statement can't work with condition of type 'int'"
+    },
+    // Types are checked inside loop bodies
+    {
+        .input = R"META(
+            package test;
+
+            bool foo(int x, int y) {
+                for (int i = 0; i < x; i = i + 1) {
+                    if (i && y)
+                        return true;
+                }
+                return false;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't perform boolean operations on values of types 'int' and 'int'"
+    },
+    // Arrays
+    {
+        .input = R"META(
+            package test;
+
+            int[] foo(bool n) {
+                return int[n];
+            }
+        )META"_fake_src,
+        .errMsg = "Array size must be of type 'int' not 'bool'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int x) {
+                return x[0];
+            }
+        )META"_fake_src,
+        .errMsg = "Can't index value of type 'int'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int[] values) {
+                return values[true];
+            }
+        )META"_fake_src,
+        .errMsg = "Array index must be of type 'int' not 'bool'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(bool[] values) {
+                values[0] = 1;
+                return values.length;
+            }
+        )META"_fake_src,
+        .errMsg = "Attempt to assign value of type 'int' to an element of 'bool[]' array"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int[] make(int n) {
+                return int[n];
+            }
+
+            int foo() {
+                make(3)[0] = 1;
+                return 0;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't assign to an element of a temporary array"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(int[] values) {
+                return values.size;
+            }
+        )META"_fake_src,
+        .errMsg = "Type 'int[]' has no member 'size'"
+    },
+    // Strings
+    {
+        .input = R"META(
+            package test;
+
+            string foo(string str, int n) {
+                return str + n;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't perform arythmetic operation on values of types 'string' and 'int'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            string foo(string lhs, string rhs) {
+                return lhs - rhs;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't perform arythmetic operation on values of types 'string' and 'string'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            bool foo(int[] lhs, int[] rhs) {
+                return lhs == rhs;
+            }
+        )META"_fake_src,
+        .errMsg = "Can't compare values of types 'int[]' and 'int[]'"
+    },
+    {
+        .input = R"META(
+            package test;
+
+            int foo(bool[] values) {
+                return values.sum;
+            }
+        )META"_fake_src,
+        .errMsg = "Type 'bool[]' has no member 'sum'"
+    },
     // Types are checked inside if branches
     {
         .input = R"META(
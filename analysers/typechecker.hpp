@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stack>
+#include <typeindex>
 #include <vector>
 
 #include "utils/contract.h"
@@ -66,9 +67,85 @@ struct TypeEvaluator {
         return node->type();
     }
 
+    utils::optional<Type> operator() (NewArray* node, Scope& scope) {
+        utils::optional<Type> sizeType = dispatch(*this, node->size(), scope);
+        if (sizeType->typeId() != typesystem::Type::Int)
+            throw SemanticError(node->size(), "Array size must be of type 'int' not '%s'", sizeType->name());
+        // Arrays of structs are typed by the resolver
+        if (node->type())
+            return node->type();
+        utils::optional<Type> elementType = scope.findType(node->elementTypeName());
+        PRECONDITION(elementType); // grammar allows built in element types and structs only
+        node->setType(Type::arrayOf(elementType->typeId()));
+        return node->type();
+    }
+
+    utils::optional<Type> operator() (Index* node, Scope& scope) {
+        utils::optional<Type> arrayType = dispatch(*this, node->array(), scope);
+        if (!(arrayType->properties() & typesystem::TypeProp::array))
+            throw SemanticError(node->array(), "Can't index value of type '%s'", arrayType->name());
+        utils::optional<Type> indexType = dispatch(*this, node->index(), scope);
+        if (indexType->typeId() != typesystem::Type::Int)
+            throw SemanticError(node->index(), "Array index must be of type 'int' not '%s'", indexType->name());
+        node->setType(arrayType->element());
+        return node->type();
+    }
+
+    utils::optional<Type> operator() (MemberAccess* node, Scope& scope) {
+        utils::optional<Type> parentType = dispatch(*this, node->parent(), scope);
+        if (parentType->typeId() == Type::Struct) {
+            // Struct declarations are the only aggregate types descriptions
+            auto strct = static_cast<const Struct*>(parentType->aggregate());
+            for (const auto& member: strct->members()) {
+                if (member->name() != node->memberName())
+                    continue;
+                node->setTargetStruct(strct);
+                node->setMemberDecl(member.get());
+                node->setType(member->type());
+                return node->type();
+            }
+            throw SemanticError(node, "Struct '%s' has no member '%s'", strct->name(), node->memberName());
+        }
+        const bool hasLength = (parentType->properties() & typesystem::TypeProp::array) || parentType == Type{Type::String};
+        if (hasLength && node->memberName() == "length") {
+            node->setType(scope.findType(typesystem::BuiltinType::Int));
+            return node->type();
+        }
+        // Reductions computed by meta-rt
+        const bool reduction = node->memberName() == "sum" || node->memberName() == "min" || node->memberName() == "max";
+        if (parentType == Type::arrayOf(Type::Int) && reduction) {
+            node->setType(scope.findType(typesystem::BuiltinType::Int));
+            return node->type();
+        }
+        throw SemanticError(node, "Type '%s' has no member '%s'", parentType->name(), node->memberName());
+    }
+
     utils::optional<Type> operator() (Assigment* node, Scope& scope) {
         utils::optional<Type> valueType = dispatch(*this, node->value(), scope);
+        if (node->target()->getVisitableType() == std::type_index(typeid(Index))) {
+            auto element = static_cast<Index*>(node->target());
+            if (dispatch(*this, element, scope) != valueType)
+                throw SemanticError(
+                    node, "Attempt to assign value of type '%s' to an element of '%s' array",
+                    valueType->name(), element->array()->type()->name()
+                );
+            // Arrays are copied on write so the array must be stored somewhere to see the change
+            if (!dynamic_cast<Var*>(element->array()))
+                throw SemanticError(node, "Can't assign to an element of a temporary array");
+            node->setType(element->type());
+            return node->type();
+        }
 
+        if (node->target()->getVisitableType() == std::type_index(typeid(MemberAccess))) {
+            auto member = static_cast<MemberAccess*>(node->target());
+            dispatch(*this, member, scope);
+            // Members of built in types are read only
+            if (!member->memberDecl())
+                throw SemanticError(
+                    node, "Can't assign to the member '%s' of the value of type '%s'",
+                    member->memberName(), member->parent()->type()->name()
+                );
+        }
         struct {
             utils::optional<Type> operator() (Node* node, utils::optional<Type>) {
               throw UnexpectedNode(node, "Variable or access to Memeber required");
@@ -131,6 +208,12 @@ struct TypeEvaluator {
 
         switch (node->operation()) {
             case BinaryOp::add:
+                // Concatenation
+                if (lhs == Type{Type::String} && rhs == Type{Type::String}) {
+                    node->setType(lhs);
+                    break;
+                }
+                // fallthrough
             case BinaryOp::div:
             case BinaryOp::sub:
             case BinaryOp::mul:
@@ -149,7 +232,11 @@ struct TypeEvaluator {
 
             case BinaryOp::equal:
             case BinaryOp::noteq:
-                if (lhs != rhs)
+                // Arrays are shared mutable memory and have no equality defined yet as well as structs
+                if (
+                    lhs != rhs || (lhs->properties() & typesystem::TypeProp::array) ||
+                    (lhs->properties() & typesystem::TypeProp::namedComponents)
+                )
                     throw SemanticError(node, "Can't compare values of types '%s' and '%s'", lhs->name(), rhs->name());
                 node->setType(scope.findType(typesystem::BuiltinType::Bool));
                 break;
@@ -185,10 +272,6 @@ struct TypeEvaluator {
     utils::optional<Type> operator() (Call* node, Scope& scope);
 };
 
-utils::optional<Type> type_of(Node* node, Scope& scope) {
-    return dispatch(TypeEvaluator{}, node, scope);
-}
-
 class TypeChecker: public Visitor {
 public:
     explicit TypeChecker(Scope& scope): mScope(scope) {}
@@ -196,7 +279,7 @@ public:
     bool visit(Function* node) override {
         if (node->type())
             return false;
-        node->setType(mScope.findType(node->retType()));
+        node->setType(node->declaredRetType() ? node->declaredRetType() : mScope.findType(node->retType()));
         if (!node->type())
             throw SemanticError(node, "Function '%s' returns unknown type '%s'", node->name(), node->retType());
         mCurrFunc = node;
@@ -218,7 +301,9 @@ public:
         POSTCONDITION(node->type());
         POSTCONDITION(node->type()->properties() & typesystem::TypeProp::complete);
 
-        node->setType(mScope.findType(node->typeName()));
+        // Types named by struct declarations are set by the resolver
+        if (!node->type())
+            node->setType(mScope.findType(node->typeName()));
         if (!node->type())
             throw SemanticError(node, "Variable '%s' has unknown type '%s'", node->name(), node->typeName());
         if (!node->inited()) {
@@ -249,6 +334,26 @@ public:
         return false;
     }
 
+    bool visit(While* node) override {
+        utils::optional<Type> condType = dispatch(TypeEvaluator{}, node->condition(), mScope);
+        if (!(condType->properties() & typesystem::TypeProp::boolean))
+            throw SemanticError(node->condition(), "While statement can't work with condition of type '%s'", condType->name());
+        if (node->body())
+            node->body()->walk(this);
+        return false;
+    }
+
+    bool visit(For* node) override {
+        node->init()->walk(this);
+        utils::optional<Type> condType = dispatch(TypeEvaluator{}, node->condition(), mScope);
+        if (!(condType->properties() & typesystem::TypeProp::boolean))
+            throw SemanticError(node->condition(), "For statement can't work with condition of type '%s'", condType->name());
+        dispatch(TypeEvaluator{}, node->step(), mScope);
+        if (node->body())
+            node->body()->walk(this);
+        return false;
+    }
+
     bool visit(meta::Return* node) override {
         utils::optional<Type> ret = node->value() == nullptr ?
             mScope.findType(typesystem::BuiltinType::Void):
@@ -0,0 +1,65 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+
+namespace meta::cache {
+
+/// Information about source file which is necessary to find out what should be recompiled
+struct SourceInfo {
+    std::string package;
+    std::vector<std::string> imports;
+};
+
+/**
+ * On disk storage of the compilation results.
+ *
+ * Source infos are keyed by the source file content hash. Package interface summaries and package
+ * bitcode are keyed by the package key which is a hash of the package sources and interfaces of
+ * the imported packages.
+ *
+ * Entries read or written once are kept in memory so that the same cache object reused by a long
+ * living process does not touch disk for them again.
+ */
+class CompileCache {
+public:
+    explicit CompileCache(const utils::fs::path& dir);
+
+    utils::optional<SourceInfo> source(utils::string_view hash) const;
+    void storeSource(utils::string_view hash, const SourceInfo& info);
+
+    /// Returns nullopt if package compiled with the key is not found in the cache
+    utils::optional<std::string> packageInterface(utils::string_view key) const;
+    /// Location where bitcode of the package with the key should be stored or read from
+    utils::fs::path packageBitcode(utils::string_view key) const;
+    /// Should be called after package bitcode is written to make package entry complete
+    void storePackageInterface(utils::string_view key, const std::string& iface);
+
+private:
+    utils::fs::path mDir;
+    mutable std::map<std::string, SourceInfo> mSources;
+    mutable std::map<std::string, std::string> mInterfaces;
+};
+
+} // namespace meta::cache
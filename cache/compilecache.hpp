@@ -0,0 +1,114 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+
+#include "utils/io.h"
+#include "utils/string.h"
+
+#include "cache/compilecache.h"
+
+namespace meta::cache {
+namespace {
+
+constexpr utils::string_view sourcesDir = "sources"sv;
+constexpr utils::string_view packagesDir = "packages"sv;
+
+utils::fs::path entryPath(const utils::fs::path& dir, utils::string_view kind, utils::string_view key, utils::string_view ext = {}) {
+    std::string filename{key};
+    filename.append(ext.begin(), ext.end());
+    return dir/std::string{kind}/filename;
+}
+
+/// Writes into temporary file first so that interrupted compilation never leaves broken entry
+void writeEntry(const utils::fs::path& path, const std::string& content) {
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        auto out = utils::open<utils::IO::out>(tmp, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        out << content;
+    }
+    utils::fs::rename(tmp, path);
+}
+
+} // anonymous namespace
+
+CompileCache::CompileCache(const utils::fs::path& dir): mDir(dir) {
+    utils::fs::create_directories(mDir/std::string{sourcesDir});
+    utils::fs::create_directories(mDir/std::string{packagesDir});
+}
+
+utils::optional<SourceInfo> CompileCache::source(utils::string_view hash) const {
+    auto memIt = mSources.find(std::string{hash});
+    if (memIt != mSources.end())
+        return memIt->second;
+    const auto path = entryPath(mDir, sourcesDir, hash);
+    if (!utils::fs::exists(path))
+        return utils::nullopt;
+    // First line is the package name, the rest are imported packages
+    const std::string content = utils::readAll(path);
+    SourceInfo res;
+    bool first = true;
+    for (utils::string_view line: utils::split(content, '\n')) {
+        if (line.empty())
+            continue;
+        if (first)
+            res.package = std::string{line};
+        else
+            res.imports.emplace_back(line);
+        first = false;
+    }
+    if (res.package.empty())
+        return utils::nullopt;
+    mSources.emplace(std::string{hash}, res);
+    return res;
+}
+
+void CompileCache::storeSource(utils::string_view hash, const SourceInfo& info) {
+    std::string content = info.package + '\n';
+    for (const auto& import: info.imports)
+        content += import + '\n';
+    writeEntry(entryPath(mDir, sourcesDir, hash), content);
+    mSources[std::string{hash}] = info;
+}
+
+utils::optional<std::string> CompileCache::packageInterface(utils::string_view key) const {
+    // Bitcode might be removed by cache cleanup even if interface is kept in memory
+    if (!utils::fs::exists(packageBitcode(key)))
+        return utils::nullopt;
+    auto memIt = mInterfaces.find(std::string{key});
+    if (memIt != mInterfaces.end())
+        return memIt->second;
+    const auto ifacePath = entryPath(mDir, packagesDir, key, ".iface"sv);
+    if (!utils::fs::exists(ifacePath))
+        return utils::nullopt;
+    return mInterfaces[std::string{key}] = utils::readAll(ifacePath);
+}
+
+utils::fs::path CompileCache::packageBitcode(utils::string_view key) const {
+    return entryPath(mDir, packagesDir, key, ".bc"sv);
+}
+
+void CompileCache::storePackageInterface(utils::string_view key, const std::string& iface) {
+    writeEntry(entryPath(mDir, packagesDir, key, ".iface"sv), iface);
+    mInterfaces[std::string{key}] = iface;
+}
+
+} // namespace meta::cache
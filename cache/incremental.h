@@ -0,0 +1,50 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <vector>
+
+#include "utils/types.h"
+
+#include "generators/generator.h"
+
+#include "cache/compilecache.h"
+#include "cache/sourcecache.h"
+
+namespace meta::cache {
+
+/**
+ * Compiles sources into output reusing per package results of the previous compilations stored
+ * in the cache.
+ *
+ * Package is recompiled only if one of its sources or interface of one of the packages it imports
+ * is changed. Changed packages are analysed first, so their dependents are not even parsed when
+ * the changes affect implementation only. Packages participating in import cycles are always
+ * reanalysed. Parsing and semantic
+ * errors are reported with the same exceptions as for the non incremental compilation.
+ *
+ * Source files are taken from the sourceCache so long living processes can avoid rereading
+ * unchanged files.
+ */
+void buildIncremental(
+    const std::vector<utils::fs::path>& sources, SourceCache& sourceCache, CompileCache& cache,
+    generators::Generator& generator, const utils::fs::path& output
+);
+
+} // namespace meta::cache
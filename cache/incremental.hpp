@@ -0,0 +1,300 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "utils/contract.h"
+#include "utils/hash.h"
+#include "utils/io.h"
+
+#include "parser/import.h"
+#include "parser/metaparser.h"
+#include "parser/sourcefile.h"
+
+#include "analysers/actions.h"
+#include "analysers/attributes.h"
+#include "analysers/constfolder.h"
+#include "analysers/escapeanalysis.h"
+#include "analysers/metaprocessor.h"
+#include "analysers/rangeanalysis.h"
+#include "analysers/reachabilitychecker.h"
+#include "analysers/resolver.h"
+
+#include "cache/incremental.h"
+#include "cache/interface.h"
+#include "cache/sourcecache.h"
+
+namespace meta::cache {
+namespace {
+
+/// Changing this value invalidates all previously cached packages
+constexpr utils::string_view cacheFormat = "meta-cache-2"sv;
+/// Declarations of this package are visible from all other packages without import
+constexpr utils::string_view globalPackage = "null"sv;
+
+struct SourceEntry {
+    const CachedSource* source;
+    SourceInfo info;
+};
+
+struct PackageEntry {
+    std::vector<SourceEntry*> sources;
+    std::set<std::string> deps;
+    std::string sourceKey;
+    /// Empty until it's known which cache entry corresponds to the current package state
+    utils::optional<std::string> key;
+    utils::optional<std::string> iface;
+    bool dirty = false;
+};
+
+using Packages = std::map<std::string, PackageEntry>;
+
+SourceInfo scanSource(const utils::SourceFile& src) {
+    Parser parser;
+    analysers::Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    parser.parse(src);
+    SourceInfo res;
+    walk<SourceFile, TopDown>(*parser.ast(), [&res](SourceFile* node) {
+        res.package = std::string{node->package()};
+        return true;
+    });
+    walk<Import, TopDown>(*parser.ast(), [&res](Import* node) {
+        res.imports.emplace_back(node->targetPackage());
+        return false;
+    });
+    return res;
+}
+
+std::string packageKey(const PackageEntry& pkg, const std::map<std::string, std::string>& depIfaces) {
+    utils::Sha256 hasher;
+    hasher.field(cacheFormat).field(pkg.sourceKey);
+    for (const auto& dep: depIfaces)
+        hasher.field(dep.first).field(dep.second);
+    return hasher.hex();
+}
+
+/// Hash of the generator options which affect generated code
+std::string optionsKey(const generators::GeneratorOptions& opts) {
+    utils::Sha256 hasher;
+    hasher.field(opts.debugInfo ? "debug"sv : "nodebug"sv);
+    hasher.field(opts.profileGenerate ? "instrumented"sv : "plain"sv);
+    hasher.field(opts.thinLTO ? "summary"sv : "nosummary"sv);
+    // Profile contents rather than its path define generated code
+    if (!opts.profileUse.empty())
+        hasher.field(utils::readAll(opts.profileUse));
+    return hasher.hex();
+}
+
+/**
+ * Finds cache entry for the package state assuming that package sources are not parsed. Package
+ * which imports not yet analysed packages is left unresolved: it's skipped entirely if the
+ * interfaces of its dependencies turn out to be unchanged after their analysis.
+ */
+class CachedKeys {
+public:
+    CachedKeys(Packages& packages, const CompileCache& cache): mPackages(packages), mCache(cache) {}
+
+    /// Returns package interface or nothing if it's unknown until some packages are analysed
+    const utils::optional<std::string>& iface(const std::string& name) {
+        static const utils::optional<std::string> unknown;
+        auto it = mPackages.find(name);
+        if (it == mPackages.end())
+            return unknown;
+        PackageEntry& pkg = it->second;
+        if (pkg.key || pkg.dirty)
+            return pkg.iface;
+        if (mUnresolved.count(name) != 0)
+            return unknown;
+        // Import cycle: cached interfaces can't be used to build package key
+        if (!mInProgress.insert(name).second)
+            return unknown;
+        std::map<std::string, std::string> depIfaces;
+        bool resolved = true;
+        for (const auto& dep: pkg.deps) {
+            const auto& depIface = iface(dep);
+            if (!depIface) {
+                resolved = false;
+                break;
+            }
+            depIfaces.emplace(dep, *depIface);
+        }
+        mInProgress.erase(name);
+        if (!resolved) {
+            mUnresolved.insert(name);
+            return unknown;
+        }
+        const std::string key = packageKey(pkg, depIfaces);
+        pkg.iface = mCache.packageInterface(key);
+        if (pkg.iface)
+            pkg.key = key;
+        else
+            pkg.dirty = true;
+        return pkg.iface;
+    }
+
+private:
+    Packages& mPackages;
+    const CompileCache& mCache;
+    std::set<std::string> mInProgress;
+    std::set<std::string> mUnresolved;
+};
+
+void addClosure(const Packages& packages, const std::string& name, std::set<std::string>& res) {
+    if (!res.insert(name).second)
+        return;
+    auto it = packages.find(name);
+    if (it == packages.end())
+        return;
+    for (const auto& dep: it->second.deps)
+        addClosure(packages, dep, res);
+}
+
+void analyseAndGenerate(
+    Packages& packages, CompileCache& cache, generators::Generator& generator
+) {
+    std::set<std::string> required;
+    for (const auto& pkg: packages) {
+        if (pkg.second.dirty)
+            addClosure(packages, pkg.first, required);
+    }
+
+    Parser parser;
+    analysers::Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    for (const auto& name: required) {
+        auto it = packages.find(name);
+        if (it == packages.end())
+            continue; // unknown imported package will be reported by resolver
+        for (SourceEntry* src: it->second.sources)
+            parser.parse(src->source->file);
+    }
+    auto ast = parser.ast();
+    analysers::resolve(ast, act.dictionary());
+    analysers::foldConstants(ast);
+    analysers::checkReachability(ast);
+    analysers::processMeta(ast);
+    analysers::inferAttributes(ast);
+    analysers::eliminateBoundsChecks(ast);
+    analysers::allocateArraysOnStack(ast);
+
+    for (const auto& name: required) {
+        auto dictIt = act.dictionary().find(utils::string_view{name});
+        auto& pkg = packages.at(name);
+        if (!pkg.key)
+            pkg.iface = dictIt == act.dictionary().end() ? std::string{} : interfaceSummary(dictIt->second);
+    }
+    for (auto& pkg: packages) {
+        if (!pkg.second.dirty || pkg.second.key)
+            continue;
+        std::map<std::string, std::string> depIfaces;
+        for (const auto& dep: pkg.second.deps)
+            depIfaces.emplace(dep, *packages.at(dep).iface);
+        const std::string key = packageKey(pkg.second, depIfaces);
+        pkg.second.key = key;
+        if (cache.packageInterface(key))
+            continue;
+        generator.generate(ast, pkg.first, cache.packageBitcode(key));
+        cache.storePackageInterface(key, *pkg.second.iface);
+    }
+}
+
+} // anonymous namespace
+
+void buildIncremental(
+    const std::vector<utils::fs::path>& sources, SourceCache& sourceCache, CompileCache& cache,
+    generators::Generator& generator, const utils::fs::path& output
+) {
+    std::vector<SourceEntry> entries;
+    entries.reserve(sources.size());
+    for (const auto& path: sources) {
+        const CachedSource& src = sourceCache.get(path);
+        auto info = cache.source(src.hash);
+        if (!info) {
+            info = scanSource(src.file);
+            cache.storeSource(src.hash, *info);
+        }
+        entries.push_back({&src, std::move(*info)});
+    }
+
+    const std::string genOptions = optionsKey(generator.options());
+    Packages packages;
+    for (auto& entry: entries)
+        packages[entry.info.package].sources.push_back(&entry);
+    const bool hasGlobal = packages.count(std::string{globalPackage}) != 0;
+    for (auto& pkg: packages) {
+        std::vector<utils::string_view> hashes;
+        for (const SourceEntry* src: pkg.second.sources) {
+            hashes.push_back(src->source->hash);
+            pkg.second.deps.insert(src->info.imports.begin(), src->info.imports.end());
+        }
+        if (hasGlobal && pkg.first != globalPackage)
+            pkg.second.deps.insert(std::string{globalPackage});
+        pkg.second.deps.erase(pkg.first);
+        std::sort(hashes.begin(), hashes.end());
+        utils::Sha256 hasher;
+        for (const auto& hash: hashes)
+            hasher.field(hash);
+        // Code generated with different options must not be reused
+        hasher.field(genOptions);
+        pkg.second.sourceKey = hasher.hex();
+    }
+
+    // Changed packages are analysed before their dependents so that dependents which see the same
+    // interfaces as before are taken from the cache without parsing
+    while (true) {
+        CachedKeys cachedKeys{packages, cache};
+        bool dirty = false;
+        bool unresolved = false;
+        for (const auto& pkg: packages) {
+            if (pkg.second.key)
+                continue;
+            cachedKeys.iface(pkg.first);
+            dirty = dirty || (pkg.second.dirty && !pkg.second.key);
+            unresolved = unresolved || (!pkg.second.dirty && !pkg.second.key);
+        }
+        if (!dirty && !unresolved)
+            break;
+        if (!dirty) {
+            // Only import cycles and packages importing unknown ones are left: analyse them together
+            for (auto& pkg: packages) {
+                if (!pkg.second.key)
+                    pkg.second.dirty = true;
+            }
+        }
+        analyseAndGenerate(packages, cache, generator);
+    }
+
+    std::vector<utils::fs::path> modules;
+    modules.reserve(packages.size());
+    for (const auto& pkg: packages) {
+        PRECONDITION(pkg.second.key);
+        modules.push_back(cache.packageBitcode(*pkg.second.key));
+    }
+    generator.link(modules, output);
+}
+
+} // namespace meta::cache
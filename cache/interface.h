@@ -0,0 +1,36 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+
+#include "analysers/dictionary.h"
+
+namespace meta::cache {
+
+/**
+ * Textual summary of everything other packages may depend on: non private functions with their
+ * resolved signatures, default argument expressions and symbol names and non private structs.
+ *
+ * Summary is independent from declarations order so it can be compared and hashed to find out if
+ * dependent packages should be recompiled. Must be called after resolve.
+ */
+std::string interfaceSummary(const PackageDict& pkg);
+
+} // namespace meta::cache
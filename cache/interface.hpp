@@ -0,0 +1,112 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utils/contract.h"
+
+#include "parser/function.h"
+#include "parser/struct.h"
+#include "parser/vardecl.h"
+
+#include "typesystem/type.h"
+
+#include "cache/interface.h"
+
+namespace meta::cache {
+namespace {
+
+utils::string_view typeName(const utils::optional<typesystem::Type>& type) {
+    PRECONDITION(type);
+    return type->name();
+}
+
+std::string functionLine(Function* func) {
+    std::ostringstream out;
+    out << "func " << func->visibility() << ' ' << typeName(func->type()) << ' ' << func->name() << '(';
+    bool first = true;
+    for (const auto& arg: func->args()) {
+        if (!first)
+            out << ", ";
+        first = false;
+        out << typeName(arg->type()) << ' ' << arg->name();
+        if (arg->inited())
+            out << " = " << utils::string_view{arg->initExpr()->tokens()};
+    }
+    out << ')';
+    if (func->flags() & FuncFlags::entrypoint)
+        out << " entrypoint";
+    // Attributes of the declarations used by dependent packages
+    if (func->flags() & FuncFlags::pure)
+        out << " pure";
+    if (func->flags() & FuncFlags::noRecurse)
+        out << " norecurse";
+    if (func->flags() & FuncFlags::cold)
+        out << " cold";
+    if (func->mangledName())
+        out << " mangled " << *func->mangledName();
+    return out.str();
+}
+
+std::string structLine(Struct* strct) {
+    std::ostringstream out;
+    out << "struct " << strct->visibility() << ' ' << strct->name() << " {";
+    for (const auto& member: strct->members()) {
+        out << ' ' << member->typeName() << ' ' << member->name();
+        if (member->inited())
+            out << " = " << utils::string_view{member->initExpr()->tokens()};
+        out << ';';
+    }
+    out << " }";
+    // Layout attributes change sizes and offsets dependent packages are compiled with
+    if (strct->packed())
+        out << " packed";
+    if (strct->reordered())
+        out << " reordered";
+    if (strct->requestedAlignment() != 0)
+        out << " align " << strct->requestedAlignment();
+    if (strct->soa())
+        out << " soa";
+    return out.str();
+}
+
+} // anonymous namespace
+
+std::string interfaceSummary(const PackageDict& pkg) {
+    std::vector<std::string> lines;
+    for (const auto& func: pkg.functions) {
+        if (func->visibility() != Visibility::Private)
+            lines.push_back(functionLine(func));
+    }
+    for (const auto& strct: pkg.structs) {
+        if (strct->visibility() != Visibility::Private)
+            lines.push_back(structLine(strct));
+    }
+    std::sort(lines.begin(), lines.end());
+    std::string res;
+    for (const auto& line: lines)
+        res += line + '\n';
+    return res;
+}
+
+} // namespace meta::cache
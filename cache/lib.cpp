@@ -0,0 +1,4 @@
+#include "compilecache.hpp"
+#include "incremental.hpp"
+#include "interface.hpp"
+#include "sourcecache.hpp"
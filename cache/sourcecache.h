@@ -0,0 +1,54 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "utils/sourcefile.h"
+#include "utils/types.h"
+
+namespace meta::cache {
+
+struct CachedSource {
+    explicit CachedSource(const utils::fs::path& path);
+
+    utils::SourceFile file;
+    std::string hash;
+};
+
+/**
+ * Keeps source files content and hashes in memory between compilations performed by the same
+ * process. File is reread only if its modification time or size is changed.
+ */
+class SourceCache {
+public:
+    const CachedSource& get(const utils::fs::path& path);
+
+private:
+    struct Entry {
+        utils::fs::file_time_type mtime;
+        uintmax_t size;
+        std::unique_ptr<CachedSource> source;
+    };
+    std::map<utils::fs::path, Entry> mEntries;
+};
+
+} // namespace meta::cache
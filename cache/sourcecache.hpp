@@ -0,0 +1,44 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/hash.h"
+
+#include "cache/sourcecache.h"
+
+namespace meta::cache {
+
+CachedSource::CachedSource(const utils::fs::path& path):
+    file(path),
+    hash(utils::hash(file.content()))
+{}
+
+const CachedSource& SourceCache::get(const utils::fs::path& path) {
+    const auto mtime = utils::fs::last_write_time(path);
+    const auto size = utils::fs::file_size(path);
+    auto& entry = mEntries[utils::fs::canonical(path)];
+    if (!entry.source || entry.mtime != mtime || entry.size != size) {
+        entry.source = std::make_unique<CachedSource>(path);
+        entry.mtime = mtime;
+        entry.size = size;
+    }
+    return *entry.source;
+}
+
+} // namespace meta::cache
@@ -0,0 +1,69 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "utils/io.h"
+#include "utils/types.h"
+
+#include "cache/compilecache.h"
+
+namespace meta::cache::tests::compilecache {
+namespace {
+
+class CompileCacheTest: public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = utils::fs::temp_directory_path()/("meta-cache-test-" + std::to_string(::getpid()));
+        utils::fs::remove_all(dir);
+    }
+
+    void TearDown() override {
+        utils::fs::remove_all(dir);
+    }
+
+    utils::fs::path dir;
+};
+
+TEST_F(CompileCacheTest, sourceInfoRoundtrip) {
+    CompileCache cache{dir};
+    EXPECT_FALSE(cache.source("0123"));
+    cache.storeSource("0123", {"foo.bar", {"baz", "null"}});
+
+    CompileCache reopened{dir};
+    auto info = reopened.source("0123");
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->package, "foo.bar");
+    EXPECT_EQ(info->imports, (std::vector<std::string>{"baz", "null"}));
+}
+
+TEST_F(CompileCacheTest, packageRequiresBitcode) {
+    CompileCache cache{dir};
+    cache.storePackageInterface("key", "func Public int foo()\n");
+    EXPECT_FALSE(cache.packageInterface("key"));
+
+    utils::open<utils::IO::out>(cache.packageBitcode("key"), std::ios_base::out) << "BC";
+    auto iface = cache.packageInterface("key");
+    ASSERT_TRUE(iface);
+    EXPECT_EQ(*iface, "func Public int foo()\n");
+}
+
+} // anonymous namespace
+} // namespace meta::cache::tests::compilecache
@@ -0,0 +1,154 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include "utils/testtools.h"
+
+#include "parser/metaparser.h"
+
+#include "analysers/actions.h"
+#include "analysers/metaprocessor.h"
+#include "analysers/resolver.h"
+
+#include "cache/interface.h"
+
+namespace meta::cache::tests::interface {
+namespace {
+
+std::string summary(utils::SourceFile src) {
+    Parser parser;
+    analysers::Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    parser.parse(src);
+    analysers::resolve(parser.ast(), act.dictionary());
+    analysers::processMeta(parser.ast());
+    return interfaceSummary(act.dictionary()["test"sv]);
+}
+
+TEST(InterfaceSummary, privateDeclsIgnored) {
+    const auto iface = summary(R"META(
+        package test;
+
+        int hidden(int x) {return x + 1;}
+        struct Hidden {int x;}
+
+        public int visible(int x) {return hidden(x);}
+        public struct Visible {int x;}
+    )META"_fake_src);
+    EXPECT_EQ(iface.find("hidden"), std::string::npos) << iface;
+    EXPECT_EQ(iface.find("Hidden"), std::string::npos) << iface;
+    EXPECT_NE(iface.find("visible"), std::string::npos) << iface;
+    EXPECT_NE(iface.find("Visible"), std::string::npos) << iface;
+}
+
+TEST(InterfaceSummary, bodyChangesIgnored) {
+    const auto before = summary(R"META(
+        package test;
+
+        public int foo(int x) {return x + 1;}
+        public bool bar() {return true;}
+    )META"_fake_src);
+    const auto after = summary(R"META(
+        package test;
+
+        public bool bar() {return false;}
+        public int foo(int x) {
+            int y = x*2;
+            return y - x + 1;
+        }
+    )META"_fake_src);
+    EXPECT_EQ(before, after);
+}
+
+TEST(InterfaceSummary, signatureChangesDetected) {
+    const auto before = summary(R"META(
+        package test;
+
+        public int foo(int x = 5) {return x + 1;}
+    )META"_fake_src);
+    const auto otherDefault = summary(R"META(
+        package test;
+
+        public int foo(int x = 6) {return x + 1;}
+    )META"_fake_src);
+    const auto otherVisibility = summary(R"META(
+        package test;
+
+        export int foo(int x = 5) {return x + 1;}
+    )META"_fake_src);
+    const auto otherType = summary(R"META(
+        package test;
+
+        public auto foo(int x = 5) {return x > 1;}
+    )META"_fake_src);
+    EXPECT_NE(before, otherDefault);
+    EXPECT_NE(before, otherVisibility);
+    EXPECT_NE(before, otherType);
+}
+
+TEST(InterfaceSummary, structLayoutChangesDetected) {
+    const auto before = summary(R"META(
+        package test;
+
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src);
+    const auto otherDefault = summary(R"META(
+        package test;
+
+        public struct Foo {bool flag; int x = 6;}
+    )META"_fake_src);
+    const auto packed = summary(R"META(
+        package test;
+
+        @packed
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src);
+    const auto reordered = summary(R"META(
+        package test;
+
+        @reorder
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src);
+    const auto aligned = summary(R"META(
+        package test;
+
+        @align(16)
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src);
+    EXPECT_NE(before, otherDefault);
+    EXPECT_NE(before, packed);
+    EXPECT_NE(before, reordered);
+    EXPECT_NE(before, aligned);
+    EXPECT_NE(before, summary(R"META(
+        package test;
+
+        @soa
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src));
+    EXPECT_NE(aligned, summary(R"META(
+        package test;
+
+        @align(32)
+        public struct Foo {bool flag; int x = 5;}
+    )META"_fake_src));
+}
+
+} // anonymous namespace
+} // namespace meta::cache::tests::interface
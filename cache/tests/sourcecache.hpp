@@ -0,0 +1,50 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "utils/io.h"
+#include "utils/types.h"
+
+#include "cache/sourcecache.h"
+
+namespace meta::cache::tests::sourcecache {
+namespace {
+
+TEST(SourceCache, rereadOnlyModified) {
+    const auto path = utils::fs::temp_directory_path()/("meta-source-test-" + std::to_string(::getpid()) + ".meta");
+    utils::open<utils::IO::out>(path, std::ios_base::out | std::ios_base::trunc) << "package foo;";
+
+    SourceCache cache;
+    const CachedSource* first = &cache.get(path);
+    EXPECT_EQ(first->file.content(), "package foo;");
+    EXPECT_EQ(&cache.get(path), first);
+    const std::string oldHash = first->hash;
+
+    utils::open<utils::IO::out>(path, std::ios_base::out | std::ios_base::trunc) << "package foobar;";
+    const CachedSource& second = cache.get(path);
+    EXPECT_EQ(second.file.content(), "package foobar;");
+    EXPECT_NE(second.hash, oldHash);
+
+    utils::fs::remove(path);
+}
+
+} // anonymous namespace
+} // namespace meta::cache::tests::sourcecache
@@ -0,0 +1,3 @@
+#include "compilecache.hpp"
+#include "interface.hpp"
+#include "sourcecache.hpp"
@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include "utils/array_view.h"
 #include "utils/types.h"
 
 namespace meta {
@@ -25,10 +26,33 @@ class AST;
 
 namespace generators {
 
+/// Settings which change generated code but not the program semantics
+struct GeneratorOptions {
+    /// Emit debug information mapping generated code to the source lines
+    bool debugInfo = false;
+    /// Instrument generated code with execution counters
+    bool profileGenerate = false;
+    /// Use execution counters merged into the file to guide optimizations
+    utils::fs::path profileUse;
+    /// Emit ThinLTO module summaries and inline functions across packages when linking them
+    bool thinLTO = false;
+};
+
 class Generator {
 public:
     virtual ~Generator() = default;
+
+    const GeneratorOptions& options() const {return mOptions;}
+    void setOptions(const GeneratorOptions& val) {mOptions = val;}
+
     virtual void generate(AST* ast, const utils::fs::path& output) = 0;
+    /// Generate code for declarations of a single package only
+    virtual void generate(AST* ast, utils::string_view package, const utils::fs::path& output) = 0;
+    /// Combine outputs of per package generation into a single output
+    virtual void link(utils::array_view<utils::fs::path> inputs, const utils::fs::path& output) = 0;
+
+protected:
+    GeneratorOptions mOptions;
 };
 
 }} // namespace meta::generators
@@ -0,0 +1,86 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+
+#include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/IRBuilder.h>
+
+#include "utils/sourcefile.h"
+#include "utils/types.h"
+
+#include "generators/llvmgen/privateheadercheck.h"
+
+namespace meta {
+
+class Function;
+class Node;
+class VarDecl;
+
+namespace typesystem {
+
+class Aggregate;
+class Type;
+
+} // namespace typesystem
+
+namespace generators::llvmgen {
+
+/**
+ * Emits DWARF description of the generated functions and their variables and attaches source
+ * locations to the generated instructions so that debuggers and profilers can map machine code
+ * back to the meta sources.
+ */
+class DebugInfo {
+public:
+    explicit DebugInfo(llvm::Module& module);
+
+    /// Describes function definition. Locations set after this call are scoped by the function.
+    void startFunction(Function* node, llvm::Function* func);
+    /// Describes argument number argNo (starting from 1) passed by value
+    void declareArg(VarDecl* node, unsigned argNo, llvm::Value* val, llvm::BasicBlock* block);
+    /// Describes local variable stored in the alloca
+    void declareVar(VarDecl* node, llvm::Value* storage, llvm::BasicBlock* block);
+    /// Makes the node position location of all instructions created by the builder next
+    void setLocation(Node* node, llvm::IRBuilder<>& builder);
+
+    /// Must be called once all functions are generated
+    void finalize() {mBuilder.finalize();}
+
+private:
+    llvm::DIFile* file(const utils::SourceFile& src);
+    llvm::DIType* diType(typesystem::Type type);
+    llvm::DIType* diArray(typesystem::Type type);
+    llvm::DIType* diStruct(typesystem::Type type);
+    llvm::DebugLoc location(Node* node) const;
+
+    llvm::Module& mModule;
+    llvm::DIBuilder mBuilder;
+    llvm::DICompileUnit* mUnit = nullptr;
+    std::map<utils::fs::path, llvm::DIFile*> mFiles;
+    llvm::DISubprogram* mScope = nullptr;
+    llvm::DIFile* mScopeFile = nullptr;
+    llvm::DIType* mString = nullptr;
+    std::map<utils::string_view, llvm::DIType*> mArrays;
+    std::map<const typesystem::Aggregate*, llvm::DIType*> mStructs;
+};
+
+} // namespace generators::llvmgen
+} // namespace meta
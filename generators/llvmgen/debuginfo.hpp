@@ -0,0 +1,181 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cassert>
+#include <vector>
+
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Dwarf.h>
+
+#include "utils/contract.h"
+
+#include "parser/metanodes.h"
+
+#include "typesystem/type.h"
+
+#include "generators/llvmgen/debuginfo.h"
+
+namespace meta::generators::llvmgen {
+
+DebugInfo::DebugInfo(llvm::Module& module): mModule(module), mBuilder(module) {
+    module.addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+    module.addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+}
+
+llvm::DIFile* DebugInfo::file(const utils::SourceFile& src) {
+    auto& res = mFiles[src.path()];
+    if (res)
+        return res;
+    const std::string name = src.path().filename().string();
+    const std::string dir = src.path().parent_path().string();
+    // All sources of the module are described by the single compile unit named after the first one
+    if (!mUnit)
+        mUnit = mBuilder.createCompileUnit(llvm::dwarf::DW_LANG_C, name, dir, "meta", false, "", 0);
+    res = mBuilder.createFile(name, dir);
+    return res;
+}
+
+llvm::DIType* DebugInfo::diType(typesystem::Type type) {
+    switch (type.typeId()) {
+        case typesystem::Type::Int: return mBuilder.createBasicType("int", 32, 32, llvm::dwarf::DW_ATE_signed);
+        case typesystem::Type::Double: return mBuilder.createBasicType("double", 64, 64, llvm::dwarf::DW_ATE_float);
+        case typesystem::Type::Bool: return mBuilder.createBasicType("bool", 8, 8, llvm::dwarf::DW_ATE_boolean);
+        case typesystem::Type::String: break;
+        case typesystem::Type::Array: return diArray(type);
+        case typesystem::Type::Struct: return diStruct(type);
+
+        case typesystem::Type::Auto: assert(false); return nullptr;
+        case typesystem::Type::Void: return nullptr;
+    }
+    if (mString)
+        return mString;
+    // Layout must match Environment::string
+    const uint64_t ptrSize = mModule.getDataLayout().getPointerSizeInBits();
+    llvm::DIType* counter = mBuilder.createPointerType(
+        mBuilder.createBasicType("int", 32, 32, llvm::dwarf::DW_ATE_signed), ptrSize
+    );
+    llvm::DIType* data = mBuilder.createPointerType(
+        mBuilder.createBasicType("char", 8, 8, llvm::dwarf::DW_ATE_signed_char), ptrSize
+    );
+    llvm::DIType* size = mBuilder.createBasicType("int", 32, 32, llvm::dwarf::DW_ATE_signed);
+    llvm::Metadata* members[] = {
+        mBuilder.createMemberType(mUnit, "counter", nullptr, 0, ptrSize, ptrSize, 0, 0, counter),
+        mBuilder.createMemberType(mUnit, "data", nullptr, 0, ptrSize, ptrSize, ptrSize, 0, data),
+        mBuilder.createMemberType(mUnit, "size", nullptr, 0, 32, 32, 2*ptrSize, 0, size),
+    };
+    mString = mBuilder.createStructType(
+        mUnit, "string", nullptr, 0, 3*ptrSize, ptrSize, 0, nullptr, mBuilder.getOrCreateArray(members)
+    );
+    return mString;
+}
+
+llvm::DIType* DebugInfo::diArray(typesystem::Type type) {
+    auto& res = mArrays[type.name()];
+    if (res)
+        return res;
+    // Layout must match Environment::array
+    const uint64_t ptrSize = mModule.getDataLayout().getPointerSizeInBits();
+    llvm::DIType* controlBlock = mBuilder.createPointerType(nullptr, ptrSize);
+    // Columns of @soa struct elements have no C type to point to
+    const bool soa = type.element().typeId() == typesystem::Type::Struct && type.aggregate()->soa();
+    llvm::DIType* data = mBuilder.createPointerType(soa ? nullptr : diType(type.element()), ptrSize);
+    llvm::DIType* count = mBuilder.createBasicType("int", 32, 32, llvm::dwarf::DW_ATE_unsigned);
+    llvm::Metadata* members[] = {
+        mBuilder.createMemberType(mUnit, "cb", nullptr, 0, ptrSize, ptrSize, 0, 0, controlBlock),
+        mBuilder.createMemberType(mUnit, "data", nullptr, 0, ptrSize, ptrSize, ptrSize, 0, data),
+        mBuilder.createMemberType(mUnit, "length", nullptr, 0, 32, 32, 2*ptrSize, 0, count),
+    };
+    const utils::string_view name = type.name();
+    res = mBuilder.createStructType(
+        mUnit, llvm::StringRef(name.data(), name.size()), nullptr, 0, 3*ptrSize, ptrSize, 0, nullptr, mBuilder.getOrCreateArray(members)
+    );
+    return res;
+}
+
+llvm::DIType* DebugInfo::diStruct(typesystem::Type type) {
+    auto& res = mStructs[type.aggregate()];
+    if (res)
+        return res;
+    // Offsets are taken from the layout LLVM struct type is built after
+    const auto layout = type.aggregate()->layout();
+    const auto& fields = type.aggregate()->fields();
+    std::vector<llvm::Metadata*> members;
+    for (size_t pos: layout.order) {
+        const utils::string_view name = fields[pos].name;
+        const typesystem::Type fieldType = fields[pos].type;
+        members.push_back(mBuilder.createMemberType(
+            mUnit, llvm::StringRef(name.data(), name.size()), nullptr, 0,
+            8*fieldType.size(), 8*fieldType.alignment(), 8*layout.offsets[pos], 0, diType(fieldType)
+        ));
+    }
+    const utils::string_view name = type.name();
+    res = mBuilder.createStructType(
+        mUnit, llvm::StringRef(name.data(), name.size()), nullptr, 0, 8*layout.size, 8*layout.alignment, 0, nullptr,
+        mBuilder.getOrCreateArray(members)
+    );
+    return res;
+}
+
+llvm::DebugLoc DebugInfo::location(Node* node) const {
+    PRECONDITION(mScope != nullptr);
+    return llvm::DebugLoc::get(node->tokens().linenum(), node->tokens().colnum(), mScope);
+}
+
+void DebugInfo::startFunction(Function* node, llvm::Function* func) {
+    POSTCONDITION(mScope != nullptr);
+    llvm::DIFile* srcFile = file(node->source());
+    std::vector<llvm::Metadata*> signature;
+    signature.push_back(diType(*node->type()));
+    for (auto arg: node->args())
+        signature.push_back(diType(*arg->type()));
+    const unsigned line = node->tokens().linenum();
+    mScope = mBuilder.createFunction(
+        srcFile, {node->name().data(), node->name().size()}, func->getName(), srcFile, line,
+        mBuilder.createSubroutineType(mBuilder.getOrCreateTypeArray(signature)),
+        func->hasLocalLinkage(), true, line
+    );
+    mScopeFile = srcFile;
+    func->setSubprogram(mScope);
+}
+
+void DebugInfo::declareArg(VarDecl* node, unsigned argNo, llvm::Value* val, llvm::BasicBlock* block) {
+    PRECONDITION(mScope != nullptr);
+    llvm::DILocalVariable* var = mBuilder.createParameterVariable(
+        mScope, {node->name().data(), node->name().size()}, argNo, mScopeFile, node->tokens().linenum(),
+        diType(*node->type())
+    );
+    mBuilder.insertDbgValueIntrinsic(val, 0, var, mBuilder.createExpression(), location(node), block);
+}
+
+void DebugInfo::declareVar(VarDecl* node, llvm::Value* storage, llvm::BasicBlock* block) {
+    PRECONDITION(mScope != nullptr);
+    llvm::DILocalVariable* var = mBuilder.createAutoVariable(
+        mScope, {node->name().data(), node->name().size()}, mScopeFile, node->tokens().linenum(),
+        diType(*node->type())
+    );
+    mBuilder.insertDeclare(storage, var, mBuilder.createExpression(), location(node), block);
+}
+
+void DebugInfo::setLocation(Node* node, llvm::IRBuilder<>& builder) {
+    builder.SetCurrentDebugLocation(location(node));
+}
+
+} // namespace meta::generators::llvmgen
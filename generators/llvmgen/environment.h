@@ -18,17 +18,23 @@
  */
 #pragma once
 
-#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <llvm/IR/IRBuilder.h>
 
 #include "utils/types.h"
 
+#include "generators/llvmgen/debuginfo.h"
 #include "generators/llvmgen/privateheadercheck.h"
+#include "generators/llvmgen/profile.h"
 
 namespace llvm {
 
+class Constant;
 class LLVMContext;
 class Module;
 class Type;
@@ -44,6 +50,7 @@ class VarDecl;
 
 namespace typesystem {
 
+class Aggregate;
 class Type;
 
 } // namespace typesystem
@@ -51,24 +58,94 @@ class Type;
 namespace generators {
 namespace llvmgen {
 
+/// LLVM representation of a struct type
+struct AggregateLayout {
+    llvm::StructType* type;
+    /// Element indexes of the fields in the declaration order. Elements placed in memory in different
+    /// order and padding elements inserted when the alignment is requested explicitly.
+    std::vector<unsigned> fields;
+};
+
 struct Environment {
     Environment(utils::string_view moduleName);
 
-    llvm::Function* addFunction(Function* func);
+    llvm::Function* addFunction(Function* func, const std::string& name);
+    /// Returns LLVM function for the declaration adding its prototype to the module on first use
+    llvm::Function* function(Function* func);
+    /// Returns constant string value shared by all the literals with the same content
+    llvm::Constant* stringLiteral(utils::string_view text);
     llvm::Type* getType(typesystem::Type type);
+    /// Returns LLVM struct type matching the layout of the struct described
+    const AggregateLayout& aggregate(const typesystem::Aggregate* desc);
+    /// Returns struct value with all the members set to their default values
+    llvm::Constant* defaultValue(const typesystem::Aggregate* desc);
 
     llvm::LLVMContext context;
     std::unique_ptr<llvm::Module> module;
     llvm::StructType* string;
+    /// Layout of the meta-rt struct Array: {control block, data, count}
+    llvm::StructType* array;
+    /// Layout of the meta-rt struct Region header kept on the stack of @region functions
+    llvm::StructType* region;
+    /// Struct types already added to the module
+    std::unordered_map<const typesystem::Aggregate*, AggregateLayout> aggregates;
+    /// Functions already added to the module. Symbol name is mangled only once per declaration.
+    std::unordered_map<Function*, llvm::Function*> functions;
+    /// String constants by literal text as written in the source. Literals spelled the same way
+    /// are unescaped only once.
+    std::unordered_map<utils::string_view, llvm::Constant*> literals;
+    /// String constants by unescaped content
+    std::unordered_map<std::string, llvm::Constant*> strings;
+    /// Set when generated code should be annotated with debug information
+    std::unique_ptr<DebugInfo> debugInfo;
+    /// Set when generated code is either instrumented or optimized with collected profile
+    std::unique_ptr<Profile> profile;
+    /// Package to generate code for or empty string if all packages are generated into a single module
+    utils::string_view package;
 };
 
 struct Context {
     Environment &env;
-    std::map<VarDecl*, llvm::Value*> varMap;
+    /// Values of arguments and local variables of the current function indexed by VarDecl::slot()
+    std::vector<llvm::Value*> vars;
     llvm::IRBuilder<> builder;
+    /// Block self tail calls of the current function jump to instead of calling it, null if there are
+    /// no such calls. Its phi nodes are the current function arguments values.
+    llvm::BasicBlock* tailRecursion = nullptr;
+    std::vector<llvm::PHINode*> tailRecursionArgs;
+    /// Storage owning arguments passed to the next iteration by self tail calls for the arguments of
+    /// refcounted types and null for others.
+    std::vector<llvm::AllocaInst*> tailRecursionOwned;
+    /// Refcounted values (arrays and strings) allocated or returned by calls during the current statement
+    /// evaluation. The statement owns a reference to each of them until its end unless some variable
+    /// takes it over.
+    std::vector<llvm::Value*> temporaries;
+    /// Storage of the current function local refcounted variables. It is zero initialized on function
+    /// entry and released on every function exit.
+    std::vector<llvm::AllocaInst*> ownedVars;
+    /// Header of the region arrays are allocated in by the current @region function or null
+    llvm::AllocaInst* region = nullptr;
+    /// Array variables of the current function which elements are written without copy on write check
+    std::set<VarDecl*> uniqueArrays;
 };
 
 llvm::AllocaInst* addLocalVar(llvm::Function* func, llvm::Type* type, utils::string_view name);
+/// Stores value into a new local variable to pass it to meta-rt by pointer
+llvm::Value* spill(Context& ctx, llvm::Value* val);
+/// Adds local variable of refcounted type to Context::ownedVars
+llvm::AllocaInst* addOwnedVar(Context& ctx, llvm::Type* type, utils::string_view name);
+
+/// Returns declaration of the meta-rt function adding it to the module on first use
+llvm::Constant* runtimeFunction(Environment& env, const char* name);
+/// Makes the caller owner of the refcounted value: takes it over from the statement temporaries or
+/// increments reference counter of a value borrowed from a variable
+void takeOwnership(Context& ctx, llvm::Value* val);
+/// Releases refcounted value stored in memory pointed by ptr
+void release(Context& ctx, llvm::Value* ptr);
+/// Releases all values owned by the current statement
+void releaseTemporaries(Context& ctx);
+/// Releases all values owned by the current function local variables and ends its region if any
+void releaseLocals(Context& ctx);
 
 } // namespace llvmgen
 } // namespace generators
@@ -18,12 +18,17 @@
  */
 #pragma once
 
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 
+#include <algorithm>
 #include <stdexcept>
 
+#include "utils/contract.h"
+
 #include "parser/metanodes.h"
 
 #include "typesystem/type.h"
@@ -40,11 +45,46 @@ Environment::Environment(utils::string_view moduleName):
         llvm::Type::getInt32PtrTy(context), // control block pointer used by meta-rt only
         llvm::Type::getInt8PtrTy(context), // content ptr
         llvm::Type::getInt32Ty(context), // size
+    nullptr)),
+    array(llvm::StructType::get(
+        llvm::Type::getInt8PtrTy(context), // control block pointer used by meta-rt only
+        llvm::Type::getInt8PtrTy(context), // elements ptr
+        llvm::Type::getInt32Ty(context), // count
+    nullptr)),
+    region(llvm::StructType::get(
+        llvm::Type::getInt8PtrTy(context), // outer region
+        llvm::Type::getInt8PtrTy(context), // chunks
+        llvm::Type::getInt8PtrTy(context), // next free byte
+        llvm::Type::getInt8PtrTy(context), // chunk end
     nullptr))
 {
 }
 
-llvm::Function *Environment::addFunction(Function *func) {
+namespace {
+
+void addAttributes(Function* func, llvm::Function* prototype) {
+    // Meta has no exceptions and C functions are called as they never unwind
+    prototype->addFnAttr(llvm::Attribute::NoUnwind);
+    // Aggregates are passed through memory after ABI lowering so functions having them in the
+    // signature access memory even if they are pure in terms of meta semantics.
+    bool memoryAbi = prototype->getReturnType()->isAggregateType();
+    for (const auto& arg: prototype->args())
+        memoryAbi = memoryAbi || arg.getType()->isAggregateType() || arg.getType()->isPointerTy();
+    if ((func->flags() & FuncFlags::pure) && !memoryAbi)
+        prototype->addFnAttr(llvm::Attribute::ReadNone);
+    if (func->flags() & FuncFlags::noRecurse)
+        prototype->addFnAttr(llvm::Attribute::NoRecurse);
+    if (func->flags() & FuncFlags::alwaysInline)
+        prototype->addFnAttr(llvm::Attribute::AlwaysInline);
+    if (func->flags() & FuncFlags::noInline)
+        prototype->addFnAttr(llvm::Attribute::NoInline);
+    if (func->flags() & FuncFlags::cold)
+        prototype->addFnAttr(llvm::Attribute::Cold);
+}
+
+} // anonymous namespace
+
+llvm::Function *Environment::addFunction(Function *func, const std::string& name) {
     const auto args = func->args();
     std::vector<llvm::Type *> argTypes;
     auto rettype = getType(*func->type());
@@ -61,11 +101,22 @@ llvm::Function *Environment::addFunction(Function *func) {
         (func->type()->properties() & typesystem::TypeProp::sret) ? llvm::Type::getVoidTy(context) : rettype,
         argTypes, false
     );
-    const llvm::GlobalValue::LinkageTypes linkType = func->visibility() == Visibility::Export || func->visibility() == Visibility::Extern ?
+    const bool abiVisible = func->visibility() == Visibility::Export || func->visibility() == Visibility::Extern;
+    // When packages are generated into separate modules functions visible from other packages are
+    // hidden until modules are linked together.
+    const bool packageVisible = !package.empty() && (
+        func->package() != package || func->visibility() != Visibility::Private
+    );
+    // Declarations loaded from module files are defined by the module bitcode
+    const bool compiledSeparately = !abiVisible && func->body() == nullptr;
+    const llvm::GlobalValue::LinkageTypes linkType = abiVisible || packageVisible || compiledSeparately ?
         llvm::GlobalValue::ExternalLinkage :
         llvm::GlobalValue::PrivateLinkage
     ;
-    llvm::Function *prototype = llvm::Function::Create(funcType, linkType, mangledName(func), module.get());
+    llvm::Function *prototype = llvm::Function::Create(funcType, linkType, name, module.get());
+    if (!abiVisible && (packageVisible || compiledSeparately))
+        prototype->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    addAttributes(func, prototype);
     llvm::Function::arg_iterator it = prototype->arg_begin();
     if (func->type()->properties() & typesystem::TypeProp::sret) {
         llvm::AttrBuilder attrBuilder;
@@ -82,6 +133,45 @@ llvm::Function *Environment::addFunction(Function *func) {
     return prototype;
 }
 
+llvm::Function* Environment::function(Function* func) {
+    POSTCONDITION(functions.count(func) == 1);
+    auto it = functions.find(func);
+    if (it != functions.end())
+        return it->second;
+    // Name is mangled only on the first use. Reuse the symbol if some other declaration
+    // with the same mangled name was already added.
+    const std::string name = mangledName(func);
+    llvm::Function* res = module->getFunction(name);
+    if (!res)
+        res = addFunction(func, name);
+    functions.emplace(func, res);
+    return res;
+}
+
+llvm::Constant* Environment::stringLiteral(utils::string_view text) {
+    auto& res = literals[text];
+    if (res)
+        return res;
+    std::string content = unescape(text);
+    auto& pooled = strings[content];
+    if (!pooled) {
+        llvm::Constant* data = llvm::ConstantDataArray::getString(context, content);
+        auto* global = new llvm::GlobalVariable(
+            *module, data->getType(), true, llvm::GlobalValue::PrivateLinkage, data, ".str"
+        );
+        global->setUnnamedAddr(true);
+        llvm::Constant* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
+        pooled = llvm::ConstantStruct::get(string,
+            llvm::ConstantPointerNull::get(llvm::Type::getInt32PtrTy(context)), // no refcounter
+            llvm::ConstantExpr::getInBoundsGetElementPtr(data->getType(), global, {zero, zero}), // data
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), content.size(), false), // size
+            nullptr
+        );
+    }
+    res = pooled;
+    return res;
+}
+
 llvm::Type* Environment::getType(typesystem::Type type) {
     // built in types:
     switch (type.typeId()) {
@@ -89,6 +179,8 @@ llvm::Type* Environment::getType(typesystem::Type type) {
         case typesystem::Type::Double: return llvm::Type::getDoubleTy(context);
         case typesystem::Type::Bool: return llvm::Type::getInt1Ty(context);
         case typesystem::Type::String: return string;
+        case typesystem::Type::Array: return array;
+        case typesystem::Type::Struct: return aggregate(type.aggregate()).type;
 
         case typesystem::Type::Auto: assert(false); break;
         case typesystem::Type::Void: return llvm::Type::getVoidTy(context);
@@ -96,9 +188,171 @@ llvm::Type* Environment::getType(typesystem::Type type) {
     return nullptr;
 }
 
+const AggregateLayout& Environment::aggregate(const typesystem::Aggregate* desc) {
+    auto it = aggregates.find(desc);
+    if (it != aggregates.end())
+        return it->second;
+    const typesystem::Aggregate::Layout layout = desc->layout();
+    const llvm::DataLayout& dataLayout = module->getDataLayout();
+    llvm::Type* byte = llvm::Type::getInt8Ty(context);
+    AggregateLayout res;
+    res.fields.resize(desc->fields().size());
+    std::vector<llvm::Type*> elements;
+    uint64_t offset = 0;
+    for (size_t pos: layout.order) {
+        llvm::Type* type = getType(desc->fields()[pos].type);
+        const uint64_t alignment = desc->packed() ? 1 : dataLayout.getABITypeAlignment(type);
+        const uint64_t natural = (offset + alignment - 1)/alignment*alignment;
+        // LLVM knows nothing about alignment requested for the nested structs
+        if (layout.offsets[pos] > natural)
+            elements.push_back(llvm::ArrayType::get(byte, layout.offsets[pos] - natural));
+        res.fields[pos] = elements.size();
+        elements.push_back(type);
+        offset = layout.offsets[pos] + dataLayout.getTypeAllocSize(type);
+    }
+    const uint64_t size = dataLayout.getTypeAllocSize(llvm::StructType::get(context, elements, desc->packed()));
+    if (layout.size > size)
+        elements.push_back(llvm::ArrayType::get(byte, layout.size - size));
+    // Struct declarations are the only aggregate types descriptions
+    auto strct = static_cast<const Struct*>(desc);
+    const std::string name = static_cast<std::string>(strct->package()) + "." + static_cast<std::string>(strct->name());
+    res.type = llvm::StructType::create(context, elements, name, desc->packed());
+    assert(dataLayout.getTypeAllocSize(res.type) == layout.size);
+    return aggregates.emplace(desc, std::move(res)).first->second;
+}
+
+namespace {
+
+/// Member default values are literals checked by the resolver
+llvm::Constant* memberDefault(Expression* init, llvm::Type* type) {
+    if (auto literal = dynamic_cast<Literal*>(init))
+        return literal->value() == Literal::trueVal ? llvm::ConstantInt::getTrue(type) : llvm::ConstantInt::getFalse(type);
+    if (auto op = dynamic_cast<PrefixOp*>(init)) {
+        const int val = static_cast<Number*>(op->operand())->value();
+        return llvm::ConstantInt::get(type, op->operation() == PrefixOp::negative ? -val : val, true);
+    }
+    return llvm::ConstantInt::get(type, static_cast<Number*>(init)->value(), true);
+}
+
+} // anonymous namespace
+
+llvm::Constant* Environment::defaultValue(const typesystem::Aggregate* desc) {
+    const AggregateLayout& layout = aggregate(desc);
+    std::vector<llvm::Constant*> values;
+    for (llvm::Type* type: layout.type->elements())
+        values.push_back(llvm::Constant::getNullValue(type));
+    auto strct = static_cast<const Struct*>(desc);
+    for (size_t pos = 0; pos < desc->fields().size(); ++pos) {
+        const typesystem::Type type = desc->fields()[pos].type;
+        llvm::Constant*& val = values[layout.fields[pos]];
+        if (type.typeId() == typesystem::Type::Struct)
+            val = defaultValue(type.aggregate());
+        else if (Expression* init = strct->members()[pos]->initExpr())
+            val = memberDefault(init, val->getType());
+    }
+    return llvm::ConstantStruct::get(layout.type, values);
+}
+
 llvm::AllocaInst* addLocalVar(llvm::Function* func, llvm::Type* type, utils::string_view name) {
     llvm::IRBuilder<> builder(&(func->getEntryBlock()), func->getEntryBlock().begin());
     return builder.CreateAlloca(type, 0, llvm::StringRef(name.data(), name.size()));
 }
 
+llvm::Constant* runtimeFunction(Environment& env, const char* name) {
+    llvm::Type* arrayPtr = env.array->getPointerTo();
+    llvm::Type* stringPtr = env.string->getPointerTo();
+    llvm::Type* regionPtr = env.region->getPointerTo();
+    llvm::Type* i32 = llvm::Type::getInt32Ty(env.context);
+    llvm::Type* boolean = llvm::Type::getInt1Ty(env.context);
+    llvm::Type* voidType = llvm::Type::getVoidTy(env.context);
+    llvm::FunctionType* type = nullptr;
+    // Comparisons and reductions only read the memory so the optimizer can reorder and drop them
+    bool readOnly = false;
+    const utils::string_view func = name;
+    if (func == "__meta_rt_array_malloc")
+        type = llvm::FunctionType::get(boolean, {i32, i32, arrayPtr}, false);
+    else if (func == "__meta_rt_string_array_malloc")
+        type = llvm::FunctionType::get(boolean, {i32, arrayPtr}, false);
+    else if (func == "__meta_rt_region_array_malloc")
+        type = llvm::FunctionType::get(boolean, {i32, i32, arrayPtr}, false);
+    else if (func == "__meta_rt_region_begin" || func == "__meta_rt_region_end")
+        type = llvm::FunctionType::get(voidType, {regionPtr}, false);
+    else if (func == "__meta_rt_array_unique")
+        type = llvm::FunctionType::get(boolean, {i32, arrayPtr}, false);
+    else if (func == "__meta_rt_array_release")
+        type = llvm::FunctionType::get(voidType, {arrayPtr}, false);
+    else if (func == "__meta_rt_array_attach")
+        type = llvm::FunctionType::get(voidType, {arrayPtr, arrayPtr}, false);
+    else if (func == "__meta_rt_string_concat")
+        type = llvm::FunctionType::get(boolean, {stringPtr, stringPtr, stringPtr}, false);
+    else if (func == "__meta_rt_string_release")
+        type = llvm::FunctionType::get(voidType, {stringPtr}, false);
+    else if (func == "__meta_rt_string_attach")
+        type = llvm::FunctionType::get(voidType, {stringPtr, stringPtr}, false);
+    else if (func == "__meta_rt_string_equal") {
+        type = llvm::FunctionType::get(boolean, {stringPtr, stringPtr}, false);
+        readOnly = true;
+    } else if (func == "__meta_rt_sum_i32" || func == "__meta_rt_min_i32" || func == "__meta_rt_max_i32") {
+        type = llvm::FunctionType::get(i32, {i32->getPointerTo(), i32}, false);
+        readOnly = true;
+    }
+    PRECONDITION(type != nullptr);
+    llvm::Constant* res = env.module->getOrInsertFunction(name, type);
+    if (auto* decl = llvm::dyn_cast<llvm::Function>(res)) {
+        decl->addFnAttr(llvm::Attribute::NoUnwind);
+        if (readOnly)
+            decl->addFnAttr(llvm::Attribute::ReadOnly);
+    }
+    return res;
+}
+
+llvm::Value* spill(Context& ctx, llvm::Value* val) {
+    llvm::AllocaInst* res = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), val->getType(), {});
+    ctx.builder.CreateStore(val, res);
+    return res;
+}
+
+llvm::AllocaInst* addOwnedVar(Context& ctx, llvm::Type* type, utils::string_view name) {
+    llvm::AllocaInst* res = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), type, name);
+    // Null control block owns nothing
+    llvm::IRBuilder<> entryBuilder(res->getParent(), ++llvm::BasicBlock::iterator(res));
+    entryBuilder.CreateStore(llvm::Constant::getNullValue(type), res);
+    ctx.ownedVars.push_back(res);
+    return res;
+}
+
+void takeOwnership(Context& ctx, llvm::Value* val) {
+    // Literals have no control block
+    if (llvm::isa<llvm::Constant>(val))
+        return;
+    auto it = std::find(ctx.temporaries.begin(), ctx.temporaries.end(), val);
+    if (it != ctx.temporaries.end()) {
+        ctx.temporaries.erase(it);
+        return;
+    }
+    llvm::Value* ptr = spill(ctx, val);
+    const char* attach = val->getType() == ctx.env.string ? "__meta_rt_string_attach" : "__meta_rt_array_attach";
+    ctx.builder.CreateCall(runtimeFunction(ctx.env, attach), {ptr, ptr});
+}
+
+void release(Context& ctx, llvm::Value* ptr) {
+    const bool string = ptr->getType()->getPointerElementType() == ctx.env.string;
+    ctx.builder.CreateCall(
+        runtimeFunction(ctx.env, string ? "__meta_rt_string_release" : "__meta_rt_array_release"), {ptr}
+    );
+}
+
+void releaseTemporaries(Context& ctx) {
+    for (llvm::Value* val: ctx.temporaries)
+        release(ctx, spill(ctx, val));
+    ctx.temporaries.clear();
+}
+
+void releaseLocals(Context& ctx) {
+    for (llvm::AllocaInst* var: ctx.ownedVars)
+        release(ctx, var);
+    if (ctx.region)
+        ctx.builder.CreateCall(runtimeFunction(ctx.env, "__meta_rt_region_end"), {ctx.region});
+}
+
 } // namespace meta::generators::llvmgen
@@ -51,6 +51,19 @@ struct ExpressionBuilder
     llvm::Value *operator() (Assigment *node, Context &ctx);
     llvm::Value *operator() (BinaryOp *node, Context &ctx);
     llvm::Value *operator() (PrefixOp *node, Context &ctx);
+
+    // Arrays and structs
+    llvm::Value *operator() (NewArray *node, Context &ctx);
+    llvm::Value *operator() (Index *node, Context &ctx);
+    llvm::Value *operator() (MemberAccess *node, Context &ctx);
+
+private:
+    llvm::Value *elementPtr(Index *node, llvm::Value *array, llvm::Value *index, Context &ctx);
+    /// Returns pointer to the struct member stored in a local variable or nullptr for members of other values
+    llvm::Value *memberPtr(MemberAccess *node, Context &ctx);
+    /// Returns LLVM struct element index of the struct member
+    unsigned memberIndex(MemberAccess *node, Context &ctx);
+    llvm::Value *stringOperation(BinaryOp *node, llvm::Value *left, llvm::Value *right, Context &ctx);
 };
 
 } // namespace llvmgen
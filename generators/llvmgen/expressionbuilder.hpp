@@ -17,26 +17,169 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 
 #include "utils/contract.h"
 
+#include "typesystem/type.h"
+
 #include "generators/llvmgen/environment.h"
 #include "generators/llvmgen/expressionbuilder.h"
-#include "generators/llvmgen/mangling.h"
 
 namespace meta {
 namespace generators {
 namespace llvmgen {
 
-llvm::Value* ExpressionBuilder::operator() (Call *node, Context &ctx) {
-    llvm::Function *func = ctx.env.module->getFunction(mangledName(node->function()));
-    if (!func) {
-        assert(node->function() != nullptr);
-        func = ctx.env.addFunction(node->function());
+namespace {
+
+/**
+ * Calls passing aggregates are rewritten by FixStructRet to pass pointers to the caller allocas so
+ * only calls with scalar arguments and result are marked. Tail call is guaranteed when caller and
+ * callee prototypes match and the return has nothing to release after the call, otherwise it's left
+ * to the code generator.
+ */
+llvm::CallInst::TailCallKind tailCallKind(llvm::Function* callee, Context& ctx) {
+    llvm::Function* caller = ctx.builder.GetInsertBlock()->getParent();
+    llvm::FunctionType* type = callee->getFunctionType();
+    if (type->getReturnType()->isAggregateType())
+        return llvm::CallInst::TCK_None;
+    for (llvm::Type* param: type->params()) {
+        if (param->isAggregateType())
+            return llvm::CallInst::TCK_None;
+    }
+    // musttail call must be immediately followed by the return
+    const bool releases = !ctx.temporaries.empty() || !ctx.ownedVars.empty() || ctx.region;
+    if (type == caller->getFunctionType() && !type->getReturnType()->isVoidTy() && !releases)
+        return llvm::CallInst::TCK_MustTail;
+    return llvm::CallInst::TCK_Tail;
+}
+
+/// Continues generation in the new block if cond is true or terminates the program otherwise
+void trapUnless(llvm::Value* cond, const char* name, Context &ctx) {
+    llvm::Function *func = ctx.builder.GetInsertBlock()->getParent();
+    auto contBB = llvm::BasicBlock::Create(ctx.env.context, name, func);
+    auto trapBB = llvm::BasicBlock::Create(ctx.env.context, "trap", func);
+    ctx.builder.CreateCondBr(cond, contBB, trapBB, llvm::MDBuilder(ctx.env.context).createBranchWeights(2000, 1));
+    ctx.builder.SetInsertPoint(trapBB);
+    ctx.builder.CreateCall(llvm::Intrinsic::getDeclaration(ctx.env.module.get(), llvm::Intrinsic::trap));
+    ctx.builder.CreateUnreachable();
+    ctx.builder.SetInsertPoint(contBB);
+}
+
+/// Elements of @soa struct arrays are stored column-wise, see typesystem::Aggregate::Columns
+bool soaArray(typesystem::Type array) {
+    return array.element().typeId() == typesystem::Type::Struct && array.aggregate()->soa();
+}
+
+/// Bytes taken by an array element in the memory block allocated by meta-rt
+llvm::Value* arrayElementSize(typesystem::Type array, Context &ctx) {
+    if (soaArray(array))
+        return ctx.builder.getInt32(array.aggregate()->columns().rowSize);
+    llvm::Type *elementType = ctx.env.getType(array.element());
+    return llvm::ConstantExpr::getTruncOrBitCast(llvm::ConstantExpr::getSizeOf(elementType), ctx.builder.getInt32Ty());
+}
+
+/// Copy on write: shared array is replaced with a copy owned by the variable before the write
+void makeUnique(VarDecl *decl, llvm::Value *storage, Context &ctx) {
+    if (ctx.uniqueArrays.count(decl) || (decl->flags() & VarFlags::stackArray))
+        return;
+    llvm::Value *unique = ctx.builder.CreateCall(
+        runtimeFunction(ctx.env, "__meta_rt_array_unique"), {arrayElementSize(*decl->type(), ctx), storage}
+    );
+    trapUnless(unique, "unique", ctx);
+}
+
+void checkBounds(Index *node, llvm::Value *array, llvm::Value *index, Context &ctx) {
+    if (!node->boundsChecked())
+        return;
+    // Negative index is greater than any count when compared as unsigned
+    llvm::Value *count = ctx.builder.CreateExtractValue(array, 2);
+    trapUnless(ctx.builder.CreateICmpULT(index, count), "inbounds", ctx);
+}
+
+/// Returns pointer to the field of the @soa array element placed in the column of the field
+llvm::Value* columnPtr(const typesystem::Aggregate *desc, size_t field, llvm::Value *array, llvm::Value *index, Context &ctx) {
+    llvm::Type *fieldType = ctx.env.getType(desc->fields()[field].type);
+    llvm::Type *i64 = ctx.builder.getInt64Ty();
+    // Column offset depends on the number of elements: the loops over single field keep it invariant
+    llvm::Value *count = ctx.builder.CreateZExt(ctx.builder.CreateExtractValue(array, 2), i64);
+    llvm::Value *offset = ctx.builder.CreateMul(count, llvm::ConstantInt::get(i64, desc->columns().starts[field]));
+    llvm::Value *column = ctx.builder.CreateInBoundsGEP(
+        ctx.builder.getInt8Ty(), ctx.builder.CreateExtractValue(array, 1), offset
+    );
+    column = ctx.builder.CreateBitCast(column, fieldType->getPointerTo());
+    return ctx.builder.CreateInBoundsGEP(fieldType, column, index);
+}
+
+/// Collects the struct value of the @soa array element from the columns
+llvm::Value* loadColumns(const typesystem::Aggregate *desc, llvm::Value *array, llvm::Value *index, Context &ctx) {
+    const AggregateLayout& layout = ctx.env.aggregate(desc);
+    llvm::Value *res = llvm::Constant::getNullValue(layout.type);
+    for (size_t pos = 0; pos < desc->fields().size(); ++pos) {
+        llvm::Value *field = ctx.builder.CreateLoad(columnPtr(desc, pos, array, index, ctx));
+        res = ctx.builder.CreateInsertValue(res, field, layout.fields[pos]);
     }
+    return res;
+}
+
+/// Spreads the struct value over the columns of the @soa array element
+void storeColumns(const typesystem::Aggregate *desc, llvm::Value *array, llvm::Value *index, llvm::Value *val, Context &ctx) {
+    const AggregateLayout& layout = ctx.env.aggregate(desc);
+    for (size_t pos = 0; pos < desc->fields().size(); ++pos) {
+        llvm::Value *field = ctx.builder.CreateExtractValue(val, layout.fields[pos]);
+        ctx.builder.CreateStore(field, columnPtr(desc, pos, array, index, ctx));
+    }
+}
+
+/// Sets the struct elements of the new array to the default value unless all its members are zero
+void fillDefaults(typesystem::Type type, llvm::Value *array, Context &ctx) {
+    const typesystem::Aggregate *desc = type.aggregate();
+    llvm::Constant *val = ctx.env.defaultValue(desc);
+    if (val->isNullValue())
+        return;
+    llvm::Function *func = ctx.builder.GetInsertBlock()->getParent();
+    llvm::BasicBlock *entryBB = ctx.builder.GetInsertBlock();
+    auto fillBB = llvm::BasicBlock::Create(ctx.env.context, "fill", func);
+    auto filledBB = llvm::BasicBlock::Create(ctx.env.context, "filled", func);
+    llvm::Value *count = ctx.builder.CreateExtractValue(array, 2);
+    ctx.builder.CreateCondBr(ctx.builder.CreateICmpSGT(count, ctx.builder.getInt32(0)), fillBB, filledBB);
+    ctx.builder.SetInsertPoint(fillBB);
+    llvm::PHINode *index = ctx.builder.CreatePHI(ctx.builder.getInt32Ty(), 2);
+    index->addIncoming(ctx.builder.getInt32(0), entryBB);
+    if (soaArray(type))
+        storeColumns(desc, array, index, val, ctx);
+    else {
+        llvm::Type *elementType = val->getType();
+        llvm::Value *data = ctx.builder.CreateBitCast(ctx.builder.CreateExtractValue(array, 1), elementType->getPointerTo());
+        ctx.builder.CreateStore(val, ctx.builder.CreateInBoundsGEP(elementType, data, index));
+    }
+    llvm::Value *next = ctx.builder.CreateAdd(index, ctx.builder.getInt32(1));
+    index->addIncoming(next, ctx.builder.GetInsertBlock());
+    ctx.builder.CreateCondBr(ctx.builder.CreateICmpSLT(next, count), fillBB, filledBB);
+    ctx.builder.SetInsertPoint(filledBB);
+}
+
+/// Position of the member in the struct declaration
+size_t memberPos(MemberAccess *node) {
+    const auto& members = node->targetStruct()->members();
+    const auto it = std::find_if(members.begin(), members.end(), [node](const auto& member) {
+        return member.get() == node->memberDecl();
+    });
+    PRECONDITION(it != members.end());
+    return static_cast<size_t>(it - members.begin());
+}
+
+} // anonymous namespace
+
+llvm::Value* ExpressionBuilder::operator() (Call *node, Context &ctx) {
+    assert(node->function() != nullptr);
+    llvm::Function *func = ctx.env.function(node->function());
     std::vector<llvm::Value*> args;
     llvm::Value* sret = nullptr;
     if (func->arg_begin()->hasStructRetAttr()) {
@@ -46,8 +189,17 @@ llvm::Value* ExpressionBuilder::operator() (Call *node, Context &ctx) {
     for (auto argNode: node->args())
         args.push_back(dispatch(*this, argNode, ctx));
     assert(func->arg_size() == args.size());
-    llvm::Value* callRes = ctx.builder.CreateCall(func, args);
-    return sret ? ctx.builder.CreateLoad(sret) : callRes;
+    // Arguments evaluation could move location to the nested calls
+    if (ctx.env.debugInfo)
+        ctx.env.debugInfo->setLocation(node, ctx.builder);
+    llvm::CallInst* callRes = ctx.builder.CreateCall(func, args);
+    if (node->tailCall() && !sret)
+        callRes->setTailCallKind(tailCallKind(func, ctx));
+    llvm::Value* res = sret ? ctx.builder.CreateLoad(sret) : callRes;
+    // Returned array or string reference is passed to the caller
+    if (node->function()->type()->properties() & typesystem::TypeProp::refcounted)
+        ctx.temporaries.push_back(res);
+    return res;
 }
 
 llvm::Value *ExpressionBuilder::operator() (Number *node, Context &ctx)
@@ -69,34 +221,79 @@ llvm::Value *ExpressionBuilder::operator() (Literal *node, Context &ctx)
 
 llvm::Value *ExpressionBuilder::operator() (StrLiteral *node, Context &ctx)
 {
-    return llvm::ConstantStruct::get(ctx.env.string,
-        llvm::ConstantPointerNull::get(llvm::Type::getInt32PtrTy(ctx.env.context)), // no refcounter
-        ctx.builder.CreateGlobalStringPtr(llvm::StringRef{node->value().data(), node->value().size()}), // data
-        llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx.env.context), node->value().size(), false), // size
-        nullptr
-    );
+    return ctx.env.stringLiteral(node->text());
 }
 
 llvm::Value *ExpressionBuilder::operator() (Var *node, Context &ctx)
 {
     PRECONDITION(node->declaration());
     // Use before initialization must be rejected by analysers before generation
-    PRECONDITION(ctx.varMap.count(node->declaration()) == 1);
-    auto it = ctx.varMap.find(node->declaration());
+    PRECONDITION(node->declaration()->slot() < ctx.vars.size());
+    PRECONDITION(ctx.vars[node->declaration()->slot()] != nullptr);
+    llvm::Value* val = ctx.vars[node->declaration()->slot()];
 
-    return (node->declaration()->flags() & VarFlags::argument) ? it->second : ctx.builder.CreateLoad(it->second);
+    // Arguments are kept in registers unless their elements are written
+    return llvm::isa<llvm::AllocaInst>(val) ? ctx.builder.CreateLoad(val) : val;
 }
 
 llvm::Value *ExpressionBuilder::operator() (Assigment *node, Context &ctx)
 {
+    if (auto element = dynamic_cast<Index*>(node->target())) {
+        // Typechecker allows to assign elements of arrays stored in variables only
+        auto var = dynamic_cast<Var*>(element->array());
+        PRECONDITION(var && var->declaration());
+        llvm::Value *index = dispatch(*this, element->index(), ctx);
+        llvm::Value *val = dispatch(*this, node->value(), ctx);
+        llvm::Value *storage = ctx.vars[var->declaration()->slot()];
+        PRECONDITION(llvm::isa<llvm::AllocaInst>(storage));
+        makeUnique(var->declaration(), storage, ctx);
+        llvm::Value *array = ctx.builder.CreateLoad(storage);
+        if (soaArray(*var->type())) {
+            checkBounds(element, array, index, ctx);
+            storeColumns(var->type()->aggregate(), array, index, val, ctx);
+            return val;
+        }
+        llvm::Value *ptr = elementPtr(element, array, index, ctx);
+        // String elements are owned by the array and released with it by meta-rt
+        if (node->type()->properties() & typesystem::TypeProp::refcounted) {
+            takeOwnership(ctx, val);
+            release(ctx, ptr);
+        }
+        ctx.builder.CreateStore(val, ptr);
+        return val;
+    }
+    if (auto member = dynamic_cast<MemberAccess*>(node->target())) {
+        // Resolver allows to assign members of the structs stored in local variables or array variables
+        // elements only
+        llvm::Value *val = dispatch(*this, node->value(), ctx);
+        Expression *aggregate = member->parent();
+        while (auto parent = dynamic_cast<MemberAccess*>(aggregate))
+            aggregate = parent->parent();
+        if (auto element = dynamic_cast<Index*>(aggregate)) {
+            auto var = dynamic_cast<Var*>(element->array());
+            PRECONDITION(var && var->declaration());
+            llvm::Value *storage = ctx.vars[var->declaration()->slot()];
+            PRECONDITION(llvm::isa<llvm::AllocaInst>(storage));
+            makeUnique(var->declaration(), storage, ctx);
+        }
+        llvm::Value *ptr = memberPtr(member, ctx);
+        PRECONDITION(ptr != nullptr);
+        ctx.builder.CreateStore(val, ptr);
+        return val;
+    }
     PRECONDITION(dynamic_cast<Var*>(node->target()));
     PRECONDITION(dynamic_cast<Var*>(node->target())->declaration());
     PRECONDITION(!(dynamic_cast<Var*>(node->target())->declaration()->flags() & VarFlags::argument));
-    PRECONDITION(ctx.varMap.count(dynamic_cast<Var*>(node->target())->declaration()) == 1);
-    /// @todo add struct members assigment support
-    auto it = ctx.varMap.find(dynamic_cast<Var*>(node->target())->declaration());
+    PRECONDITION(dynamic_cast<Var*>(node->target())->declaration()->slot() < ctx.vars.size());
+    PRECONDITION(ctx.vars[dynamic_cast<Var*>(node->target())->declaration()->slot()] != nullptr);
+    VarDecl *decl = dynamic_cast<Var*>(node->target())->declaration();
+    llvm::Value *target = ctx.vars[decl->slot()];
     llvm::Value *val = dispatch(*this, node->value(), ctx);
-    ctx.builder.CreateStore(val, it->second);
+    if ((node->type()->properties() & typesystem::TypeProp::refcounted) && !(decl->flags() & VarFlags::stackArray)) {
+        takeOwnership(ctx, val);
+        release(ctx, target);
+    }
+    ctx.builder.CreateStore(val, target);
     return val;
 }
 
@@ -104,6 +301,8 @@ llvm::Value *ExpressionBuilder::operator() (BinaryOp *node, Context &ctx)
 {
     llvm::Value *left = dispatch(*this, node->left(), ctx);
     llvm::Value *right = dispatch(*this, node->right(), ctx);
+    if (left->getType() == ctx.env.string)
+        return stringOperation(node, left, right, ctx);
     switch (node->operation()) {
         case BinaryOp::add: return ctx.builder.CreateAdd(left, right);
         case BinaryOp::sub: return ctx.builder.CreateSub(left, right);
@@ -125,6 +324,33 @@ llvm::Value *ExpressionBuilder::operator() (BinaryOp *node, Context &ctx)
     return nullptr;
 }
 
+llvm::Value *ExpressionBuilder::stringOperation(BinaryOp *node, llvm::Value *left, llvm::Value *right, Context &ctx)
+{
+    switch (node->operation()) {
+        case BinaryOp::add: {
+            llvm::Value *tmp = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), ctx.env.string, {});
+            llvm::Value *concatenated = ctx.builder.CreateCall(
+                runtimeFunction(ctx.env, "__meta_rt_string_concat"), {spill(ctx, left), spill(ctx, right), tmp}
+            );
+            trapUnless(concatenated, "concatenated", ctx);
+            llvm::Value *res = ctx.builder.CreateLoad(tmp);
+            ctx.temporaries.push_back(res);
+            return res;
+        }
+        case BinaryOp::equal:
+        case BinaryOp::noteq: {
+            llvm::Value *equal = ctx.builder.CreateCall(
+                runtimeFunction(ctx.env, "__meta_rt_string_equal"), {spill(ctx, left), spill(ctx, right)}
+            );
+            return node->operation() == BinaryOp::equal ? equal : ctx.builder.CreateNot(equal);
+        }
+        default: break;
+    }
+    // Other operations on strings must be rejected by analysers
+    assert(false);
+    return nullptr;
+}
+
 llvm::Value *ExpressionBuilder::operator() (PrefixOp *node, Context &ctx)
 {
     llvm::Value *val = dispatch(*this, node->operand(), ctx);
@@ -137,6 +363,143 @@ llvm::Value *ExpressionBuilder::operator() (PrefixOp *node, Context &ctx)
     return nullptr;
 }
 
+llvm::Value *ExpressionBuilder::operator() (NewArray *node, Context &ctx)
+{
+    llvm::Value *size = dispatch(*this, node->size(), ctx);
+    llvm::Type *elementType = ctx.env.getType(node->type()->element());
+    llvm::Type *i32 = llvm::Type::getInt32Ty(ctx.env.context);
+    llvm::Value *elementSize = arrayElementSize(*node->type(), ctx);
+    if (node->stackAllocated()) {
+        // Array which doesn't escape the function has no control block: attach and release are no-ops
+        // and copy on write treats it as unique
+        auto count = llvm::dyn_cast<llvm::ConstantInt>(size);
+        PRECONDITION(count != nullptr);
+        llvm::Type *storageType = llvm::ArrayType::get(elementType, count->getZExtValue());
+        llvm::Value *storage = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), storageType, {});
+        llvm::Value *data = ctx.builder.CreateBitCast(storage, ctx.builder.getInt8PtrTy());
+        // Elements are zeroed on each evaluation since the storage is reused by loops
+        ctx.builder.CreateMemSet(data, ctx.builder.getInt8(0), llvm::ConstantExpr::getSizeOf(storageType), 1);
+        llvm::Value *res = llvm::Constant::getNullValue(ctx.env.array);
+        res = ctx.builder.CreateInsertValue(res, data, 1);
+        return ctx.builder.CreateInsertValue(res, size, 2);
+    }
+    llvm::Value *tmp = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), ctx.env.array, {});
+    trapUnless(ctx.builder.CreateICmpSGE(size, llvm::ConstantInt::get(i32, 0)), "sizeok", ctx);
+    // String elements own references released with the array so such arrays are never region allocated
+    llvm::Value *allocated = nullptr;
+    if (node->type()->element() == typesystem::Type{typesystem::Type::String})
+        allocated = ctx.builder.CreateCall(runtimeFunction(ctx.env, "__meta_rt_string_array_malloc"), {size, tmp});
+    else {
+        const char *malloc = ctx.region ? "__meta_rt_region_array_malloc" : "__meta_rt_array_malloc";
+        allocated = ctx.builder.CreateCall(runtimeFunction(ctx.env, malloc), {elementSize, size, tmp});
+    }
+    trapUnless(allocated, "allocated", ctx);
+    ctx.builder.CreateStore(size, ctx.builder.CreateStructGEP(ctx.env.array, tmp, 2));
+    // Elements are default initialized with zeroes: 0, false, "" and so on
+    llvm::Value *data = ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(ctx.env.array, tmp, 1));
+    llvm::Type *i64 = llvm::Type::getInt64Ty(ctx.env.context);
+    llvm::Value *bytes = ctx.builder.CreateMul(ctx.builder.CreateZExt(size, i64), ctx.builder.CreateZExt(elementSize, i64));
+    ctx.builder.CreateMemSet(data, ctx.builder.getInt8(0), bytes, 1);
+    llvm::Value *res = ctx.builder.CreateLoad(tmp);
+    if (node->type()->element().typeId() == typesystem::Type::Struct)
+        fillDefaults(*node->type(), res, ctx);
+    ctx.temporaries.push_back(res);
+    return res;
+}
+
+llvm::Value *ExpressionBuilder::elementPtr(Index *node, llvm::Value *array, llvm::Value *index, Context &ctx)
+{
+    checkBounds(node, array, index, ctx);
+    llvm::Type *elementType = ctx.env.getType(node->type());
+    llvm::Value *data = ctx.builder.CreateBitCast(ctx.builder.CreateExtractValue(array, 1), elementType->getPointerTo());
+    return ctx.builder.CreateInBoundsGEP(elementType, data, index);
+}
+
+llvm::Value *ExpressionBuilder::operator() (Index *node, Context &ctx)
+{
+    llvm::Value *array = dispatch(*this, node->array(), ctx);
+    llvm::Value *index = dispatch(*this, node->index(), ctx);
+    if (soaArray(*node->array()->type())) {
+        checkBounds(node, array, index, ctx);
+        return loadColumns(node->array()->type()->aggregate(), array, index, ctx);
+    }
+    return ctx.builder.CreateLoad(elementPtr(node, array, index, ctx));
+}
+
+unsigned ExpressionBuilder::memberIndex(MemberAccess *node, Context &ctx)
+{
+    return ctx.env.aggregate(node->targetStruct()).fields[memberPos(node)];
+}
+
+llvm::Value *ExpressionBuilder::memberPtr(MemberAccess *node, Context &ctx)
+{
+    // Accessed members from the outermost struct to the node
+    std::vector<MemberAccess*> members;
+    Expression *aggregate = node;
+    while (auto member = dynamic_cast<MemberAccess*>(aggregate)) {
+        members.push_back(member);
+        aggregate = member->parent();
+    }
+    std::reverse(members.begin(), members.end());
+    auto nested = members.begin();
+    llvm::Value *ptr = nullptr;
+    if (auto element = dynamic_cast<Index*>(aggregate)) {
+        llvm::Value *array = dispatch(*this, element->array(), ctx);
+        llvm::Value *index = dispatch(*this, element->index(), ctx);
+        if (soaArray(*element->array()->type())) {
+            // Outermost member selects the column, members of the nested structs are inside of it
+            checkBounds(element, array, index, ctx);
+            ptr = columnPtr(element->array()->type()->aggregate(), memberPos(*nested), array, index, ctx);
+            ++nested;
+        } else
+            ptr = elementPtr(element, array, index, ctx);
+    } else if (auto var = dynamic_cast<Var*>(aggregate)) {
+        ptr = ctx.vars[var->declaration()->slot()];
+        // Arguments are kept in registers
+        if (!llvm::isa<llvm::AllocaInst>(ptr))
+            return nullptr;
+    } else
+        return nullptr;
+    if (nested == members.end())
+        return ptr;
+    std::vector<llvm::Value*> indexes = {ctx.builder.getInt32(0)};
+    for (; nested != members.end(); ++nested)
+        indexes.push_back(ctx.builder.getInt32(memberIndex(*nested, ctx)));
+    return ctx.builder.CreateInBoundsGEP(ptr, indexes);
+}
+
+llvm::Value *ExpressionBuilder::operator() (MemberAccess *node, Context &ctx)
+{
+    if (node->targetStruct()) {
+        // Members of variables are loaded alone, members of other values are extracted from them
+        if (llvm::Value *ptr = memberPtr(node, ctx))
+            return ctx.builder.CreateLoad(ptr);
+        llvm::Value *val = dispatch(*this, node->parent(), ctx);
+        return ctx.builder.CreateExtractValue(val, memberIndex(node, ctx));
+    }
+    // Array and string length and int array reductions are the only members of built in types
+    PRECONDITION(node->parent()->type()->properties() & typesystem::TypeProp::refcounted);
+    llvm::Value *val = dispatch(*this, node->parent(), ctx);
+    if (node->memberName() != "length") {
+        const char *reduction = nullptr;
+        if (node->memberName() == "sum")
+            reduction = "__meta_rt_sum_i32";
+        else if (node->memberName() == "min")
+            reduction = "__meta_rt_min_i32";
+        else if (node->memberName() == "max")
+            reduction = "__meta_rt_max_i32";
+        PRECONDITION(reduction != nullptr);
+        llvm::Type *i32 = llvm::Type::getInt32Ty(ctx.env.context);
+        llvm::Value *data = ctx.builder.CreateBitCast(ctx.builder.CreateExtractValue(val, 1), i32->getPointerTo());
+        return ctx.builder.CreateCall(runtimeFunction(ctx.env, reduction), {data, ctx.builder.CreateExtractValue(val, 2)});
+    }
+    llvm::Value *length = ctx.builder.CreateExtractValue(val, 2);
+    if (val->getType() != ctx.env.string)
+        return length;
+    // The highest bit of string size marks content stored inline by meta-rt
+    return ctx.builder.CreateAnd(length, ctx.builder.getInt32(0x7fffffff));
+}
+
 } // namespace llvmgen
 } // namespace generators
 } // namespace meta
@@ -18,21 +18,470 @@
  */
 #pragma once
 
-#include <llvm/Analysis/CallGraphSCCPass.h>
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/CallSite.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Pass.h>
+
+#include "generators/llvmgen/environment.h"
 #include "generators/llvmgen/fixstructretpass.h"
 
 namespace meta::generators::llvmgen {
 
 namespace {
 
-class FixStructRet: public llvm::CallGraphSCCPass {
+constexpr uint64_t eightbyte = 8;
+constexpr uint64_t maxRegisterAggregate = 2*eightbyte;
+
+enum class ArgClass {none, integer, sse, memory};
+
+struct Eightbyte {
+    ArgClass cls = ArgClass::none;
+    unsigned floats = 0;
+    bool used = false;
+};
+
+void classifyScalars(llvm::Type* type, uint64_t offset, const llvm::DataLayout& layout, std::vector<Eightbyte>& parts) {
+    if (auto strct = llvm::dyn_cast<llvm::StructType>(type)) {
+        const llvm::StructLayout* strctLayout = layout.getStructLayout(strct);
+        for (unsigned i = 0; i < strct->getNumElements(); ++i)
+            classifyScalars(strct->getElementType(i), offset + strctLayout->getElementOffset(i), layout, parts);
+        return;
+    }
+    if (auto arr = llvm::dyn_cast<llvm::ArrayType>(type)) {
+        // Byte arrays are padding of the structs with alignment requested explicitly, see
+        // Environment::aggregate. Padding doesn't affect the classification.
+        if (arr->getElementType()->isIntegerTy(8))
+            return;
+        const uint64_t elemSize = layout.getTypeAllocSize(arr->getElementType());
+        for (uint64_t i = 0; i < arr->getNumElements(); ++i)
+            classifyScalars(arr->getElementType(), offset + i*elemSize, layout, parts);
+        return;
+    }
+    const uint64_t size = layout.getTypeStoreSize(type);
+    for (uint64_t i = offset/eightbyte; i <= (offset + size - 1)/eightbyte; ++i)
+        parts[i].used = true;
+    auto& part = parts[offset/eightbyte];
+    // Unaligned fields of packed structs make the whole aggregate MEMORY class
+    if (offset % layout.getABITypeAlignment(type) != 0)
+        part.cls = ArgClass::memory;
+    else if (part.cls == ArgClass::memory)
+        return;
+    else if (!type->isFloatingPointTy())
+        part.cls = ArgClass::integer;
+    else if (part.cls != ArgClass::integer) {
+        part.cls = ArgClass::sse;
+        if (type->isFloatTy())
+            ++part.floats;
+    }
+}
+
+/**
+ * Returns type which should be used to pass aggregate in registers according to x86-64 SysV ABI
+ * or nullptr if the aggregate is passed in memory.
+ */
+llvm::Type* registerType(llvm::Type* type, const llvm::DataLayout& layout) {
+    const uint64_t size = layout.getTypeAllocSize(type);
+    if (size == 0 || size > maxRegisterAggregate)
+        return nullptr;
+    std::vector<Eightbyte> parts((size + eightbyte - 1)/eightbyte);
+    classifyScalars(type, 0, layout, parts);
+    if (std::any_of(parts.begin(), parts.end(), [](const Eightbyte& part) {return part.cls == ArgClass::memory;}))
+        return nullptr;
+    // Trailing eightbytes of padding are not passed
+    while (parts.size() > 1 && !parts.back().used)
+        parts.pop_back();
+
+    auto& ctx = type->getContext();
+    std::vector<llvm::Type*> regs;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const uint64_t partSize = std::min(eightbyte, size - i*eightbyte);
+        if (parts[i].cls != ArgClass::sse)
+            regs.push_back(llvm::Type::getIntNTy(ctx, 8*partSize));
+        else if (parts[i].floats == 0)
+            regs.push_back(llvm::Type::getDoubleTy(ctx));
+        else if (parts[i].floats == 1)
+            regs.push_back(llvm::Type::getFloatTy(ctx));
+        else
+            regs.push_back(llvm::VectorType::get(llvm::Type::getFloatTy(ctx), 2));
+    }
+    if (regs.size() == 1)
+        return regs.front();
+    return llvm::StructType::get(ctx, regs);
+}
+
+/// Reinterprets value through memory: the only way to change aggregate type without knowing its layout
+llvm::Value* reinterpret(llvm::Value* val, llvm::Type* type, llvm::Instruction* insertBefore) {
+    llvm::Function* func = insertBefore->getParent()->getParent();
+    const auto& layout = func->getParent()->getDataLayout();
+    llvm::Type* storage = layout.getTypeAllocSize(type) > layout.getTypeAllocSize(val->getType()) ?
+        type : val->getType();
+    llvm::AllocaInst* tmp = addLocalVar(func, storage, {});
+    auto storePtr = new llvm::BitCastInst(tmp, val->getType()->getPointerTo(), "", insertBefore);
+    new llvm::StoreInst(val, storePtr, insertBefore);
+    auto loadPtr = new llvm::BitCastInst(tmp, type->getPointerTo(), "", insertBefore);
+    return new llvm::LoadInst(loadPtr, "", insertBefore);
+}
+
+bool onlyDirectCalls(llvm::Function& func) {
+    for (llvm::Use& use: func.uses()) {
+        llvm::CallSite call(use.getUser());
+        if (!call || !call.isCallee(&use) || !llvm::isa<llvm::CallInst>(use.getUser()))
+            return false;
+    }
+    return true;
+}
+
+std::vector<llvm::CallInst*> calls(llvm::Function& func) {
+    std::vector<llvm::CallInst*> res;
+    for (llvm::User* user: func.users())
+        res.push_back(llvm::cast<llvm::CallInst>(user));
+    return res;
+}
+
+/// Moves body of the old function into the new one which replaces the old function in the module
+void replaceFunction(llvm::Function& oldFunc, llvm::Function* newFunc) {
+    newFunc->copyAttributesFrom(&oldFunc);
+    oldFunc.getParent()->getFunctionList().insert(oldFunc.getIterator(), newFunc);
+    newFunc->takeName(&oldFunc);
+    newFunc->setSubprogram(oldFunc.getSubprogram());
+    newFunc->getBasicBlockList().splice(newFunc->begin(), oldFunc.getBasicBlockList());
+}
+
+std::vector<llvm::ReturnInst*> returns(llvm::Function& func) {
+    std::vector<llvm::ReturnInst*> res;
+    for (auto& block: func) {
+        if (auto ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator()))
+            res.push_back(ret);
+    }
+    return res;
+}
+
+/**
+ * Functions which are not visible outside of the module are free to use any calling convention.
+ * Aggregates returned by them are returned directly: LLVM lowers such returns into registers
+ * while it is possible and falls back to the hidden pointer argument only for large aggregates.
+ * Call sites get the value without storing it into temporary and loading back.
+ *
+ * Exported functions returning small aggregates are turned into directly returning ones with
+ * their calling convention preserved before the C ABI lowering, see lowerCABI.
+ */
+llvm::Function* returnDirectly(llvm::Function& func, llvm::CallingConv::ID callingConv) {
+    llvm::Argument* sret = &*func.arg_begin();
+    llvm::Type* retType = sret->getType()->getPointerElementType();
+    std::vector<llvm::Type*> params;
+    for (auto it = std::next(func.arg_begin()); it != func.arg_end(); ++it)
+        params.push_back(it->getType());
+
+    llvm::AttributeSet oldAttrs = func.getAttributes();
+    llvm::AttributeSet attrs = oldAttrs.getFnAttributes();
+    for (unsigned i = 1; i < func.arg_size(); ++i) {
+        llvm::AttrBuilder paramAttrs(oldAttrs, i + 1);
+        if (paramAttrs.hasAttributes())
+            attrs = attrs.addAttributes(func.getContext(), i, llvm::AttributeSet::get(func.getContext(), i, paramAttrs));
+    }
+
+    llvm::Function* newFunc = llvm::Function::Create(
+        llvm::FunctionType::get(retType, params, false), func.getLinkage()
+    );
+    replaceFunction(func, newFunc);
+    newFunc->setAttributes(attrs);
+    newFunc->setCallingConv(callingConv);
+
+    if (!newFunc->isDeclaration()) {
+        auto newArg = newFunc->arg_begin();
+        for (auto it = std::next(func.arg_begin()); it != func.arg_end(); ++it, ++newArg) {
+            it->replaceAllUsesWith(&*newArg);
+            newArg->takeName(&*it);
+        }
+        llvm::AllocaInst* retSlot = nullptr;
+        for (llvm::ReturnInst* ret: returns(*newFunc)) {
+            llvm::Value* val = nullptr;
+            // Generator stores return value right before return
+            auto store = llvm::dyn_cast_or_null<llvm::StoreInst>(ret->getPrevNode());
+            if (store && store->getPointerOperand() == sret) {
+                val = store->getValueOperand();
+                store->eraseFromParent();
+            } else {
+                if (!retSlot)
+                    retSlot = addLocalVar(newFunc, retType, "retval");
+                val = new llvm::LoadInst(retSlot, "", ret);
+            }
+            llvm::ReturnInst::Create(func.getContext(), val, ret);
+            ret->eraseFromParent();
+        }
+        if (!sret->use_empty()) {
+            if (!retSlot)
+                retSlot = addLocalVar(newFunc, retType, "retval");
+            sret->replaceAllUsesWith(retSlot);
+        }
+    }
+
+    for (llvm::CallInst* call: calls(func)) {
+        std::vector<llvm::Value*> args;
+        for (unsigned i = 1; i < call->getNumArgOperands(); ++i)
+            args.push_back(call->getArgOperand(i));
+        auto newCall = llvm::CallInst::Create(newFunc, args, "", call);
+        newCall->setCallingConv(callingConv);
+        newCall->setDebugLoc(call->getDebugLoc());
+        llvm::Value* slot = call->getArgOperand(0);
+        call->eraseFromParent();
+        // Generator loads result from the temporary right after the call
+        auto tmp = llvm::dyn_cast<llvm::AllocaInst>(slot);
+        std::vector<llvm::LoadInst*> loads;
+        bool otherUses = false;
+        if (tmp) {
+            for (llvm::User* user: tmp->users()) {
+                auto load = llvm::dyn_cast<llvm::LoadInst>(user);
+                if (load && load->getParent() == newCall->getParent())
+                    loads.push_back(load);
+                else
+                    otherUses = true;
+            }
+        }
+        for (auto load: loads) {
+            bool afterCall = false;
+            for (llvm::Instruction* inst = newCall; inst && !afterCall; inst = inst->getNextNode())
+                afterCall = inst == load;
+            if (!afterCall) {
+                otherUses = true;
+                continue;
+            }
+            load->replaceAllUsesWith(newCall);
+            load->eraseFromParent();
+        }
+        if (!tmp || otherUses)
+            new llvm::StoreInst(newCall, slot, newCall->getNextNode());
+        else
+            tmp->eraseFromParent();
+    }
+    func.eraseFromParent();
+    return newFunc;
+}
+
+enum class PassKind {direct, coerced, memory};
+
+struct Lowering {
+    PassKind kind = PassKind::direct;
+    llvm::Type* type = nullptr;
+};
+
+Lowering lowering(llvm::Type* type, const llvm::DataLayout& layout) {
+    if (!type->isAggregateType())
+        return {PassKind::direct, type};
+    if (llvm::Type* reg = registerType(type, layout))
+        return {PassKind::coerced, reg};
+    return {PassKind::memory, type->getPointerTo()};
+}
+
+/// Generator returns all structs through sret argument while C returns small ones in registers
+bool returnsInRegisters(llvm::Function& func) {
+    if (func.arg_size() == 0 || !func.arg_begin()->hasStructRetAttr())
+        return false;
+    llvm::Type* type = func.arg_begin()->getType()->getPointerElementType();
+    return registerType(type, func.getParent()->getDataLayout()) != nullptr;
+}
+
+/// Registers left for passing arguments according to x86-64 SysV ABI
+struct FreeRegisters {
+    unsigned integer = 6;
+    unsigned sse = 8;
+};
+
+/// Number of registers required to pass value of the scalar or register aggregate type
+FreeRegisters requiredRegisters(llvm::Type* type) {
+    FreeRegisters res{0, 0};
+    const auto add = [&res](llvm::Type* part) {
+        if (part->isFloatingPointTy() || part->isVectorTy())
+            ++res.sse;
+        else
+            ++res.integer;
+    };
+    if (auto strct = llvm::dyn_cast<llvm::StructType>(type)) {
+        for (llvm::Type* elem: strct->elements())
+            add(elem);
+    } else
+        add(type);
+    return res;
+}
+
+/**
+ * Aggregate which doesn't fit into the registers left is passed on stack as a whole while scalars
+ * and smaller aggregates following it still could use the registers.
+ */
+Lowering argLowering(llvm::Type* type, const llvm::DataLayout& layout, FreeRegisters& regs) {
+    const Lowering res = lowering(type, layout);
+    if (res.kind == PassKind::memory)
+        return res;
+    const FreeRegisters required = requiredRegisters(res.type);
+    if (required.integer <= regs.integer && required.sse <= regs.sse) {
+        regs.integer -= required.integer;
+        regs.sse -= required.sse;
+        return res;
+    }
+    if (res.kind == PassKind::coerced)
+        return {PassKind::memory, type->getPointerTo()};
+    return res;
+}
+
+bool needsLowering(llvm::Function& func) {
+    if (func.getReturnType()->isAggregateType() || returnsInRegisters(func))
+        return true;
+    for (auto& arg: func.args()) {
+        if (arg.getType()->isAggregateType())
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Functions callable from C code pass and return aggregates according to x86-64 SysV ABI:
+ * aggregates up to 16 bytes are coerced to integer and SSE registers while there are enough of
+ * them left, other aggregates are passed on stack (byval) and returned through hidden pointer (sret).
+ */
+void lowerCABI(llvm::Function& func) {
+    auto& ctx = func.getContext();
+    const auto& layout = func.getParent()->getDataLayout();
+    const Lowering ret = lowering(func.getReturnType(), layout);
+    const unsigned shift = ret.kind == PassKind::memory ? 1 : 0;
+
+    FreeRegisters regs;
+    // Hidden pointer to the returned value takes the first integer register
+    if (ret.kind == PassKind::memory)
+        --regs.integer;
+
+    std::vector<Lowering> args;
+    std::vector<llvm::Type*> params;
+    llvm::AttributeSet oldAttrs = func.getAttributes();
+    llvm::AttributeSet attrs = oldAttrs.getFnAttributes();
+    if (ret.kind == PassKind::memory) {
+        params.push_back(ret.type);
+        llvm::AttrBuilder sretAttrs;
+        sretAttrs.addAttribute(llvm::Attribute::StructRet).addAttribute(llvm::Attribute::NoAlias);
+        attrs = attrs.addAttributes(ctx, 1, llvm::AttributeSet::get(ctx, 1, sretAttrs));
+    } else if (ret.kind == PassKind::direct) {
+        attrs = attrs.addAttributes(ctx, llvm::AttributeSet::ReturnIndex, oldAttrs.getRetAttributes());
+    }
+    for (auto& arg: func.args()) {
+        args.push_back(argLowering(arg.getType(), layout, regs));
+        params.push_back(args.back().type);
+        const unsigned idx = params.size();
+        llvm::AttrBuilder paramAttrs;
+        if (args.back().kind == PassKind::direct)
+            paramAttrs = llvm::AttrBuilder(oldAttrs, idx - shift);
+        else if (args.back().kind == PassKind::memory)
+            paramAttrs.addAttribute(llvm::Attribute::ByVal).addAlignmentAttr(layout.getABITypeAlignment(arg.getType()));
+        if (paramAttrs.hasAttributes())
+            attrs = attrs.addAttributes(ctx, idx, llvm::AttributeSet::get(ctx, idx, paramAttrs));
+    }
+
+    llvm::Function* newFunc = llvm::Function::Create(
+        llvm::FunctionType::get(
+            ret.kind == PassKind::memory ? llvm::Type::getVoidTy(ctx) : ret.type, params, false
+        ),
+        func.getLinkage()
+    );
+    replaceFunction(func, newFunc);
+    newFunc->setAttributes(attrs);
+
+    if (!newFunc->isDeclaration()) {
+        llvm::Instruction* entry = &*newFunc->getEntryBlock().getFirstInsertionPt();
+        auto newArg = newFunc->arg_begin();
+        if (ret.kind == PassKind::memory)
+            ++newArg;
+        size_t i = 0;
+        for (auto it = func.arg_begin(); it != func.arg_end(); ++it, ++newArg, ++i) {
+            newArg->takeName(&*it);
+            llvm::Value* val = &*newArg;
+            if (args[i].kind == PassKind::coerced)
+                val = reinterpret(val, it->getType(), entry);
+            else if (args[i].kind == PassKind::memory)
+                val = new llvm::LoadInst(val, "", entry);
+            it->replaceAllUsesWith(val);
+        }
+        if (ret.kind != PassKind::direct) {
+            for (llvm::ReturnInst* inst: returns(*newFunc)) {
+                llvm::Value* val = inst->getReturnValue();
+                if (ret.kind == PassKind::coerced)
+                    llvm::ReturnInst::Create(ctx, reinterpret(val, ret.type, inst), inst);
+                else {
+                    new llvm::StoreInst(val, &*newFunc->arg_begin(), inst);
+                    llvm::ReturnInst::Create(ctx, nullptr, inst);
+                }
+                inst->eraseFromParent();
+            }
+        }
+    }
+
+    for (llvm::CallInst* call: calls(func)) {
+        std::vector<llvm::Value*> callArgs;
+        llvm::AllocaInst* retSlot = nullptr;
+        llvm::Function* caller = call->getParent()->getParent();
+        if (ret.kind == PassKind::memory) {
+            retSlot = addLocalVar(caller, func.getReturnType(), {});
+            callArgs.push_back(retSlot);
+        }
+        for (unsigned i = 0; i < call->getNumArgOperands(); ++i) {
+            llvm::Value* val = call->getArgOperand(i);
+            if (args[i].kind == PassKind::coerced)
+                val = reinterpret(val, args[i].type, call);
+            else if (args[i].kind == PassKind::memory) {
+                llvm::AllocaInst* tmp = addLocalVar(caller, val->getType(), {});
+                new llvm::StoreInst(val, tmp, call);
+                val = tmp;
+            }
+            callArgs.push_back(val);
+        }
+        auto newCall = llvm::CallInst::Create(newFunc, callArgs, "", call);
+        newCall->setAttributes(attrs);
+        newCall->setCallingConv(call->getCallingConv());
+        newCall->setDebugLoc(call->getDebugLoc());
+        llvm::Value* res = newCall;
+        if (ret.kind == PassKind::coerced)
+            res = reinterpret(newCall, func.getReturnType(), call);
+        else if (ret.kind == PassKind::memory)
+            res = new llvm::LoadInst(retSlot, "", call);
+        if (!call->use_empty())
+            call->replaceAllUsesWith(res);
+        call->eraseFromParent();
+    }
+    func.eraseFromParent();
+}
+
+class FixStructRet: public llvm::ModulePass {
 public:
     static char ID;
-    FixStructRet(): llvm::CallGraphSCCPass(ID) {}
+    FixStructRet(): llvm::ModulePass(ID) {}
 
-    bool runOnSCC(llvm::CallGraphSCC& SCC) override {
-        return false;
+    bool runOnModule(llvm::Module& module) override {
+        std::vector<llvm::Function*> internal;
+        std::vector<llvm::Function*> external;
+        for (auto& func: module) {
+            if (func.hasLocalLinkage()) {
+                if (func.arg_size() > 0 && func.arg_begin()->hasStructRetAttr() && onlyDirectCalls(func))
+                    internal.push_back(&func);
+            } else if (
+                func.getVisibility() == llvm::GlobalValue::DefaultVisibility &&
+                needsLowering(func) && onlyDirectCalls(func)
+            )
+                external.push_back(&func);
+        }
+        for (auto func: internal)
+            returnDirectly(*func, llvm::CallingConv::Fast);
+        for (auto func: external) {
+            if (returnsInRegisters(*func))
+                func = returnDirectly(*func, func->getCallingConv());
+            lowerCABI(*func);
+        }
+        return !internal.empty() || !external.empty();
     }
 };
 
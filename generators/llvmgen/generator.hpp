@@ -3,6 +3,7 @@
 #include "parser/metanodes.h"
 
 #include "generators/llvmgen/generator.h"
+#include "generators/llvmgen/linker.h"
 #include "generators/llvmgen/modulebuilder.h"
 
 namespace meta {
@@ -14,9 +15,33 @@ class LlvmGen: public Generator
 public:
     void generate(AST* ast, const utils::fs::path& output) override {
         Environment env(output.filename().string()); /// @todo strip extension as well
+        setup(env);
         ModuleBuilder builder(env);
         ast->walk(&builder);
-        builder.save(output);
+        builder.save(output, mOptions);
+    }
+
+    void generate(AST* ast, utils::string_view package, const utils::fs::path& output) override {
+        Environment env(output.filename().string());
+        env.package = package;
+        setup(env);
+        ModuleBuilder builder(env);
+        ast->walk(&builder);
+        builder.save(output, mOptions);
+    }
+
+    void link(utils::array_view<utils::fs::path> inputs, const utils::fs::path& output) override {
+        linkModules(inputs, output, mOptions);
+    }
+
+private:
+    void setup(Environment& env) {
+        if (mOptions.debugInfo)
+            env.debugInfo = std::make_unique<DebugInfo>(*env.module);
+        if (mOptions.profileGenerate)
+            env.profile = std::make_unique<Profile>(*env.module);
+        else if (!mOptions.profileUse.empty())
+            env.profile = std::make_unique<Profile>(*env.module, mOptions.profileUse);
     }
 };
 
@@ -1,5 +1,10 @@
+#include "debuginfo.hpp"
 #include "environment.hpp"
 #include "expressionbuilder.hpp"
+#include "fixstructretpass.hpp"
 #include "generator.hpp"
+#include "linker.hpp"
 #include "mangling.hpp"
 #include "modulebuilder.hpp"
+#include "profile.hpp"
+#include "uniqueness.hpp"
@@ -0,0 +1,40 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "utils/array_view.h"
+#include "utils/types.h"
+
+#include "generators/generator.h"
+#include "generators/llvmgen/privateheadercheck.h"
+
+namespace meta::generators::llvmgen {
+
+/**
+ * Links modules generated for separate packages into single module. Functions hidden in the package
+ * modules are visible to meta code only and they are made private in the resulting module.
+ *
+ * With ThinLTO option enabled functions are inlined across package boundaries once modules are
+ * linked together.
+ */
+void linkModules(
+    utils::array_view<utils::fs::path> inputs, const utils::fs::path& output, const GeneratorOptions& opts
+);
+
+} // namespace meta::generators::llvmgen
@@ -0,0 +1,85 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <system_error>
+
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Transforms/IPO.h>
+
+#include "utils/exception.h"
+
+#include "generators/llvmgen/environment.h"
+#include "generators/llvmgen/linker.h"
+#include "generators/llvmgen/modulebuilder.h"
+
+namespace meta::generators::llvmgen {
+
+class LinkError: public utils::Exception {
+public:
+    LinkError(const utils::fs::path& input):
+        utils::Exception(utils::captureBacktrace()),
+        mMsg("Failed to link module " + input.string())
+    {}
+    const char* what() const noexcept override {return mMsg.c_str();}
+
+private:
+    std::string mMsg;
+};
+
+void linkModules(
+    utils::array_view<utils::fs::path> inputs, const utils::fs::path& output, const GeneratorOptions& opts
+) {
+    Environment env(output.filename().string());
+    llvm::Linker linker(*env.module);
+    for (const auto& input: inputs) {
+        auto buf = llvm::MemoryBuffer::getFile(input.string());
+        if (!buf)
+            throw std::system_error(buf.getError(), input.string());
+        auto module = llvm::parseBitcodeFile((*buf)->getMemBufferRef(), env.context);
+        if (!module)
+            throw std::system_error(module.getError(), input.string());
+        if (linker.linkInModule(std::move(*module)))
+            throw LinkError(input);
+    }
+    for (auto& func: *env.module) {
+        if (func.isDeclaration() || !func.hasHiddenVisibility())
+            continue;
+        func.setVisibility(llvm::GlobalValue::DefaultVisibility);
+        func.setLinkage(llvm::GlobalValue::PrivateLinkage);
+    }
+    if (opts.thinLTO) {
+        // Small exported helpers and package private functions get inlined into other packages
+        llvm::legacy::PassManager passMgr;
+        passMgr.add(llvm::createFunctionInliningPass());
+        passMgr.add(llvm::createGlobalDCEPass());
+        passMgr.run(*env.module);
+    }
+    // Profile counters are lowered in the package modules already
+    GeneratorOptions linkedOpts = opts;
+    linkedOpts.profileGenerate = false;
+    saveModule(*env.module, output.string(), linkedOpts);
+}
+
+} // namespace meta::generators::llvmgen
@@ -27,6 +27,7 @@
 #include "parser/metanodes.h"
 #include "parser/unexpectednode.h"
 
+#include "generators/generator.h"
 #include "generators/llvmgen/environment.h"
 #include "generators/llvmgen/privateheadercheck.h"
 
@@ -49,24 +50,33 @@ struct StatementBuilder {
     ExecStatus operator() (CodeBlock *node, Context &ctx);
     ExecStatus operator() (Return *node, Context &ctx);
     ExecStatus operator() (If *node, Context &ctx);
+    ExecStatus operator() (While *node, Context &ctx);
+    ExecStatus operator() (For *node, Context &ctx);
     ExecStatus operator() (ExprStatement *node, Context &ctx);
 
     ExecStatus operator() (VarDecl *node, Context &ctx); // TODO: think about proper way to handle declarations as statements.
+
+private:
+    ExecStatus loop(Node *node, Expression *cond, Node *body, Expression *step, Context &ctx);
 };
 
 class ModuleBuilder: public Visitor
 {
 public:
-    ModuleBuilder(Environment &env): mCtx(Context{env, std::map<VarDecl *, llvm::Value *>{}, llvm::IRBuilder<>{env.context}}) {}
+    ModuleBuilder(Environment &env): mCtx(Context{env, {}, llvm::IRBuilder<>{env.context}}) {}
 
+    bool visit(SourceFile *node) override;
     bool visit(Function *node) override;
 
-    void save(const std::string &path);
+    void save(const std::string &path, const GeneratorOptions& opts);
 
 private:
     Context mCtx;
 };
 
+/// Verifies module, fixes ABI, lowers profile counters if requested and writes its bitcode to the file
+void saveModule(llvm::Module &module, const std::string &path, const GeneratorOptions& opts);
+
 } // namespace llvmgen
 } // namespace generators
 } // namespace meta
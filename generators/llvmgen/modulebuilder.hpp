@@ -18,22 +18,24 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <system_error>
 #include <vector>
 
-#include <llvm/Analysis/CGSCCPassManager.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
-#include <llvm/IR/PassManager.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/Bitcode/ReaderWriter.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Transforms/Instrumentation.h>
 
 #include "utils/contract.h"
 
@@ -44,36 +46,122 @@
 #include "generators/llvmgen/expressionbuilder.h"
 #include "generators/llvmgen/modulebuilder.h"
 #include "generators/llvmgen/fixstructretpass.h"
-#include "generators/llvmgen/mangling.h"
+#include "generators/llvmgen/uniqueness.h"
 
 namespace meta::generators::llvmgen {
+namespace {
+
+bool hasSelfTailCalls(Function *node) {
+    const auto calls = node->getChildren<Call>(infinitDepth);
+    return std::any_of(calls.begin(), calls.end(), [node](Call *call) {
+        return call->tailCall() && call->function() == node;
+    });
+}
+
+} // anonymous namespace
+
+bool ModuleBuilder::visit(SourceFile *node) {
+    return mCtx.env.package.empty() || node->package() == mCtx.env.package;
+}
 
 bool ModuleBuilder::visit(Function *node) {
-    mCtx.varMap.clear();
-    llvm::Function *func = mCtx.env.module->getFunction(mangledName(node));
-    if (!func)
-        func = mCtx.env.addFunction(node);
+    llvm::Function *func = mCtx.env.function(node);
     if (node->visibility() == Visibility::Extern)
         return false;
 
+    // Reuses storage allocated for previous functions
+    mCtx.vars.assign(node->slotsCount(), nullptr);
+    llvm::BasicBlock *body = llvm::BasicBlock::Create(mCtx.env.context, "", func);
+    mCtx.builder.SetInsertPoint(body);
+    DebugInfo* debugInfo = mCtx.env.debugInfo.get();
+    if (debugInfo) {
+        debugInfo->startFunction(node, func);
+        debugInfo->setLocation(node, mCtx.builder);
+    }
+    if (mCtx.env.profile)
+        mCtx.env.profile->startFunction(node, func, mCtx.builder);
+
     llvm::Function::arg_iterator it = func->arg_begin();
     if (it->hasStructRetAttr())
         ++it;
+    unsigned argNo = 0;
     for (const auto arg : node->args()) {
-        mCtx.varMap[arg] = &(*it);
+        mCtx.vars[arg->slot()] = &(*it);
+        if (debugInfo)
+            debugInfo->declareArg(arg, ++argNo, &(*it), body);
         assert(it != func->arg_end());
         ++it;
     }
     assert(it == func->arg_end());
 
-    llvm::BasicBlock *body = llvm::BasicBlock::Create(mCtx.env.context, "", func);
-    mCtx.builder.SetInsertPoint(body);
+    mCtx.tailRecursion = nullptr;
+    mCtx.tailRecursionArgs.clear();
+    mCtx.tailRecursionOwned.clear();
+    mCtx.temporaries.clear();
+    mCtx.ownedVars.clear();
+    mCtx.region = nullptr;
+    mCtx.uniqueArrays = uniqueArrays(node);
+    if (node->flags() & FuncFlags::region) {
+        // Region is started once per call: iterations of eliminated tail recursion share it
+        mCtx.region = addLocalVar(func, mCtx.env.region, "region");
+        mCtx.builder.CreateCall(runtimeFunction(mCtx.env, "__meta_rt_region_begin"), {mCtx.region});
+    }
+    // Arrays borrowed from the caller are copied on first write. Arguments with written elements are
+    // moved to owned storage holding its own reference so the copy replaces the argument value.
+    const std::set<VarDecl*> writtenArgs = writtenArrayArgs(node);
+    std::vector<llvm::AllocaInst*> argsStorage;
+    for (const auto arg : node->args()) {
+        if (!writtenArgs.count(arg)) {
+            argsStorage.push_back(nullptr);
+            continue;
+        }
+        llvm::Value *val = mCtx.vars[arg->slot()];
+        llvm::AllocaInst *storage = addOwnedVar(mCtx, val->getType(), arg->name());
+        takeOwnership(mCtx, val);
+        mCtx.builder.CreateStore(val, storage);
+        argsStorage.push_back(storage);
+    }
+    if (hasSelfTailCalls(node)) {
+        // Tail recursion elimination: self tail calls pass new arguments values to the phi nodes and
+        // jump back to the function start instead of making a call.
+        mCtx.tailRecursion = llvm::BasicBlock::Create(mCtx.env.context, "tailrecurse", func);
+        mCtx.builder.CreateBr(mCtx.tailRecursion);
+        mCtx.builder.SetInsertPoint(mCtx.tailRecursion);
+        for (size_t pos = 0; pos < node->args().size(); ++pos) {
+            const auto arg = node->args()[pos];
+            llvm::Value *initial = mCtx.vars[arg->slot()];
+            llvm::PHINode *phi = mCtx.builder.CreatePHI(
+                initial->getType(), 2, llvm::StringRef(arg->name().data(), arg->name().size())
+            );
+            phi->addIncoming(initial, body);
+            mCtx.tailRecursionArgs.push_back(phi);
+            // Storage of argument with written elements owns the values passed to the next iterations
+            // as well so the array passed back to itself stays unique
+            if (argsStorage[pos]) {
+                mCtx.tailRecursionOwned.push_back(argsStorage[pos]);
+                continue;
+            }
+            mCtx.vars[arg->slot()] = phi;
+            // Arrays and strings passed to the next iteration are owned by the function until it exits
+            // or passes another value. Values passed by the caller are borrowed so the slot starts empty.
+            mCtx.tailRecursionOwned.push_back(
+                arg->type()->properties() & typesystem::TypeProp::refcounted ?
+                    addOwnedVar(mCtx, initial->getType(), arg->name()) : nullptr
+            );
+        }
+    }
+    for (size_t pos = 0; pos < argsStorage.size(); ++pos) {
+        if (argsStorage[pos])
+            mCtx.vars[node->args()[pos]->slot()] = argsStorage[pos];
+    }
+
     StatementBuilder statementBuilder;
     const ExecStatus status = statementBuilder(node->body(), mCtx);
     if (status == ExecStatus::stop) // Function body ends with terminating instruction
         return false;
     if (!(node->type()->properties() & typesystem::TypeProp::voidtype))
         throw analysers::SemanticError(node, "Non-void function ends without return");
+    releaseLocals(mCtx);
     mCtx.builder.CreateRetVoid(); // Void function with implicit return.
     return false;
 }
@@ -84,23 +172,80 @@ ExecStatus StatementBuilder::operator() (VarDecl *node, Context &ctx) {
     PRECONDITION(ctx.env.getType(*node->type()) != nullptr);
     auto type = ctx.env.getType(*node->type());
     // TODO: good point to check for multiple definitions
-    auto allocaVal = ctx.varMap[node] = addLocalVar(ctx.builder.GetInsertBlock()->getParent(), type, node->name());
-    if (!node->initExpr())
+    PRECONDITION(node->slot() < ctx.vars.size());
+    // Declaration executed again in a loop releases the value referenced on the previous iteration.
+    // Stack allocated arrays are not reference counted.
+    const bool refcounted = node->type()->properties() & typesystem::TypeProp::refcounted;
+    const bool owning = refcounted && !(node->flags() & VarFlags::stackArray);
+    auto allocaVal = owning ?
+        addOwnedVar(ctx, type, node->name()) :
+        addLocalVar(ctx.builder.GetInsertBlock()->getParent(), type, node->name());
+    const typesystem::Aggregate* aggregate = node->type()->aggregate();
+    // Alignment requested for a struct is unknown to LLVM
+    if (aggregate)
+        allocaVal->setAlignment(node->type()->alignment());
+    ctx.vars[node->slot()] = allocaVal;
+    if (ctx.env.debugInfo)
+        ctx.env.debugInfo->declareVar(node, allocaVal, ctx.builder.GetInsertBlock());
+    if (!node->initExpr()) {
+        if (owning)
+            release(ctx, allocaVal);
+        if (refcounted)
+            ctx.builder.CreateStore(llvm::Constant::getNullValue(type), allocaVal);
+        if (aggregate)
+            ctx.builder.CreateStore(ctx.env.defaultValue(aggregate), allocaVal);
         return ExecStatus::cont;
+    }
     ExpressionBuilder evaluator;
     llvm::Value *val = dispatch(evaluator, node->initExpr(), ctx);
+    if (owning) {
+        takeOwnership(ctx, val);
+        release(ctx, allocaVal);
+    }
     ctx.builder.CreateStore(val, allocaVal);
+    releaseTemporaries(ctx);
     return ExecStatus::cont;
 }
 
 ExecStatus StatementBuilder::operator() (Return *node, Context &ctx) {
     auto value = node->value();
     if (!value) {
+        releaseLocals(ctx);
         ctx.builder.CreateRetVoid();
         return ExecStatus::stop;
     }
+    auto call = dynamic_cast<Call*>(value);
+    if (ctx.tailRecursion && call && call->tailCall() && ctx.env.function(call->function()) == ctx.builder.GetInsertBlock()->getParent()) {
+        PRECONDITION(call->args().size() == ctx.tailRecursionArgs.size());
+        std::vector<llvm::Value*> args;
+        args.reserve(call->args().size());
+        for (auto arg: call->args())
+            args.push_back(dispatch(ExpressionBuilder{}, arg, ctx));
+        // New values are owned before the previous ones are released since they might share data
+        for (size_t pos = 0; pos < args.size(); ++pos) {
+            if (ctx.tailRecursionOwned[pos])
+                takeOwnership(ctx, args[pos]);
+        }
+        releaseTemporaries(ctx);
+        for (size_t pos = 0; pos < args.size(); ++pos) {
+            if (!ctx.tailRecursionOwned[pos])
+                continue;
+            release(ctx, ctx.tailRecursionOwned[pos]);
+            ctx.builder.CreateStore(args[pos], ctx.tailRecursionOwned[pos]);
+        }
+        for (size_t pos = 0; pos < args.size(); ++pos)
+            ctx.tailRecursionArgs[pos]->addIncoming(args[pos], ctx.builder.GetInsertBlock());
+        ctx.builder.CreateBr(ctx.tailRecursion);
+        return ExecStatus::stop;
+    }
     auto retval = dispatch(ExpressionBuilder{}, value, ctx);
     auto* typedNode = dynamic_cast<Typed*>(value);
+    // Returned array or string reference is passed to the caller, everything else owned by the function
+    // is released
+    if (typedNode->type()->properties() & typesystem::TypeProp::refcounted)
+        takeOwnership(ctx, retval);
+    releaseTemporaries(ctx);
+    releaseLocals(ctx);
     if (typedNode->type()->properties() & typesystem::TypeProp::sret) {
         llvm::Argument& sretArg = *ctx.builder.GetInsertBlock()->getParent()->arg_begin();
         assert(sretArg.hasStructRetAttr());
@@ -114,6 +259,7 @@ ExecStatus StatementBuilder::operator() (Return *node, Context &ctx) {
 ExecStatus StatementBuilder::operator() (If *node, Context &ctx) {
     ExpressionBuilder evaluator;
     llvm::Value *val = dispatch(evaluator, node->condition(), ctx);
+    releaseTemporaries(ctx);
     if (!node->thenBlock() && !node->elseBlock()) // "if (cond) ;" || "if (cond) ; else ;" no additional generation needed
         return ExecStatus::cont;
     llvm::Function *func = ctx.builder.GetInsertBlock()->getParent();
@@ -121,7 +267,9 @@ ExecStatus StatementBuilder::operator() (If *node, Context &ctx) {
     auto thenBB = node->thenBlock() ? llvm::BasicBlock::Create(ctx.env.context, "then") : mergeBB;
     auto elseBB = node->elseBlock() ? llvm::BasicBlock::Create(ctx.env.context, "else") : mergeBB;
 
-    ctx.builder.CreateCondBr(val, thenBB, elseBB);
+    llvm::BranchInst* branch = ctx.builder.CreateCondBr(val, thenBB, elseBB);
+    if (ctx.env.profile)
+        ctx.env.profile->countBranch(node, branch);
 
     if (node->thenBlock()) {
         func->getBasicBlockList().push_back(thenBB);
@@ -140,6 +288,61 @@ ExecStatus StatementBuilder::operator() (If *node, Context &ctx) {
     return ExecStatus::cont;
 }
 
+ExecStatus StatementBuilder::operator() (While *node, Context &ctx) {
+    return loop(node, node->condition(), node->body(), nullptr, ctx);
+}
+
+ExecStatus StatementBuilder::operator() (For *node, Context &ctx) {
+    if (ctx.env.debugInfo)
+        ctx.env.debugInfo->setLocation(node->init(), ctx.builder);
+    (*this)(node->init(), ctx);
+    return loop(node, node->condition(), node->body(), node->step(), ctx);
+}
+
+/**
+ * Loops are lowered to the canonical form expected by LLVM loop optimizations: the block the loop is
+ * entered from is the preheader with the header as its only successor, the header evaluates condition
+ * and is the only loop entry, the body ends with the single latch which evaluates step expression if
+ * any and jumps back to the header, the exit block is the only loop exit for loops without returns.
+ */
+ExecStatus StatementBuilder::loop(Node *node, Expression *cond, Node *body, Expression *step, Context &ctx) {
+    llvm::Function *func = ctx.builder.GetInsertBlock()->getParent();
+    auto headerBB = llvm::BasicBlock::Create(ctx.env.context, "loop");
+    auto bodyBB = llvm::BasicBlock::Create(ctx.env.context, "body");
+    auto exitBB = llvm::BasicBlock::Create(ctx.env.context, "endloop");
+    ctx.builder.CreateBr(headerBB);
+
+    func->getBasicBlockList().push_back(headerBB);
+    ctx.builder.SetInsertPoint(headerBB);
+    if (ctx.env.debugInfo)
+        ctx.env.debugInfo->setLocation(cond, ctx.builder);
+    llvm::Value *val = dispatch(ExpressionBuilder{}, cond, ctx);
+    releaseTemporaries(ctx);
+    llvm::BranchInst* branch = ctx.builder.CreateCondBr(val, bodyBB, exitBB);
+    if (ctx.env.profile)
+        ctx.env.profile->countLoop(node, branch);
+
+    func->getBasicBlockList().push_back(bodyBB);
+    ctx.builder.SetInsertPoint(bodyBB);
+    // Body which always returns leaves the loop without back edge
+    if (!body || dispatch(*this, body, ctx) != ExecStatus::stop) {
+        if (step) {
+            auto latchBB = llvm::BasicBlock::Create(ctx.env.context, "step", func);
+            ctx.builder.CreateBr(latchBB);
+            ctx.builder.SetInsertPoint(latchBB);
+            if (ctx.env.debugInfo)
+                ctx.env.debugInfo->setLocation(step, ctx.builder);
+            dispatch(ExpressionBuilder{}, step, ctx);
+            releaseTemporaries(ctx);
+        }
+        ctx.builder.CreateBr(headerBB);
+    }
+
+    func->getBasicBlockList().push_back(exitBB);
+    ctx.builder.SetInsertPoint(exitBB);
+    return ExecStatus::cont;
+}
+
 ExecStatus StatementBuilder::operator() (CodeBlock *block, Context &ctx) {
     ExecStatus lastStatus = ExecStatus::cont;
     Node *lastStatement = nullptr;
@@ -152,6 +355,8 @@ ExecStatus StatementBuilder::operator() (CodeBlock *block, Context &ctx) {
             );
 
         lastStatement = statement;
+        if (ctx.env.debugInfo)
+            ctx.env.debugInfo->setLocation(statement, ctx.builder);
         lastStatus = dispatch(*this, statement, ctx);
     }
     return lastStatus;
@@ -160,6 +365,7 @@ ExecStatus StatementBuilder::operator() (CodeBlock *block, Context &ctx) {
 ExecStatus StatementBuilder::operator() (ExprStatement *node, Context &ctx) {
     ExpressionBuilder evaluator;
     dispatch(evaluator, node->expression(), ctx);
+    releaseTemporaries(ctx);
     return ExecStatus::cont;
 }
 
@@ -176,20 +382,32 @@ private:
     std::string mMsg;
 };
 
-void ModuleBuilder::save(const std::string& path) {
+void ModuleBuilder::save(const std::string& path, const GeneratorOptions& opts) {
+    if (mCtx.env.debugInfo)
+        mCtx.env.debugInfo->finalize();
+    saveModule(*mCtx.env.module, path, opts);
+}
+
+void saveModule(llvm::Module& module, const std::string& path, const GeneratorOptions& opts) {
     // verify module IR correctness
     std::ostringstream oss;
     llvm::raw_os_ostream llvmOss(oss);
-    if (llvm::verifyModule(*mCtx.env.module, &llvmOss))
+    if (llvm::verifyModule(module, &llvmOss))
         throw IRVerificationError{oss.str()};
     // ABI fixup pases
-    // llvm::ModulePassManager passMgr;
-    // passMgr.addPass();
+    llvm::legacy::PassManager passMgr;
+    passMgr.add(createFixStructRetPass());
+    // Profile data refers to functions so counters are lowered once functions are final
+    if (opts.profileGenerate)
+        passMgr.add(llvm::createInstrProfilingPass());
+    passMgr.run(module);
+    if (llvm::verifyModule(module, &llvmOss))
+        throw IRVerificationError{oss.str()};
     // Write IR
-    llvm::ModulePassManager passMgr;
     std::error_code errCode;
     llvm::raw_fd_ostream out(path.c_str(), errCode, llvm::sys::fs::F_None);
-    llvm::WriteBitcodeToFile(mCtx.env.module.get(), out);
+    // Summaries let ThinLTO link decide what to import without loading whole modules
+    llvm::WriteBitcodeToFile(&module, out, false, opts.thinLTO);
     out.close();
     if (out.has_error())
         throw std::system_error(errCode);
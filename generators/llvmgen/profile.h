@@ -0,0 +1,88 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <llvm/IR/IRBuilder.h>
+
+#include "utils/types.h"
+
+#include "generators/llvmgen/privateheadercheck.h"
+
+namespace llvm {
+
+class IndexedInstrProfReader;
+
+} // namespace llvm
+
+namespace meta {
+
+class Function;
+class If;
+class Node;
+
+namespace generators::llvmgen {
+
+/**
+ * Source based execution counters. Each function has entry counter and each If statement has two
+ * counters: number of condition evaluations and number of times the branch with its own block
+ * (then block if exists and else block otherwise) was taken. Loops have the same pair of counters
+ * for their condition and body.
+ *
+ * Instrumented code increments counters which are written by LLVM profile runtime, merged data is
+ * used to annotate functions with entry counts and branches with weights.
+ */
+class Profile {
+public:
+    /// Instrument generated code with counters
+    explicit Profile(llvm::Module& module);
+    /// Use counters collected by previously instrumented code, throws std::system_error on failure
+    Profile(llvm::Module& module, const utils::fs::path& data);
+    ~Profile();
+
+    bool instrumenting() const {return !mReader;}
+
+    /// Must be called when builder is set to the function entry block
+    void startFunction(Function* node, llvm::Function* func, llvm::IRBuilder<>& builder);
+    /// Must be called before the branch successors are filled
+    void countBranch(If* node, llvm::BranchInst* branch);
+    /// Must be called before the loop body is filled, first branch successor is the loop body
+    void countLoop(Node* node, llvm::BranchInst* branch);
+
+private:
+    void count(llvm::BranchInst* branch, unsigned takenSuccessor);
+    void increment(llvm::IRBuilder<>& builder, uint32_t counter);
+
+    llvm::Module& mModule;
+    std::unique_ptr<llvm::IndexedInstrProfReader> mReader;
+
+    llvm::Function* mFunc = nullptr;
+    llvm::Constant* mFuncName = nullptr;
+    uint64_t mHash = 0;
+    uint32_t mCountersNum = 0;
+    uint32_t mNextCounter = 0;
+    /// Counters of the current function loaded from the profile data
+    std::vector<uint64_t> mCounts;
+};
+
+} // namespace generators::llvmgen
+} // namespace meta
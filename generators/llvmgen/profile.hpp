@@ -0,0 +1,123 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <system_error>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+
+#include "utils/contract.h"
+#include "utils/hash.h"
+
+#include "parser/metanodes.h"
+
+#include "generators/llvmgen/profile.h"
+
+namespace meta::generators::llvmgen {
+
+Profile::Profile(llvm::Module& module): mModule(module) {}
+
+Profile::Profile(llvm::Module& module, const utils::fs::path& data): mModule(module) {
+    auto reader = llvm::IndexedInstrProfReader::create(data.string());
+    if (!reader)
+        throw std::system_error(reader.getError());
+    mReader = std::move(reader.get());
+}
+
+Profile::~Profile() = default;
+
+void Profile::startFunction(Function* node, llvm::Function* func, llvm::IRBuilder<>& builder) {
+    mFunc = func;
+    const size_t branches =
+        node->getChildren<If>(infinitDepth).size() +
+        node->getChildren<While>(infinitDepth).size() +
+        node->getChildren<For>(infinitDepth).size()
+    ;
+    mCountersNum = 1 + 2*branches;
+    mNextCounter = 1;
+    // Function structure changes must invalidate collected counters
+    mHash = utils::Hasher{}.field("meta-pgo-1"sv).field(std::to_string(mCountersNum)).value();
+    const std::string name = llvm::getPGOFuncName(*func);
+    if (instrumenting()) {
+        mFuncName = llvm::ConstantExpr::getBitCast(
+            llvm::createPGOFuncNameVar(*func, name), llvm::Type::getInt8PtrTy(mModule.getContext())
+        );
+        increment(builder, 0);
+        return;
+    }
+    if (mReader->getFunctionCounts(name, mHash, mCounts) || mCounts.size() != mCountersNum)
+        mCounts.clear();
+    if (!mCounts.empty())
+        func->setEntryCount(mCounts[0]);
+}
+
+void Profile::countBranch(If* node, llvm::BranchInst* branch) {
+    count(branch, node->thenBlock() != nullptr ? 0 : 1);
+}
+
+void Profile::countLoop(Node*, llvm::BranchInst* branch) {
+    count(branch, 0);
+}
+
+void Profile::count(llvm::BranchInst* branch, unsigned takenSuccessor) {
+    PRECONDITION(branch->isConditional());
+    PRECONDITION(branch->getParent()->getParent() == mFunc);
+    PRECONDITION(mNextCounter + 1 < mCountersNum);
+    const uint32_t evaluated = mNextCounter++;
+    const uint32_t taken = mNextCounter++;
+    if (instrumenting()) {
+        llvm::IRBuilder<> builder(branch);
+        increment(builder, evaluated);
+        llvm::IRBuilder<> takenBuilder(branch->getSuccessor(takenSuccessor));
+        increment(takenBuilder, taken);
+        return;
+    }
+    if (mCounts.empty())
+        return;
+    const uint64_t takenCount = std::min(mCounts[taken], mCounts[evaluated]);
+    const uint64_t otherCount = mCounts[evaluated] - takenCount;
+    const uint64_t thenCount = takenSuccessor == 0 ? takenCount : otherCount;
+    const uint64_t elseCount = takenSuccessor == 0 ? otherCount : takenCount;
+    // Branch weights are 32 bit, large counts are scaled down preserving the ratio
+    const uint64_t scale = std::max(thenCount, elseCount)/std::numeric_limits<uint32_t>::max() + 1;
+    branch->setMetadata(
+        llvm::LLVMContext::MD_prof,
+        llvm::MDBuilder(mModule.getContext()).createBranchWeights(
+            static_cast<uint32_t>(thenCount/scale + 1), static_cast<uint32_t>(elseCount/scale + 1)
+        )
+    );
+}
+
+void Profile::increment(llvm::IRBuilder<>& builder, uint32_t counter) {
+    builder.CreateCall(llvm::Intrinsic::getDeclaration(&mModule, llvm::Intrinsic::instrprof_increment), {
+        mFuncName,
+        builder.getInt64(mHash),
+        builder.getInt32(mCountersNum),
+        builder.getInt32(counter)
+    });
+}
+
+} // namespace meta::generators::llvmgen
@@ -0,0 +1,100 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * Measures calls passing and returning strings through chains of meta functions and numeric loop
+ * kernels. Run with the number of iterations as the only optional argument.
+ */
+
+struct MString {
+    uint32_t* usecount;
+    const char* data;
+    uint32_t size;
+};
+
+extern "C" {
+
+// Functions from strings.meta
+MString test_strings_swapChain(int n, MString first, MString second);
+int test_strings_swapChainLength(int n, MString first, MString second);
+
+// Functions from loops.meta
+int test_loops_sumTo(int n);
+int test_loops_collatz(int n);
+int test_loops_sumSquaresNested(int n);
+
+int test_strings_length(MString str) {
+    return static_cast<int>(str.size);
+}
+
+}
+
+template<typename F>
+void measure(const char* name, int iterations, int depth, F&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        func(depth);
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::cout <<
+        name << " depth " << depth << ": " <<
+        static_cast<double>(ns)/iterations/depth << " ns per call" << std::endl
+    ;
+}
+
+template<typename F>
+void measureKernel(const char* name, int iterations, int size, F&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        func(size);
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::cout << name << " size " << size << ": " << static_cast<double>(ns)/iterations << " ns per call" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    if (iterations <= 0) {
+        std::cerr << "Ussage: " << argv[0] << " [ITERATIONS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const MString first{nullptr, "first", 5};
+    const MString second{nullptr, "second", 6};
+    volatile int sink = 0;
+    for (int depth: {1, 16, 256}) {
+        measure("swapChain", iterations, depth, [&](int n) {
+            sink = sink + test_strings_swapChain(n, first, second).size;
+        });
+        measure("swapChainLength", iterations, depth, [&](int n) {
+            sink = sink + test_strings_swapChainLength(n, first, second);
+        });
+    }
+    for (int size: {16, 256, 4096}) {
+        measureKernel("sumTo", iterations, size, [&](int n) {sink = sink + test_loops_sumTo(n);});
+        measureKernel("collatz", iterations, size, [&](int n) {sink = sink + test_loops_collatz(n);});
+    }
+    for (int size: {4, 16, 64})
+        measureKernel("sumSquaresNested", iterations, size, [&](int n) {sink = sink + test_loops_sumSquaresNested(n);});
+    return EXIT_SUCCESS;
+}
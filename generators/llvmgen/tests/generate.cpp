@@ -17,6 +17,9 @@
  *
  */
 
+#include <algorithm>
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include "utils/types.h"
@@ -29,6 +32,59 @@ struct MString {
     uint32_t size;
 };
 
+struct MArray {
+    void* cb;
+    void* data;
+    uint32_t count;
+};
+
+struct Point {
+    int x;
+    int y;
+};
+
+struct Box {
+    Point min;
+    Point max;
+    int weight;
+};
+
+struct Rect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+// Fields of @reorder struct are placed in the order of decreasing alignment
+struct Particle {
+    double mass;
+    int id;
+    bool alive;
+};
+static_assert(sizeof(Particle) == 16, "Reordered struct must have no padding between fields");
+
+struct __attribute__((packed)) Packed {
+    bool flag;
+    int value;
+};
+
+struct __attribute__((packed)) PackedMass {
+    bool flag;
+    double mass;
+};
+
+struct alignas(16) Aligned {
+    int value;
+};
+
+struct Body {
+    bool alive;
+    double mass;
+    Point pos;
+    int id;
+};
+
 // Functions from *.meta files
 extern "C" {
 
@@ -63,6 +119,87 @@ void test_ccall_setModifiedGlobal(int x);
 
 // Strings test
 MString test_strings_helloLength(bool cond, MString fallback);
+MString test_strings_swapChain(int n, MString first, MString second);
+int test_strings_swapChainLength(int n, MString first, MString second);
+MString test_strings_greeting();
+MString test_strings_sameGreeting(bool cond);
+MString test_strings_concat(MString lhs, MString rhs);
+int test_strings_concatLength(MString lhs, MString rhs);
+MString test_strings_repeat(int n, MString part);
+MString test_strings_repeatTail(int n, MString part);
+bool test_strings_same(MString lhs, MString rhs);
+bool test_strings_differs(MString lhs, MString rhs);
+int test_strings_totalLength(MString a, MString b, MString c, MString d, int extra);
+int test_strings_callJoinedLength(MString str, int extra);
+
+// Loops test
+int test_loops_sumTo(int n);
+int test_loops_factorial(int n);
+int test_loops_gcd(int a, int b);
+int test_loops_isqrt(int n);
+int test_loops_countDown(int n);
+int test_loops_collatz(int n);
+int test_loops_sumSquaresNested(int n);
+
+// Tail calls test
+int test_tailrec_count(int n, int acc);
+int test_tailrec_gcd(int a, int b);
+MString test_tailrec_pick(int n, MString first, MString second);
+bool test_tailrec_isEven(int n);
+int test_tailrec_pairSum(int a, int b);
+int test_tailrec_countInRegion(int n, int acc);
+
+// Arrays test
+MArray test_arrays_range(int n);
+int test_arrays_sum(MArray values);
+int test_arrays_rangeSum(int n);
+int test_arrays_at(MArray values, int pos);
+MArray test_arrays_keep(MArray values);
+int test_arrays_aliasing(int n);
+MArray test_arrays_withFirst(MArray values, int val);
+MArray test_arrays_fill(MArray values, int pos, int val);
+int test_arrays_reassign(int n);
+bool test_arrays_allFalse(int n);
+MString test_arrays_joined(int n, MString part);
+int test_arrays_squaresSum(int n);
+int test_arrays_stackSums(int n);
+int test_arrays_sumOf(MArray values);
+int test_arrays_minOf(MArray values);
+int test_arrays_maxOf(MArray values);
+
+// Structs test
+Point test_structs_makePoint(int x, int y);
+int test_structs_manhattan(Point p);
+Point test_structs_moved(Point p, int dx, int dy);
+Box test_structs_unitBox();
+Box test_structs_grow(Box box, int delta);
+int test_structs_area(Box box);
+Particle test_structs_particle(int id, double mass);
+Particle test_structs_defaultParticle();
+double test_structs_massOf(Particle p);
+Packed test_structs_pack(bool flag, int value);
+int test_structs_unpack(Packed p, int fallback);
+PackedMass test_structs_packMass(double mass);
+double test_structs_unpackMass(PackedMass p, double fallback);
+Aligned test_structs_aligned(int value);
+int test_structs_alignedSum(Aligned val, int other);
+MArray test_structs_bodies(int count);
+int test_structs_idsSum(MArray items);
+int test_structs_aliveCount(MArray items);
+int test_structs_defaultIdsSum(int count);
+MArray test_structs_shifted(MArray items, int dx);
+Body test_structs_bodyAt(MArray items, int pos);
+MArray test_structs_killed(MArray items, int pos);
+int test_structs_sumRects(int first, Rect a, Rect b, Rect c, int last);
+int test_structs_callRectsSum(int first, Rect r, int last);
+
+// meta-rt
+void __meta_rt_array_release(MArray* dest);
+uint32_t __meta_rt_array_usecount(MArray* dest);
+uint32_t __meta_rt_string_length(const MString* str);
+const char* __meta_rt_string_data(const MString* str);
+void __meta_rt_string_release(MString* str);
+uint32_t __meta_rt_string_usecount(const MString* str);
 
 }
 
@@ -81,7 +218,18 @@ void test_ccall_setGlobal(int x)
 }
 
 int test_strings_length(MString str) {
-    return static_cast<int>(str.size);
+    return static_cast<int>(__meta_rt_string_length(&str));
+}
+
+int test_strings_joinedLength(MString a, MString b, MString c, MString d, int extra) {
+    return static_cast<int>(
+        __meta_rt_string_length(&a) + __meta_rt_string_length(&b) + __meta_rt_string_length(&c) +
+        __meta_rt_string_length(&d)
+    ) + extra;
+}
+
+int test_structs_rectsSum(int first, Rect a, Rect b, Rect c, int last) {
+    return first + a.left + b.top + c.right + c.bottom + last;
 }
 
 }
@@ -210,6 +358,45 @@ int caller(int x)
 
 } // namespace ccall
 
+namespace loops {
+
+int sumTo(int n)
+{
+    int sum = 0;
+    for (int i = 1; i <= n; ++i)
+        sum += i;
+    return sum;
+}
+
+int factorial(int n)
+{
+    int res = 1;
+    for (int i = n; i > 1; --i)
+        res *= i;
+    return res;
+}
+
+int countDown(int n)
+{
+    int steps = 0;
+    int i = n;
+    while (--i >= 0)
+        ;
+    for (int j = 0; j < n; ++j)
+        ++steps;
+    return steps + i;
+}
+
+int collatz(int n)
+{
+    int steps = 0;
+    for (int x = n; x > 1; ++steps)
+        x = x%2 == 0 ? x/2 : 3*x + 1;
+    return steps;
+}
+
+} // namespace loops
+
 } // namespace local
 
 TEST(BuilderTests, constFunc)
@@ -286,10 +473,347 @@ TEST(BuilderTests, ccall)
     }
 }
 
-TEST(BuilderTest, DISABLED_strings) {
+TEST(BuilderTests, strings) {
     MString res = test_strings_helloLength(true, MString{nullptr, "qwe", 3});
     EXPECT_EQ(utils::string_view(res.data, res.size), utils::string_view("Hello"));
 
     res = test_strings_helloLength(false, MString{nullptr, "qwe", 3});
     EXPECT_EQ(utils::string_view(res.data, res.size), utils::string_view("qwe"));
 }
+
+TEST(BuilderTests, stringsManyArgs) {
+    const MString first{nullptr, "first", 5};
+    const MString second{nullptr, "second!", 7};
+    EXPECT_EQ(test_strings_totalLength(first, second, first, second, 100), 124);
+    EXPECT_EQ(test_strings_callJoinedLength(second, 100), 128);
+}
+
+TEST(BuilderTests, stringsCallChain) {
+    const MString first{nullptr, "first", 5};
+    const MString second{nullptr, "second!", 7};
+    for (int n = 0; n < 10; ++n) {
+        MString res = test_strings_swapChain(n, first, second);
+        EXPECT_EQ(res.data, n%2 == 0 ? first.data : second.data) << "n: " << n;
+        EXPECT_EQ(test_strings_swapChainLength(n, first, second), n%2 == 0 ? 5 : 7) << "n: " << n;
+    }
+}
+
+TEST(BuilderTests, stringLiteralsPooled) {
+    const MString greeting = test_strings_greeting();
+    EXPECT_EQ(utils::string_view(greeting.data, greeting.size), utils::string_view("Hello\tworld"));
+    const MString same = test_strings_sameGreeting(true);
+    EXPECT_EQ(same.data, greeting.data);
+    EXPECT_EQ(same.size, greeting.size);
+    // "Hello" from hello() and sameGreeting() share the same constant too
+    EXPECT_EQ(test_strings_sameGreeting(false).data, test_strings_helloLength(true, greeting).data);
+}
+
+std::string content(const MString& str) {
+    return {__meta_rt_string_data(&str), __meta_rt_string_length(&str)};
+}
+
+TEST(BuilderTests, stringsConcat) {
+    const MString hello{nullptr, "Hello, ", 7};
+    const MString world{nullptr, "world", 5};
+    MString res = test_strings_concat(hello, world);
+    EXPECT_EQ(content(res), "Hello, world");
+    // Short strings are stored inline
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 0u);
+    EXPECT_EQ(test_strings_concatLength(hello, world), 12);
+    __meta_rt_string_release(&res);
+
+    const MString longer{nullptr, "heap allocated world", 20};
+    res = test_strings_concat(hello, longer);
+    EXPECT_EQ(content(res), "Hello, heap allocated world");
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 1u);
+    EXPECT_EQ(test_strings_concatLength(hello, longer), 27);
+    // Intermediate results are passed to the extern function without copying
+    MString twice = test_strings_concat(res, res);
+    EXPECT_EQ(test_strings_length(twice), 54);
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 1u);
+    __meta_rt_string_release(&twice);
+    __meta_rt_string_release(&res);
+}
+
+TEST(BuilderTests, stringsRepeat) {
+    const MString part{nullptr, "ab", 2};
+    for (int n = 0; n < 50; ++n) {
+        std::string expected;
+        for (int i = 0; i < n; ++i)
+            expected += "ab";
+        MString res = test_strings_repeat(n, part);
+        EXPECT_EQ(content(res), expected) << "n: " << n;
+        EXPECT_EQ(__meta_rt_string_usecount(&res), 2*n > 15 ? 1u : 0u) << "n: " << n;
+        __meta_rt_string_release(&res);
+        // Accumulator passed to the next iteration of the eliminated tail call is owned by the function
+        res = test_strings_repeatTail(n, part);
+        EXPECT_EQ(content(res), expected) << "n: " << n;
+        EXPECT_EQ(__meta_rt_string_usecount(&res), 2*n > 15 ? 1u : 0u) << "n: " << n;
+        __meta_rt_string_release(&res);
+    }
+}
+
+TEST(BuilderTests, stringsEquality) {
+    const MString hello{nullptr, "Hello, heap allocated world", 27};
+    const MString prefix{nullptr, "Hello, ", 7};
+    const MString suffix{nullptr, "heap allocated world", 20};
+    MString concatenated = test_strings_concat(prefix, suffix);
+    EXPECT_TRUE(test_strings_same(hello, concatenated));
+    EXPECT_FALSE(test_strings_same(hello, prefix));
+    EXPECT_FALSE(test_strings_differs(concatenated, hello));
+    EXPECT_TRUE(test_strings_differs(prefix, suffix));
+    // Inline and literal representations of the same content are equal
+    MString inlined = test_strings_concat(prefix, MString{nullptr, "", 0});
+    EXPECT_TRUE(test_strings_same(inlined, prefix));
+    __meta_rt_string_release(&concatenated);
+}
+
+TEST(BuilderTests, loops) {
+    for (int n = -5; n < 50; ++n) {
+        EXPECT_EQ(test_loops_sumTo(n), local::loops::sumTo(n)) << "n: " << n;
+        EXPECT_EQ(test_loops_countDown(n), local::loops::countDown(n)) << "n: " << n;
+        EXPECT_EQ(test_loops_sumSquaresNested(n), local::loops::sumTo(n - 1)*local::loops::sumTo(n - 1)) << "n: " << n;
+    }
+    for (int n = 0; n < 12; ++n)
+        EXPECT_EQ(test_loops_factorial(n), local::loops::factorial(n)) << "n: " << n;
+    for (int n = 1; n < 100; ++n) {
+        EXPECT_EQ(test_loops_collatz(n), local::loops::collatz(n)) << "n: " << n;
+        const int root = test_loops_isqrt(n);
+        EXPECT_LE(root*root, n) << "n: " << n;
+        EXPECT_GT((root + 1)*(root + 1), n) << "n: " << n;
+    }
+    EXPECT_EQ(test_loops_isqrt(0), 0);
+    EXPECT_EQ(test_loops_gcd(12, 18), 6);
+    EXPECT_EQ(test_loops_gcd(17, 5), 1);
+    EXPECT_EQ(test_loops_gcd(7, 7), 7);
+}
+
+TEST(BuilderTests, tailRecursion) {
+    // Deep enough to overflow the stack if calls are not eliminated
+    const int depth = 10000000;
+    EXPECT_EQ(test_tailrec_count(depth, 5), depth + 5);
+    EXPECT_EQ(test_tailrec_gcd(depth, 2), 2);
+    const MString first{nullptr, "first", 5};
+    const MString second{nullptr, "second", 6};
+    EXPECT_EQ(test_tailrec_pick(depth, first, second).data, first.data);
+    EXPECT_EQ(test_tailrec_pick(depth + 1, first, second).data, second.data);
+    for (int n = 0; n < 50; ++n)
+        EXPECT_EQ(test_tailrec_isEven(n), n%2 == 0) << "n: " << n;
+    // Tail calls followed by the caller cleanup
+    EXPECT_EQ(test_tailrec_pairSum(3, 4), 7);
+    EXPECT_EQ(test_tailrec_countInRegion(5, 1), 6);
+}
+
+TEST(BuilderTests, arrays) {
+    for (int n = 0; n < 20; ++n) {
+        MArray values = test_arrays_range(n);
+        ASSERT_EQ(values.count, static_cast<uint32_t>(n)) << "n: " << n;
+        EXPECT_EQ(__meta_rt_array_usecount(&values), 1u) << "n: " << n;
+        for (int i = 0; i < n; ++i)
+            EXPECT_EQ(static_cast<int*>(values.data)[i], i) << "n: " << n;
+        // Arguments are borrowed by callee
+        EXPECT_EQ(test_arrays_sum(values), n*(n - 1)/2) << "n: " << n;
+        EXPECT_EQ(__meta_rt_array_usecount(&values), 1u) << "n: " << n;
+        EXPECT_EQ(test_arrays_rangeSum(n), n*(n - 1)/2) << "n: " << n;
+        EXPECT_EQ(test_arrays_reassign(n), n == 0 ? 0 : (n - 1)*(n - 2)/2) << "n: " << n;
+        EXPECT_TRUE(test_arrays_allFalse(n)) << "n: " << n;
+        __meta_rt_array_release(&values);
+    }
+}
+
+TEST(BuilderTests, arraysShared) {
+    // Write to a shared array copies it
+    EXPECT_EQ(test_arrays_aliasing(42), 0);
+    MArray values = test_arrays_range(5);
+    MArray copy = test_arrays_keep(values);
+    EXPECT_EQ(copy.data, values.data);
+    EXPECT_EQ(__meta_rt_array_usecount(&values), 2u);
+    __meta_rt_array_release(&copy);
+    EXPECT_EQ(__meta_rt_array_usecount(&values), 1u);
+    __meta_rt_array_release(&values);
+}
+
+TEST(BuilderTests, arraysCopyOnWrite) {
+    MArray values = test_arrays_range(5);
+    MArray changed = test_arrays_withFirst(values, 42);
+    EXPECT_NE(changed.data, values.data);
+    EXPECT_EQ(static_cast<int*>(changed.data)[0], 42);
+    EXPECT_EQ(static_cast<int*>(values.data)[0], 0);
+    EXPECT_EQ(__meta_rt_array_usecount(&values), 1u);
+    EXPECT_EQ(__meta_rt_array_usecount(&changed), 1u);
+    // Eliminated tail recursion keeps writing to the same copy
+    MArray filled = test_arrays_fill(values, 1, 7);
+    ASSERT_EQ(filled.count, 5u);
+    EXPECT_EQ(static_cast<int*>(filled.data)[0], 0);
+    for (int i = 1; i < 5; ++i) {
+        EXPECT_EQ(static_cast<int*>(filled.data)[i], 7) << "i: " << i;
+        EXPECT_EQ(static_cast<int*>(values.data)[i], i) << "i: " << i;
+    }
+    EXPECT_EQ(__meta_rt_array_usecount(&filled), 1u);
+    EXPECT_EQ(__meta_rt_array_usecount(&values), 1u);
+    __meta_rt_array_release(&filled);
+    __meta_rt_array_release(&changed);
+    __meta_rt_array_release(&values);
+}
+
+TEST(BuilderTests, stringArrays) {
+    const MString part{nullptr, "0123456789", 10};
+    for (int n = 0; n < 5; ++n) {
+        std::string expected;
+        for (int i = 0; i < 2*n; ++i)
+            expected += "0123456789";
+        // Elements concatenated in the loop are kept alive by the array
+        MString res = test_arrays_joined(n, part);
+        EXPECT_EQ(content(res), expected) << "n: " << n;
+        __meta_rt_string_release(&res);
+    }
+}
+
+TEST(BuilderTests, arrayReductions) {
+    for (int n = 1; n < 50; ++n) {
+        MArray values = test_arrays_range(n);
+        for (int i = 0; i < n; ++i)
+            static_cast<int*>(values.data)[i] = (i*37)%n - n/2;
+        int sum = 0;
+        int min = static_cast<int*>(values.data)[0];
+        int max = min;
+        for (int i = 0; i < n; ++i) {
+            sum += static_cast<int*>(values.data)[i];
+            min = std::min(min, static_cast<int*>(values.data)[i]);
+            max = std::max(max, static_cast<int*>(values.data)[i]);
+        }
+        EXPECT_EQ(test_arrays_sumOf(values), sum) << "n: " << n;
+        EXPECT_EQ(test_arrays_minOf(values), min) << "n: " << n;
+        EXPECT_EQ(test_arrays_maxOf(values), max) << "n: " << n;
+        __meta_rt_array_release(&values);
+    }
+}
+
+TEST(BuilderTests, stackArrays) {
+    for (int n = 0; n < 20; ++n)
+        EXPECT_EQ(test_arrays_stackSums(n), n*(n - 1)/2 + 4*n) << "n: " << n;
+}
+
+TEST(BuilderTests, regionArrays) {
+    for (int n = 0; n < 20; ++n) {
+        int expected = n*(n - 1)/2;
+        for (int i = 0; i < n; ++i)
+            expected += (i - 1)*i*(2*i - 1)/6;
+        EXPECT_EQ(test_arrays_squaresSum(n), expected) << "n: " << n;
+    }
+}
+
+TEST(BuilderTestsDeathTest, arrayOutOfBounds) {
+    MArray values = test_arrays_range(3);
+    EXPECT_EQ(test_arrays_at(values, 2), 2);
+    EXPECT_DEATH(test_arrays_at(values, 3), "");
+    EXPECT_DEATH(test_arrays_at(values, -1), "");
+    __meta_rt_array_release(&values);
+}
+
+TEST(BuilderTests, structs) {
+    const Point p = test_structs_makePoint(3, -4);
+    EXPECT_EQ(p.x, 3);
+    EXPECT_EQ(p.y, -4);
+    EXPECT_EQ(test_structs_manhattan(p), -1);
+    const Point moved = test_structs_moved(p, 2, 5);
+    EXPECT_EQ(moved.x, 5);
+    EXPECT_EQ(moved.y, 1);
+}
+
+TEST(BuilderTests, structsRegistersExhausted) {
+    const Rect a{0, 0, 1, 2};
+    const Rect b{0, 0, 10, 20};
+    const Rect c{0, 0, 100, 200};
+    EXPECT_EQ(test_structs_sumRects(1000, a, b, c, 10000), 11333);
+    EXPECT_EQ(test_structs_callRectsSum(1000, Rect{1, 2, 3, 4}, 10000), 11010);
+}
+
+TEST(BuilderTests, nestedStructs) {
+    // Box doesn't fit into two eightbytes so it's passed and returned through memory
+    const Box unit = test_structs_unitBox();
+    EXPECT_EQ(unit.min.x, 0);
+    EXPECT_EQ(unit.min.y, 0);
+    EXPECT_EQ(unit.max.x, 1);
+    EXPECT_EQ(unit.max.y, 1);
+    EXPECT_EQ(unit.weight, 1);
+    EXPECT_EQ(test_structs_area(unit), 1);
+
+    const Box grown = test_structs_grow(unit, 2);
+    EXPECT_EQ(grown.min.x, -2);
+    EXPECT_EQ(grown.min.y, -2);
+    EXPECT_EQ(grown.max.x, 3);
+    EXPECT_EQ(grown.max.y, 3);
+    EXPECT_EQ(grown.weight, 2);
+    EXPECT_EQ(test_structs_area(grown), 25);
+}
+
+TEST(BuilderTests, structsLayout) {
+    const Particle def = test_structs_defaultParticle();
+    EXPECT_TRUE(def.alive);
+    EXPECT_EQ(def.id, -1);
+    EXPECT_EQ(def.mass, 0.);
+    const Particle part = test_structs_particle(7, 2.5);
+    EXPECT_TRUE(part.alive);
+    EXPECT_EQ(part.id, 7);
+    EXPECT_EQ(part.mass, 2.5);
+    EXPECT_EQ(test_structs_massOf(part), 2.5);
+
+    static_assert(sizeof(Packed) == 5, "Packed struct must have no padding");
+    const Packed packed = test_structs_pack(true, 42);
+    // gtest takes arguments by reference which can't be bound to packed fields
+    const bool flag = packed.flag;
+    const int value = packed.value;
+    EXPECT_TRUE(flag);
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(test_structs_unpack(packed, 0), 42);
+    EXPECT_EQ(test_structs_unpack(test_structs_pack(false, 42), -1), -1);
+    static_assert(sizeof(PackedMass) == 9, "Packed struct must have no padding");
+    const double mass = test_structs_packMass(1.5).mass;
+    EXPECT_EQ(mass, 1.5);
+    EXPECT_EQ(test_structs_unpackMass(test_structs_packMass(1.5), 0.), 1.5);
+
+    static_assert(sizeof(Aligned) == 16 && alignof(Aligned) == 16, "Aligned struct must be padded");
+    EXPECT_EQ(test_structs_aligned(5).value, 5);
+    EXPECT_EQ(test_structs_alignedSum(test_structs_aligned(5), 3), 8);
+}
+
+TEST(BuilderTests, soaArrays) {
+    constexpr int count = 5;
+    MArray items = test_structs_bodies(count);
+    ASSERT_EQ(items.count, static_cast<uint32_t>(count));
+    // Columns follow each other in the order of decreasing alignment
+    const double* mass = static_cast<const double*>(items.data);
+    const Point* pos = reinterpret_cast<const Point*>(mass + count);
+    const int* ids = reinterpret_cast<const int*>(pos + count);
+    const bool* alive = reinterpret_cast<const bool*>(ids + count);
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(mass[i], 0.) << "i: " << i;
+        EXPECT_EQ(pos[i].x, i) << "i: " << i;
+        EXPECT_EQ(pos[i].y, 2*i) << "i: " << i;
+        EXPECT_EQ(ids[i], i) << "i: " << i;
+        EXPECT_TRUE(alive[i]) << "i: " << i;
+    }
+    EXPECT_EQ(test_structs_idsSum(items), count*(count - 1)/2);
+    EXPECT_EQ(test_structs_aliveCount(items), count);
+    EXPECT_EQ(test_structs_defaultIdsSum(count), -count);
+
+    // Arrays of structs are copied on write as any other arrays
+    MArray shifted = test_structs_shifted(items, 3);
+    EXPECT_EQ(pos[1].x, 1);
+    const Body body = test_structs_bodyAt(shifted, 1);
+    EXPECT_TRUE(body.alive);
+    EXPECT_EQ(body.mass, 0.);
+    EXPECT_EQ(body.pos.x, 4);
+    EXPECT_EQ(body.pos.y, 2);
+    EXPECT_EQ(body.id, 1);
+
+    MArray killed = test_structs_killed(shifted, 2);
+    EXPECT_EQ(test_structs_aliveCount(killed), count - 1);
+    EXPECT_EQ(test_structs_aliveCount(shifted), count);
+    EXPECT_EQ(test_structs_bodyAt(killed, 2).id, 2);
+
+    __meta_rt_array_release(&killed);
+    __meta_rt_array_release(&shifted);
+    __meta_rt_array_release(&items);
+}
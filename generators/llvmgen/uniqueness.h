@@ -0,0 +1,45 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <set>
+
+#include "generators/llvmgen/privateheadercheck.h"
+
+namespace meta {
+
+class Function;
+class VarDecl;
+
+namespace generators::llvmgen {
+
+/**
+ * Arrays have value semantics: element assignment copies the array first unless the variable holds
+ * the only reference to it. The checks below let the generator skip the runtime check where the
+ * reference is unique by construction.
+ */
+
+/// Local array variables which are assigned new arrays only and are used only as indexed arrays,
+/// member access parents or returned values so they never share their arrays with anything else
+std::set<VarDecl*> uniqueArrays(Function* func);
+/// Array arguments with elements assigned by the function body
+std::set<VarDecl*> writtenArrayArgs(Function* func);
+
+} // namespace generators::llvmgen
+} // namespace meta
@@ -0,0 +1,107 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+
+#include "parser/metanodes.h"
+#include "parser/metaparser.h"
+
+#include "typesystem/type.h"
+
+#include "generators/llvmgen/uniqueness.h"
+
+namespace meta::generators::llvmgen {
+namespace {
+
+VarDecl* arrayVar(Expression* expr) {
+    auto var = dynamic_cast<Var*>(expr);
+    if (!var || !var->declaration() || !var->declaration()->type())
+        return nullptr;
+    return var->declaration()->type()->typeId() == typesystem::Type::Array ? var->declaration() : nullptr;
+}
+
+} // anonymous namespace
+
+std::set<VarDecl*> uniqueArrays(Function* func) {
+    std::set<VarDecl*> candidates;
+    for (auto decl: func->body()->getChildren<VarDecl>(infinitDepth)) {
+        if ((decl->flags() & VarFlags::argument) || !decl->type())
+            continue;
+        if (decl->type()->typeId() != typesystem::Type::Array)
+            continue;
+        if (!decl->initExpr() || dynamic_cast<NewArray*>(decl->initExpr()))
+            candidates.insert(decl);
+    }
+    // Uses which don't copy the reference. Nodes don't know their parents so every such use is counted
+    // and compared with the total number of the variable uses.
+    std::map<VarDecl*, size_t> allowed;
+    for (auto node: func->body()->getChildren<Index>(infinitDepth)) {
+        if (auto decl = arrayVar(node->array()))
+            ++allowed[decl];
+    }
+    for (auto node: func->body()->getChildren<MemberAccess>(infinitDepth)) {
+        if (auto decl = arrayVar(node->parent()))
+            ++allowed[decl];
+    }
+    for (auto node: func->body()->getChildren<Return>(infinitDepth)) {
+        // Returned reference is passed to the caller when the variable is released
+        if (auto decl = arrayVar(node->value()))
+            ++allowed[decl];
+    }
+    for (auto node: func->body()->getChildren<Assigment>(infinitDepth)) {
+        auto decl = arrayVar(node->target());
+        if (!decl)
+            continue;
+        if (dynamic_cast<NewArray*>(node->value()))
+            ++allowed[decl];
+        else
+            candidates.erase(decl);
+    }
+    std::map<VarDecl*, size_t> total;
+    for (auto node: func->body()->getChildren<Var>(infinitDepth)) {
+        if (auto decl = arrayVar(node))
+            ++total[decl];
+    }
+    std::set<VarDecl*> res;
+    for (auto decl: candidates) {
+        if (total[decl] == allowed[decl])
+            res.insert(decl);
+    }
+    return res;
+}
+
+std::set<VarDecl*> writtenArrayArgs(Function* func) {
+    std::set<VarDecl*> res;
+    for (auto node: func->body()->getChildren<Assigment>(infinitDepth)) {
+        // Members of struct elements are written in place as well
+        Expression* target = node->target();
+        while (auto member = dynamic_cast<MemberAccess*>(target))
+            target = member->parent();
+        auto element = dynamic_cast<Index*>(target);
+        if (!element)
+            continue;
+        auto decl = arrayVar(element->array());
+        if (decl && (decl->flags() & VarFlags::argument))
+            res.insert(decl);
+    }
+    return res;
+}
+
+} // namespace meta::generators::llvmgen
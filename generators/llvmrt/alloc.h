@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * Memory allocator used by meta-rt for control block + data blocks. It is selected at link time:
+ * meta-rt library uses thread caching size class pools (poolalloc.c) while meta-rt-sysalloc forwards
+ * to the system malloc (sysalloc.c). Blocks must be freed with the same size they were allocated with.
+ */
+
+void* __meta_rt_mem_alloc(size_t size);
+void __meta_rt_mem_free(void* block, size_t size);
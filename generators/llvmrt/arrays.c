@@ -1,18 +1,11 @@
-#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
-#include <malloc.h>
+#include <string.h>
 
-typedef _Atomic(uint32_t) atomic_counter32;
-
-struct ArrayControlBlock {
-    volatile atomic_counter32 refcnt;
-    uint32_t max_elements;
-};
-_Static_assert(
-    sizeof(struct ArrayControlBlock) == 8,
-    "ArrayControlBlock must be 64bit long to preserve array data aligmnet"
-);
+#include "controlblock.h"
+#include "metastring.h"
+#include "region.h"
 
 struct Array {
     struct ArrayControlBlock* cb;
@@ -21,30 +14,38 @@ struct Array {
 };
 
 bool __meta_rt_array_malloc(uint32_t elem_sz, uint32_t elems_max, struct Array* dest) {
-    const size_t cbsz = sizeof(*(dest->cb));
-    // Requested block of memory too large (elem_sz*elems_cnt + cntsz > SIZE_MAX)
-    if ((SIZE_MAX - cbsz)/elems_max < elem_sz)
+    dest->cb = __meta_rt_cb_malloc(elem_sz, elems_max);
+    if (!dest->cb)
         return false;
+    dest->data = cb_data(dest->cb);
+    return true;
+}
 
-    const size_t sz = elem_sz*elems_max + cbsz;
-    void* block = malloc(sz);
-    if (!block)
+bool __meta_rt_string_array_malloc(uint32_t elems_max, struct Array* dest) {
+    if (!__meta_rt_array_malloc(sizeof(struct String), elems_max, dest))
         return false;
+    // Empty strings own nothing
+    memset(dest->data, 0, (size_t)elems_max*sizeof(struct String));
+    dest->cb->flags |= CB_STRING_ELEMENTS;
+    return true;
+}
 
-    dest->cb = (struct ArrayControlBlock*)block;
-    atomic_init(&dest->cb->refcnt, 1);
-    dest->data = (char*)(block) + cbsz;
-    dest->cb->max_elements = elems_max;
+bool __meta_rt_region_array_malloc(uint32_t elem_sz, uint32_t elems_max, struct Array* dest) {
+    // Outside of regions arrays are reference counted as usual
+    if (!__meta_rt_region_active())
+        return __meta_rt_array_malloc(elem_sz, elems_max, dest);
+    // Region arrays are reference counted as well so that copy on write knows when to copy them
+    dest->cb = __meta_rt_cb_region_malloc(elem_sz, elems_max);
+    if (!dest->cb)
+        return false;
+    dest->data = cb_data(dest->cb);
     return true;
 }
 
 void __meta_rt_array_release(struct Array* dest) {
     if (!dest->cb)
         return;
-    uint32_t count = atomic_fetch_sub_explicit(&dest->cb->refcnt, 1, memory_order_acq_rel);
-    if (count == 1)
-        return;
-    free(dest->cb);
+    cb_release(dest->cb);
 }
 
 void __meta_rt_array_attach(const struct Array* target, struct Array* dest) {
@@ -53,11 +54,36 @@ void __meta_rt_array_attach(const struct Array* target, struct Array* dest) {
     dest->count = target->count;
     if (!dest->cb)
         return;
-    atomic_fetch_and_explicit(&dest->cb->refcnt, 1, memory_order_relaxed);
+    rc_attach(&dest->cb->refcnt);
+}
+
+bool __meta_rt_array_unique(uint32_t elem_sz, struct Array* dest) {
+    if (!dest->cb || rc_unique(&dest->cb->refcnt))
+        return true;
+    // Shared array is replaced with a copy owned by dest only
+    struct Array copy;
+    const bool strings = (dest->cb->flags & CB_STRING_ELEMENTS) != 0;
+    if (
+        strings ?
+            !__meta_rt_string_array_malloc(dest->count, &copy) :
+            !__meta_rt_array_malloc(elem_sz, dest->count, &copy)
+    )
+        return false;
+    copy.count = dest->count;
+    if (strings) {
+        const struct String* src = (const struct String*)dest->data;
+        struct String* elements = (struct String*)copy.data;
+        for (uint32_t pos = 0; pos < dest->count; ++pos)
+            __meta_rt_string_attach(&src[pos], &elements[pos]);
+    } else
+        memcpy(copy.data, dest->data, (size_t)elem_sz*dest->count);
+    __meta_rt_array_release(dest);
+    *dest = copy;
+    return true;
 }
 
 uint32_t __meta_rt_array_usecount(struct Array* dest) {
     if (!dest->cb)
         return 0;
-    return atomic_load_explicit(&dest->cb->refcnt, memory_order_relaxed);
+    return rc_count(&dest->cb->refcnt);
 }
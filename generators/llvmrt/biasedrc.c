@@ -0,0 +1,98 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "refcount.h"
+
+/*
+ * Slow paths of the biased reference counting. A block whose shared counter goes negative is pushed
+ * to its owner queue and the owner merges its biased counter into the shared one next time it
+ * allocates. When the owner thread exits its queue is closed and the thread which would queue a
+ * block merges the counters itself: the owner doesn't touch its biased counters anymore.
+ */
+
+_Thread_local struct BiasOwner* __meta_rt_rc_thread = NULL;
+
+static struct RefCounter closed;
+/// All the owners ever registered: they are never freed but stay reachable for leak checkers
+static _Atomic(struct BiasOwner*) owners = NULL;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t owner_key;
+
+/// Moves biased counter of the block owned by the current thread to the shared one and removes flag
+static bool merge(struct RefCounter* rc, uint32_t removed_flag) {
+    const uint32_t delta = rc->biased*RC_ONE + RC_MERGED - removed_flag;
+    rc->biased = 0;
+    atomic_store_explicit(&rc->owner, NULL, memory_order_relaxed);
+    return atomic_fetch_add_explicit(&rc->shared, delta, memory_order_acq_rel) + delta == RC_MERGED;
+}
+
+static void process(struct BiasOwner* self, struct RefCounter* rc) {
+    while (rc) {
+        struct RefCounter* next = rc->next_queued;
+        bool last;
+        if (atomic_load_explicit(&rc->owner, memory_order_relaxed) == self)
+            last = merge(rc, RC_QUEUED);
+        else // merged by the owner after it was queued
+            last = atomic_fetch_sub_explicit(&rc->shared, RC_QUEUED, memory_order_acq_rel) - RC_QUEUED == RC_MERGED;
+        if (last)
+            __meta_rt_rc_free(rc);
+        rc = next;
+    }
+}
+
+static void close_queue(void* arg) {
+    struct BiasOwner* self = (struct BiasOwner*)arg;
+    process(self, atomic_exchange_explicit(&self->queue, &closed, memory_order_acq_rel));
+    __meta_rt_rc_thread = NULL;
+}
+
+static void create_key(void) {
+    pthread_key_create(&owner_key, close_queue);
+}
+
+struct BiasOwner* __meta_rt_rc_register(void) {
+    struct BiasOwner* self = (struct BiasOwner*)malloc(sizeof(struct BiasOwner));
+    if (!self)
+        abort();
+    atomic_init(&self->queue, NULL);
+    self->next = atomic_load_explicit(&owners, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &owners, &self->next, self, memory_order_release, memory_order_relaxed
+    ))
+        ;
+    pthread_once(&key_once, create_key);
+    pthread_setspecific(owner_key, self);
+    __meta_rt_rc_thread = self;
+    return self;
+}
+
+void __meta_rt_rc_merge_queued(struct BiasOwner* self) {
+    process(self, atomic_exchange_explicit(&self->queue, NULL, memory_order_acquire));
+}
+
+bool __meta_rt_rc_unbias(struct RefCounter* rc) {
+    atomic_store_explicit(&rc->owner, NULL, memory_order_relaxed);
+    // Queued block is freed by the owner queue processing only
+    return (atomic_fetch_or_explicit(&rc->shared, RC_MERGED, memory_order_acq_rel) | RC_MERGED) == RC_MERGED;
+}
+
+bool __meta_rt_rc_enqueue(struct RefCounter* rc) {
+    struct BiasOwner* owner = atomic_load_explicit(&rc->owner, memory_order_relaxed);
+    if (!owner) // merged concurrently, the shared counter is exact now
+        return false;
+    const uint32_t old = atomic_fetch_or_explicit(&rc->shared, RC_QUEUED, memory_order_acq_rel);
+    if (old & RC_QUEUED)
+        return false;
+    if (old & RC_MERGED)
+        return atomic_fetch_sub_explicit(&rc->shared, RC_QUEUED, memory_order_acq_rel) - RC_QUEUED == RC_MERGED;
+    // Acquire pairs with the queue closing to see the final biased counter of the exited owner
+    struct RefCounter* head = atomic_load_explicit(&owner->queue, memory_order_acquire);
+    do {
+        if (head == &closed) // owner thread has exited
+            return merge(rc, RC_QUEUED);
+        rc->next_queued = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &owner->queue, &head, rc, memory_order_release, memory_order_acquire
+    ));
+    return false;
+}
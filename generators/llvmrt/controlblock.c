@@ -0,0 +1,55 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "alloc.h"
+#include "controlblock.h"
+#include "metastring.h"
+#include "region.h"
+
+static struct ArrayControlBlock* cb_init(
+    struct ArrayControlBlock* cb, uint32_t elems_max, uint32_t flags, size_t size
+) {
+    if (!cb)
+        return NULL;
+    rc_init(&cb->refcnt);
+    cb->max_elements = elems_max;
+    cb->flags = flags;
+    cb->block_size = size;
+    return cb;
+}
+
+static bool block_size(uint32_t elem_sz, uint32_t elems_max, size_t* res) {
+    const size_t cbsz = sizeof(struct ArrayControlBlock);
+    // Requested block of memory too large (elem_sz*elems_cnt + cntsz > SIZE_MAX)
+    if (elems_max != 0 && (SIZE_MAX - cbsz)/elems_max < elem_sz)
+        return false;
+    *res = (size_t)elem_sz*elems_max + cbsz;
+    return true;
+}
+
+struct ArrayControlBlock* __meta_rt_cb_malloc(uint32_t elem_sz, uint32_t elems_max) {
+    size_t sz;
+    if (!block_size(elem_sz, elems_max, &sz))
+        return NULL;
+    return cb_init((struct ArrayControlBlock*)__meta_rt_mem_alloc(sz), elems_max, 0, sz);
+}
+
+struct ArrayControlBlock* __meta_rt_cb_region_malloc(uint32_t elem_sz, uint32_t elems_max) {
+    size_t sz;
+    if (!block_size(elem_sz, elems_max, &sz))
+        return NULL;
+    return cb_init((struct ArrayControlBlock*)__meta_rt_region_alloc(sz), elems_max, CB_REGION, sz);
+}
+
+void __meta_rt_rc_free(struct RefCounter* rc) {
+    struct ArrayControlBlock* cb = (struct ArrayControlBlock*)rc;
+    // Region memory is freed by the region end
+    if (cb->flags & CB_REGION)
+        return;
+    if (cb->flags & CB_STRING_ELEMENTS) {
+        struct String* elements = (struct String*)cb_data(cb);
+        for (uint32_t pos = 0; pos < cb->max_elements; ++pos)
+            __meta_rt_string_release(&elements[pos]);
+    }
+    __meta_rt_mem_free(cb, cb->block_size);
+}
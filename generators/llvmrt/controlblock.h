@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "refcount.h"
+
+/*
+ * Header of the reference counted memory blocks shared by arrays and heap strings. Data follows it.
+ */
+struct ArrayControlBlock {
+    // Must be the first member: blocks are freed by their reference counters
+    _Alignas(16) struct RefCounter refcnt;
+    uint32_t max_elements;
+    uint32_t flags;
+    // Size of the memory block holding both control block and data
+    uint64_t block_size;
+};
+/// Data is an array of max_elements strings each owning a reference released with the block
+#define CB_STRING_ELEMENTS 0x1u
+/// Block is allocated in a region and is freed with it rather than by the last reference release
+#define CB_REGION 0x2u
+
+_Static_assert(
+    sizeof(struct ArrayControlBlock)%16 == 0,
+    "ArrayControlBlock size must be multiple of 128bit to preserve array data aligmnet"
+);
+
+/// Allocates block for elems_max elements elem_sz bytes each with a single reference or returns NULL
+struct ArrayControlBlock* __meta_rt_cb_malloc(uint32_t elem_sz, uint32_t elems_max);
+/// Same as __meta_rt_cb_malloc but allocates the block in the current region
+struct ArrayControlBlock* __meta_rt_cb_region_malloc(uint32_t elem_sz, uint32_t elems_max);
+
+static inline void* cb_data(struct ArrayControlBlock* cb) {
+    return cb + 1;
+}
+
+static inline void cb_release(struct ArrayControlBlock* cb) {
+    if (rc_release(&cb->refcnt))
+        __meta_rt_rc_free(&cb->refcnt);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "controlblock.h"
+
+/*
+ * Meta string value. Literals and heap strings refer to their content by data pointer, heap strings
+ * are reference counted with the same control block as arrays while literals have no control block.
+ * Strings not longer than STRING_INLINE_CAPACITY bytes are stored inline in place of the pointers
+ * and marked with STRING_INLINE bit in size so they never touch the heap. Layout must match
+ * Environment::string of the generator.
+ *
+ * Inline strings changed the meaning of the fields of strings passed to and returned from extern
+ * and export functions: C code must read strings with __meta_rt_string_data and
+ * __meta_rt_string_length instead of the fields. META_RT_STRING_ABI_VERSION is incremented on every
+ * such change, C code could compare it with __meta_rt_string_abi_version() of the linked runtime.
+ *
+ *   1: {cb, data, size} with size being the string length
+ *   2: strings up to STRING_INLINE_CAPACITY bytes are stored inline
+ */
+#define META_RT_STRING_ABI_VERSION 2
+
+struct String {
+    union {
+        struct {
+            struct ArrayControlBlock* cb;
+            const char* data;
+        } ref;
+        char inline_data[2*sizeof(void*)];
+    };
+    uint32_t size;
+};
+
+#define STRING_INLINE 0x80000000u
+#define STRING_INLINE_CAPACITY (2*sizeof(void*) - 1)
+
+static inline bool is_inline(const struct String* str) {
+    return (str->size & STRING_INLINE) != 0;
+}
+
+uint32_t __meta_rt_string_abi_version(void);
+uint32_t __meta_rt_string_length(const struct String* str);
+/// Content of the string which is not null terminated
+const char* __meta_rt_string_data(const struct String* str);
+void __meta_rt_string_release(struct String* str);
+void __meta_rt_string_attach(const struct String* target, struct String* dest);
@@ -0,0 +1,163 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+
+/*
+ * Thread caching size class allocator. Blocks up to MAX_POOLED bytes are rounded up to the power of
+ * two size class and served from per thread free lists without any synchronization. A list growing
+ * above 2*BATCH_SIZE blocks returns BATCH_SIZE of them to the global pool of the class as a single
+ * batch, an empty list takes a whole batch back. Pools carve new blocks from CHUNK_SIZE chunks which
+ * are never returned to the system. Thread exit flushes its lists to the global pools. Larger blocks
+ * are passed to malloc directly.
+ */
+
+enum {
+    MIN_CLASS_SHIFT = 5, // 32 bytes is enough for a free block links
+    CLASSES_COUNT = 8, // up to 4096 bytes
+    BATCH_SIZE = 32,
+    CHUNK_SIZE = 64*1024
+};
+#define MAX_POOLED ((size_t)1 << (MIN_CLASS_SHIFT + CLASSES_COUNT - 1))
+
+struct FreeBlock {
+    struct FreeBlock* next;
+    // Valid only for the first block of a batch stored in a global pool
+    struct FreeBlock* next_batch;
+    size_t batch_size;
+};
+_Static_assert(
+    sizeof(struct FreeBlock) <= (1 << MIN_CLASS_SHIFT),
+    "Free block links must fit the smallest size class"
+);
+
+struct ThreadCache {
+    struct FreeBlock* head[CLASSES_COUNT];
+    size_t count[CLASSES_COUNT];
+    bool registered;
+};
+
+struct GlobalPool {
+    pthread_mutex_t lock;
+    struct FreeBlock* batches;
+    char* chunk;
+    size_t chunk_left;
+};
+
+static struct GlobalPool pools[CLASSES_COUNT];
+static pthread_once_t pools_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cache_key;
+static _Thread_local struct ThreadCache cache;
+
+static void push_batch(unsigned cls, struct FreeBlock* batch, size_t size) {
+    batch->batch_size = size;
+    pthread_mutex_lock(&pools[cls].lock);
+    batch->next_batch = pools[cls].batches;
+    pools[cls].batches = batch;
+    pthread_mutex_unlock(&pools[cls].lock);
+}
+
+static void flush_thread_cache(void* arg) {
+    struct ThreadCache* tc = (struct ThreadCache*)arg;
+    for (unsigned cls = 0; cls < CLASSES_COUNT; ++cls) {
+        if (tc->head[cls])
+            push_batch(cls, tc->head[cls], tc->count[cls]);
+        tc->head[cls] = NULL;
+        tc->count[cls] = 0;
+    }
+    tc->registered = false;
+}
+
+static void init_pools(void) {
+    pthread_key_create(&cache_key, flush_thread_cache);
+    for (unsigned cls = 0; cls < CLASSES_COUNT; ++cls)
+        pthread_mutex_init(&pools[cls].lock, NULL);
+}
+
+static struct ThreadCache* thread_cache(void) {
+    if (!cache.registered) {
+        pthread_once(&pools_once, init_pools);
+        // Non null value makes key destructor flush the cache on thread exit
+        pthread_setspecific(cache_key, &cache);
+        cache.registered = true;
+    }
+    return &cache;
+}
+
+static unsigned size_class(size_t size) {
+    unsigned res = 0;
+    while (((size_t)1 << (MIN_CLASS_SHIFT + res)) < size)
+        ++res;
+    return res;
+}
+
+/// Fills empty thread list with a batch of blocks from the global pool
+static bool refill(struct ThreadCache* tc, unsigned cls) {
+    const size_t block_size = (size_t)1 << (MIN_CLASS_SHIFT + cls);
+    struct GlobalPool* pool = &pools[cls];
+    pthread_mutex_lock(&pool->lock);
+    struct FreeBlock* batch = pool->batches;
+    if (batch) {
+        pool->batches = batch->next_batch;
+        pthread_mutex_unlock(&pool->lock);
+        tc->head[cls] = batch;
+        tc->count[cls] = batch->batch_size;
+        return true;
+    }
+    if (pool->chunk_left < block_size) {
+        // Tail of the previous chunk smaller than the block is wasted
+        pool->chunk = (char*)malloc(CHUNK_SIZE);
+        pool->chunk_left = pool->chunk ? CHUNK_SIZE : 0;
+    }
+    size_t carved = 0;
+    struct FreeBlock* head = NULL;
+    while (carved < BATCH_SIZE && pool->chunk_left >= block_size) {
+        struct FreeBlock* block = (struct FreeBlock*)pool->chunk;
+        block->next = head;
+        head = block;
+        pool->chunk += block_size;
+        pool->chunk_left -= block_size;
+        ++carved;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    tc->head[cls] = head;
+    tc->count[cls] = carved;
+    return head != NULL;
+}
+
+void* __meta_rt_mem_alloc(size_t size) {
+    if (size > MAX_POOLED)
+        return malloc(size);
+    const unsigned cls = size_class(size);
+    struct ThreadCache* tc = thread_cache();
+    if (!tc->head[cls] && !refill(tc, cls))
+        return NULL;
+    struct FreeBlock* res = tc->head[cls];
+    tc->head[cls] = res->next;
+    --tc->count[cls];
+    return res;
+}
+
+void __meta_rt_mem_free(void* block, size_t size) {
+    if (size > MAX_POOLED) {
+        free(block);
+        return;
+    }
+    const unsigned cls = size_class(size);
+    struct ThreadCache* tc = thread_cache();
+    struct FreeBlock* freed = (struct FreeBlock*)block;
+    freed->next = tc->head[cls];
+    tc->head[cls] = freed;
+    if (++tc->count[cls] < 2*BATCH_SIZE)
+        return;
+    // Blocks freed by consumer threads go back to producers through the global pool
+    struct FreeBlock* last = freed;
+    for (size_t pos = 1; pos < BATCH_SIZE; ++pos)
+        last = last->next;
+    tc->head[cls] = last->next;
+    tc->count[cls] -= BATCH_SIZE;
+    last->next = NULL;
+    push_batch(cls, freed, BATCH_SIZE);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Reference counter of the meta-rt shared memory blocks. Counting mode is selected when the runtime
+ * is built:
+ *  - atomic (default): every attach and release is an atomic read-modify-write;
+ *  - META_RT_REFCOUNT_NONATOMIC: plain increments and decrements, single threaded programs only;
+ *  - META_RT_REFCOUNT_BIASED: biased reference counting. The thread which created a block counts its
+ *    references without atomics while other threads use a shared atomic counter (see biasedrc.c).
+ *
+ * rc_release returns true when the last reference is released and the block must be freed by the
+ * caller. rc_unique returns true when the caller holds the only reference so the block could be
+ * modified in place, it may return false negatives but never false positives. Blocks whose last reference is released by the biased counting slow path are freed with
+ * __meta_rt_rc_free.
+ */
+
+struct RefCounter;
+
+void __meta_rt_rc_free(struct RefCounter* rc);
+
+#if defined(META_RT_REFCOUNT_NONATOMIC)
+
+struct RefCounter {
+    uint32_t count;
+};
+
+static inline void rc_init(struct RefCounter* rc) {
+    rc->count = 1;
+}
+
+static inline void rc_attach(struct RefCounter* rc) {
+    ++rc->count;
+}
+
+static inline bool rc_release(struct RefCounter* rc) {
+    return --rc->count == 0;
+}
+
+static inline uint32_t rc_count(struct RefCounter* rc) {
+    return rc->count;
+}
+
+static inline bool rc_unique(struct RefCounter* rc) {
+    return rc->count == 1;
+}
+
+#elif defined(META_RT_REFCOUNT_BIASED)
+
+/*
+ * Shared counter holds the number of references counted by non owner threads shifted by two bits.
+ * It goes negative when references counted by the owner are released by other threads. Flags:
+ *  - RC_MERGED: the owner has no biased references left and the shared counter is the total one;
+ *  - RC_QUEUED: the block is waiting in the owner queue for the biased counter merge.
+ */
+enum {
+    RC_MERGED = 1,
+    RC_QUEUED = 2,
+    RC_ONE = 4
+};
+
+struct RefCounter {
+    _Atomic(uint32_t) shared;
+    uint32_t biased;
+    _Atomic(struct BiasOwner*) owner;
+    struct RefCounter* next_queued;
+};
+
+/// Per thread record which lives until the program exit
+struct BiasOwner {
+    /// Blocks which references counted by this thread were released by other threads
+    _Atomic(struct RefCounter*) queue;
+    /// Previously registered owner
+    struct BiasOwner* next;
+};
+
+extern _Thread_local struct BiasOwner* __meta_rt_rc_thread;
+struct BiasOwner* __meta_rt_rc_register(void);
+void __meta_rt_rc_merge_queued(struct BiasOwner* self);
+bool __meta_rt_rc_unbias(struct RefCounter* rc);
+bool __meta_rt_rc_enqueue(struct RefCounter* rc);
+
+static inline struct BiasOwner* rc_self(void) {
+    struct BiasOwner* res = __meta_rt_rc_thread;
+    return res ? res : __meta_rt_rc_register();
+}
+
+static inline bool rc_owned(struct RefCounter* rc) {
+    return atomic_load_explicit(&rc->owner, memory_order_relaxed) == rc_self();
+}
+
+static inline void rc_init(struct RefCounter* rc) {
+    struct BiasOwner* self = rc_self();
+    // Blocks released by other threads are merged by the owner when it allocates next time
+    if (atomic_load_explicit(&self->queue, memory_order_relaxed))
+        __meta_rt_rc_merge_queued(self);
+    atomic_init(&rc->shared, 0);
+    rc->biased = 1;
+    atomic_init(&rc->owner, self);
+    rc->next_queued = NULL;
+}
+
+static inline void rc_attach(struct RefCounter* rc) {
+    if (rc_owned(rc))
+        ++rc->biased;
+    else
+        atomic_fetch_add_explicit(&rc->shared, RC_ONE, memory_order_relaxed);
+}
+
+static inline bool rc_release(struct RefCounter* rc) {
+    if (rc_owned(rc))
+        return --rc->biased == 0 && __meta_rt_rc_unbias(rc);
+    const uint32_t res = atomic_fetch_sub_explicit(&rc->shared, RC_ONE, memory_order_acq_rel) - RC_ONE;
+    if (res & RC_MERGED)
+        return res == RC_MERGED;
+    return (int32_t)res < 0 && __meta_rt_rc_enqueue(rc);
+}
+
+static inline uint32_t rc_count(struct RefCounter* rc) {
+    // Exact in the owner thread or after merge only
+    const int32_t shared = (int32_t)(atomic_load_explicit(&rc->shared, memory_order_relaxed) & ~(uint32_t)(RC_MERGED | RC_QUEUED));
+    return (uint32_t)(shared/RC_ONE) + (rc_owned(rc) ? rc->biased : 0);
+}
+
+static inline bool rc_unique(struct RefCounter* rc) {
+    // Acquire pairs with releases of the other references so their reads happen before our writes
+    const uint32_t shared = atomic_load_explicit(&rc->shared, memory_order_acquire);
+    const int32_t others = (int32_t)(shared & ~(uint32_t)(RC_MERGED | RC_QUEUED))/RC_ONE;
+    if (rc_owned(rc))
+        return others + (int32_t)rc->biased == 1;
+    // References counted by the owner are unknown to other threads until merge
+    return (shared & RC_MERGED) && others == 1;
+}
+
+#else
+
+struct RefCounter {
+    volatile _Atomic(uint32_t) count;
+};
+
+static inline void rc_init(struct RefCounter* rc) {
+    atomic_init(&rc->count, 1);
+}
+
+static inline void rc_attach(struct RefCounter* rc) {
+    atomic_fetch_add_explicit(&rc->count, 1, memory_order_relaxed);
+}
+
+static inline bool rc_release(struct RefCounter* rc) {
+    return atomic_fetch_sub_explicit(&rc->count, 1, memory_order_acq_rel) == 1;
+}
+
+static inline uint32_t rc_count(struct RefCounter* rc) {
+    return atomic_load_explicit(&rc->count, memory_order_relaxed);
+}
+
+static inline bool rc_unique(struct RefCounter* rc) {
+    // Acquire pairs with releases of the other references so their reads happen before our writes
+    return atomic_load_explicit(&rc->count, memory_order_acquire) == 1;
+}
+
+#endif
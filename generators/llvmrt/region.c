@@ -0,0 +1,72 @@
+#include <stdint.h>
+
+#include "alloc.h"
+#include "region.h"
+
+#define REGION_ALIGN 16
+#define MIN_CHUNK_SIZE ((size_t)4096)
+#define MAX_CHUNK_SIZE ((size_t)1 << 20)
+
+struct RegionChunk {
+    _Alignas(REGION_ALIGN) struct RegionChunk* prev;
+    // Size of the memory block holding both chunk header and data
+    size_t size;
+};
+_Static_assert(
+    sizeof(struct RegionChunk)%REGION_ALIGN == 0, "RegionChunk size must preserve allocations alignment"
+);
+
+static _Thread_local struct Region* current = NULL;
+
+void __meta_rt_region_begin(struct Region* region) {
+    // Chunks are allocated on first use so that regions which allocate nothing stay cheap
+    region->outer = current;
+    region->chunks = NULL;
+    region->next = NULL;
+    region->end = NULL;
+    current = region;
+}
+
+void __meta_rt_region_end(struct Region* region) {
+    // Regions end in the reverse order
+    if (region != current)
+        return;
+    current = region->outer;
+    struct RegionChunk* chunk = region->chunks;
+    while (chunk) {
+        struct RegionChunk* prev = chunk->prev;
+        __meta_rt_mem_free(chunk, chunk->size);
+        chunk = prev;
+    }
+}
+
+bool __meta_rt_region_active(void) {
+    return current != NULL;
+}
+
+void* __meta_rt_region_alloc(size_t size) {
+    struct Region* region = current;
+    if (!region || size > SIZE_MAX - MIN_CHUNK_SIZE)
+        return NULL;
+    // Empty blocks still get distinct addresses
+    size = size == 0 ? REGION_ALIGN : (size + REGION_ALIGN - 1) & ~(size_t)(REGION_ALIGN - 1);
+    if ((size_t)(region->end - region->next) < size) {
+        // Chunks grow geometrically up to MAX_CHUNK_SIZE, larger blocks get a chunk of their own
+        size_t chunk_size = region->chunks ? region->chunks->size*2 : MIN_CHUNK_SIZE;
+        if (chunk_size > MAX_CHUNK_SIZE)
+            chunk_size = MAX_CHUNK_SIZE;
+        if (chunk_size - sizeof(struct RegionChunk) < size)
+            chunk_size = size + sizeof(struct RegionChunk);
+        struct RegionChunk* chunk = (struct RegionChunk*)__meta_rt_mem_alloc(chunk_size);
+        if (!chunk)
+            return NULL;
+        chunk->prev = region->chunks;
+        chunk->size = chunk_size;
+        region->chunks = chunk;
+        region->next = (char*)(chunk + 1);
+        region->end = (char*)chunk + chunk_size;
+    }
+    void* res = region->next;
+    region->next += size;
+    return res;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Regions are per thread bump allocators freed in bulk when they end. Regions nest: allocations go to
+ * the innermost region started by the current thread. Memory allocated in a region is freed by the
+ * region end regardless of reference counts and must not be used after it.
+ *
+ * Region header is provided by the caller, generated code keeps it on the stack. Layout must match
+ * Environment::region of the generator.
+ */
+struct RegionChunk;
+
+struct Region {
+    struct Region* outer;
+    struct RegionChunk* chunks;
+    char* next;
+    char* end;
+};
+
+/// Makes the region nested into the current one current
+void __meta_rt_region_begin(struct Region* region);
+/// Frees all the memory allocated in the innermost region and makes the outer one current
+void __meta_rt_region_end(struct Region* region);
+bool __meta_rt_region_active(void);
+/// Allocates 16 bytes aligned block in the current region or returns NULL
+void* __meta_rt_region_alloc(size_t size);
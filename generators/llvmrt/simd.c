@@ -0,0 +1,397 @@
+#include <stdatomic.h>
+#include <string.h>
+
+#include "simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define META_RT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/*
+ * Kernels of each level are collected into a table selected once at startup by CPUID and switched by
+ * a single pointer store. Vector kernels process full vectors with unaligned loads and leave the tail
+ * to the scalar ones. Copy is forwarded to memmove which is already dispatched by the C library.
+ */
+
+struct Kernels {
+    int level;
+    bool (*memeq)(const uint8_t* lhs, const uint8_t* rhs, size_t size);
+    size_t (*find_byte)(const uint8_t* data, size_t size, uint8_t val);
+    size_t (*find)(const uint8_t* data, size_t size, const uint8_t* needle, size_t needle_size);
+    void (*fill_i32)(int32_t* data, uint32_t count, int32_t val);
+    int32_t (*sum_i32)(const int32_t* data, uint32_t count);
+    int32_t (*min_i32)(const int32_t* data, uint32_t count);
+    int32_t (*max_i32)(const int32_t* data, uint32_t count);
+};
+
+// Scalar kernels
+
+static bool memeq_scalar(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
+    for (size_t pos = 0; pos < size; ++pos) {
+        if (lhs[pos] != rhs[pos])
+            return false;
+    }
+    return true;
+}
+
+static size_t find_byte_scalar(const uint8_t* data, size_t size, uint8_t val) {
+    size_t pos = 0;
+    while (pos < size && data[pos] != val)
+        ++pos;
+    return pos;
+}
+
+/// Naive search starting from the position specified, needle_size must be in [1, size]
+static size_t find_from_scalar(
+    const uint8_t* data, size_t size, const uint8_t* needle, size_t needle_size, size_t start
+) {
+    for (size_t pos = start; pos + needle_size <= size; ++pos) {
+        if (data[pos] == needle[0] && memeq_scalar(data + pos + 1, needle + 1, needle_size - 1))
+            return pos;
+    }
+    return size;
+}
+
+static size_t find_scalar(const uint8_t* data, size_t size, const uint8_t* needle, size_t needle_size) {
+    return find_from_scalar(data, size, needle, needle_size, 0);
+}
+
+static void fill_i32_scalar(int32_t* data, uint32_t count, int32_t val) {
+    for (uint32_t pos = 0; pos < count; ++pos)
+        data[pos] = val;
+}
+
+static int32_t sum_i32_scalar(const int32_t* data, uint32_t count) {
+    uint32_t res = 0;
+    for (uint32_t pos = 0; pos < count; ++pos)
+        res += (uint32_t)data[pos];
+    return (int32_t)res;
+}
+
+static int32_t min_i32_scalar(const int32_t* data, uint32_t count) {
+    int32_t res = INT32_MAX;
+    for (uint32_t pos = 0; pos < count; ++pos)
+        res = data[pos] < res ? data[pos] : res;
+    return res;
+}
+
+static int32_t max_i32_scalar(const int32_t* data, uint32_t count) {
+    int32_t res = INT32_MIN;
+    for (uint32_t pos = 0; pos < count; ++pos)
+        res = data[pos] > res ? data[pos] : res;
+    return res;
+}
+
+static const struct Kernels scalar_kernels = {
+    SIMD_SCALAR,
+    memeq_scalar, find_byte_scalar, find_scalar, fill_i32_scalar, sum_i32_scalar, min_i32_scalar, max_i32_scalar
+};
+
+#ifdef META_RT_X86_KERNELS
+
+// SSE2 kernels
+
+__attribute__((target("sse2")))
+static bool memeq_sse2(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i l = _mm_loadu_si128((const __m128i*)(lhs + pos));
+        const __m128i r = _mm_loadu_si128((const __m128i*)(rhs + pos));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xffff)
+            return false;
+    }
+    return memeq_scalar(lhs + pos, rhs + pos, size - pos);
+}
+
+__attribute__((target("sse2")))
+static size_t find_byte_sse2(const uint8_t* data, size_t size, uint8_t val) {
+    const __m128i pattern = _mm_set1_epi8((char)val);
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+        const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+        if (mask)
+            return pos + (size_t)__builtin_ctz(mask);
+    }
+    return pos + find_byte_scalar(data + pos, size - pos, val);
+}
+
+/*
+ * Candidate positions are the ones where both the first and the last needle bytes match, only they
+ * are compared with the whole needle.
+ */
+__attribute__((target("sse2")))
+static size_t find_sse2(const uint8_t* data, size_t size, const uint8_t* needle, size_t needle_size) {
+    if (needle_size == 1)
+        return find_byte_sse2(data, size, needle[0]);
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[needle_size - 1]);
+    size_t pos = 0;
+    for (; pos + needle_size - 1 + 16 <= size; pos += 16) {
+        const __m128i firstBlock = _mm_loadu_si128((const __m128i*)(data + pos));
+        const __m128i lastBlock = _mm_loadu_si128((const __m128i*)(data + pos + needle_size - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(lastBlock, last))
+        );
+        while (mask) {
+            const size_t candidate = pos + (size_t)__builtin_ctz(mask);
+            if (memeq_sse2(data + candidate + 1, needle + 1, needle_size - 2))
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return find_from_scalar(data, size, needle, needle_size, pos);
+}
+
+__attribute__((target("sse2")))
+static void fill_i32_sse2(int32_t* data, uint32_t count, int32_t val) {
+    const __m128i pattern = _mm_set1_epi32(val);
+    uint32_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+        _mm_storeu_si128((__m128i*)(data + pos), pattern);
+    fill_i32_scalar(data + pos, count - pos, val);
+}
+
+__attribute__((target("sse2")))
+static int32_t reduce_sum_sse2(__m128i acc) {
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return sum_i32_scalar(lanes, 4);
+}
+
+__attribute__((target("sse2")))
+static int32_t sum_i32_sse2(const int32_t* data, uint32_t count) {
+    __m128i acc = _mm_setzero_si128();
+    uint32_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+        acc = _mm_add_epi32(acc, _mm_loadu_si128((const __m128i*)(data + pos)));
+    return (int32_t)((uint32_t)reduce_sum_sse2(acc) + (uint32_t)sum_i32_scalar(data + pos, count - pos));
+}
+
+// SSE2 has no 32 bit min and max, they are made of compare and select
+__attribute__((target("sse2")))
+static __m128i select_sse2(__m128i mask, __m128i ifSet, __m128i ifUnset) {
+    return _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifUnset));
+}
+
+__attribute__((target("sse2")))
+static int32_t min_i32_sse2(const int32_t* data, uint32_t count) {
+    __m128i acc = _mm_set1_epi32(INT32_MAX);
+    uint32_t pos = 0;
+    for (; pos + 4 <= count; pos += 4) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+        acc = select_sse2(_mm_cmpgt_epi32(acc, block), block, acc);
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    const int32_t vec = min_i32_scalar(lanes, 4);
+    const int32_t tail = min_i32_scalar(data + pos, count - pos);
+    return vec < tail ? vec : tail;
+}
+
+__attribute__((target("sse2")))
+static int32_t max_i32_sse2(const int32_t* data, uint32_t count) {
+    __m128i acc = _mm_set1_epi32(INT32_MIN);
+    uint32_t pos = 0;
+    for (; pos + 4 <= count; pos += 4) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+        acc = select_sse2(_mm_cmpgt_epi32(block, acc), block, acc);
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    const int32_t vec = max_i32_scalar(lanes, 4);
+    const int32_t tail = max_i32_scalar(data + pos, count - pos);
+    return vec > tail ? vec : tail;
+}
+
+static const struct Kernels sse2_kernels = {
+    SIMD_SSE2,
+    memeq_sse2, find_byte_sse2, find_sse2, fill_i32_sse2, sum_i32_sse2, min_i32_sse2, max_i32_sse2
+};
+
+// AVX2 kernels
+
+__attribute__((target("avx2")))
+static bool memeq_avx2(const uint8_t* lhs, const uint8_t* rhs, size_t size) {
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + pos));
+        const __m256i r = _mm256_loadu_si256((const __m256i*)(rhs + pos));
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)) != 0xffffffffu)
+            return false;
+    }
+    return memeq_sse2(lhs + pos, rhs + pos, size - pos);
+}
+
+__attribute__((target("avx2")))
+static size_t find_byte_avx2(const uint8_t* data, size_t size, uint8_t val) {
+    const __m256i pattern = _mm256_set1_epi8((char)val);
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i*)(data + pos));
+        const unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern));
+        if (mask)
+            return pos + (size_t)__builtin_ctz(mask);
+    }
+    return pos + find_byte_sse2(data + pos, size - pos, val);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(const uint8_t* data, size_t size, const uint8_t* needle, size_t needle_size) {
+    if (needle_size == 1)
+        return find_byte_avx2(data, size, needle[0]);
+    const __m256i first = _mm256_set1_epi8((char)needle[0]);
+    const __m256i last = _mm256_set1_epi8((char)needle[needle_size - 1]);
+    size_t pos = 0;
+    for (; pos + needle_size - 1 + 32 <= size; pos += 32) {
+        const __m256i firstBlock = _mm256_loadu_si256((const __m256i*)(data + pos));
+        const __m256i lastBlock = _mm256_loadu_si256((const __m256i*)(data + pos + needle_size - 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last))
+        );
+        while (mask) {
+            const size_t candidate = pos + (size_t)__builtin_ctz(mask);
+            if (memeq_avx2(data + candidate + 1, needle + 1, needle_size - 2))
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return find_from_scalar(data, size, needle, needle_size, pos);
+}
+
+__attribute__((target("avx2")))
+static void fill_i32_avx2(int32_t* data, uint32_t count, int32_t val) {
+    const __m256i pattern = _mm256_set1_epi32(val);
+    uint32_t pos = 0;
+    for (; pos + 8 <= count; pos += 8)
+        _mm256_storeu_si256((__m256i*)(data + pos), pattern);
+    fill_i32_scalar(data + pos, count - pos, val);
+}
+
+__attribute__((target("avx2")))
+static int32_t sum_i32_avx2(const int32_t* data, uint32_t count) {
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t pos = 0;
+    for (; pos + 8 <= count; pos += 8)
+        acc = _mm256_add_epi32(acc, _mm256_loadu_si256((const __m256i*)(data + pos)));
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    return (int32_t)((uint32_t)sum_i32_scalar(lanes, 8) + (uint32_t)sum_i32_scalar(data + pos, count - pos));
+}
+
+__attribute__((target("avx2")))
+static int32_t min_i32_avx2(const int32_t* data, uint32_t count) {
+    __m256i acc = _mm256_set1_epi32(INT32_MAX);
+    uint32_t pos = 0;
+    for (; pos + 8 <= count; pos += 8)
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i*)(data + pos)));
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    const int32_t vec = min_i32_scalar(lanes, 8);
+    const int32_t tail = min_i32_scalar(data + pos, count - pos);
+    return vec < tail ? vec : tail;
+}
+
+__attribute__((target("avx2")))
+static int32_t max_i32_avx2(const int32_t* data, uint32_t count) {
+    __m256i acc = _mm256_set1_epi32(INT32_MIN);
+    uint32_t pos = 0;
+    for (; pos + 8 <= count; pos += 8)
+        acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i*)(data + pos)));
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    const int32_t vec = max_i32_scalar(lanes, 8);
+    const int32_t tail = max_i32_scalar(data + pos, count - pos);
+    return vec > tail ? vec : tail;
+}
+
+static const struct Kernels avx2_kernels = {
+    SIMD_AVX2,
+    memeq_avx2, find_byte_avx2, find_avx2, fill_i32_avx2, sum_i32_avx2, min_i32_avx2, max_i32_avx2
+};
+
+#endif // META_RT_X86_KERNELS
+
+static const struct Kernels* kernels_table(int level) {
+#ifdef META_RT_X86_KERNELS
+    // Checks both CPUID and OS support of the extended registers state
+    __builtin_cpu_init();
+    if (level == SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        return &avx2_kernels;
+    if (level == SIMD_SSE2 && __builtin_cpu_supports("sse2"))
+        return &sse2_kernels;
+#endif
+    return level == SIMD_SCALAR ? &scalar_kernels : NULL;
+}
+
+// Tables are constant so relaxed accesses are enough
+static _Atomic(const struct Kernels*) current = NULL;
+
+static const struct Kernels* detect(void) {
+    const struct Kernels* res = NULL;
+    for (int level = SIMD_AVX2; !res; --level)
+        res = kernels_table(level);
+    atomic_store_explicit(&current, res, memory_order_relaxed);
+    return res;
+}
+
+__attribute__((constructor))
+static void init_kernels(void) {
+    if (!atomic_load_explicit(&current, memory_order_relaxed))
+        detect();
+}
+
+// Calls from other constructors could happen before init_kernels
+static inline const struct Kernels* kernels(void) {
+    const struct Kernels* res = atomic_load_explicit(&current, memory_order_relaxed);
+    return res ? res : detect();
+}
+
+int __meta_rt_simd_level(void) {
+    return kernels()->level;
+}
+
+bool __meta_rt_simd_select(int level) {
+    const struct Kernels* table = kernels_table(level);
+    if (!table)
+        return false;
+    atomic_store_explicit(&current, table, memory_order_relaxed);
+    return true;
+}
+
+bool __meta_rt_memeq(const void* lhs, const void* rhs, size_t size) {
+    return kernels()->memeq((const uint8_t*)lhs, (const uint8_t*)rhs, size);
+}
+
+size_t __meta_rt_find_byte(const void* data, size_t size, uint8_t val) {
+    return kernels()->find_byte((const uint8_t*)data, size, val);
+}
+
+size_t __meta_rt_find(const void* data, size_t size, const void* needle, size_t needle_size) {
+    if (needle_size == 0)
+        return 0;
+    if (needle_size > size)
+        return size;
+    return kernels()->find((const uint8_t*)data, size, (const uint8_t*)needle, needle_size);
+}
+
+void __meta_rt_copy(void* dest, const void* src, size_t size) {
+    memmove(dest, src, size);
+}
+
+void __meta_rt_fill_i32(int32_t* data, uint32_t count, int32_t val) {
+    kernels()->fill_i32(data, count, val);
+}
+
+int32_t __meta_rt_sum_i32(const int32_t* data, uint32_t count) {
+    return kernels()->sum_i32(data, count);
+}
+
+int32_t __meta_rt_min_i32(const int32_t* data, uint32_t count) {
+    return kernels()->min_i32(data, count);
+}
+
+int32_t __meta_rt_max_i32(const int32_t* data, uint32_t count) {
+    return kernels()->max_i32(data, count);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Memory and int array primitives used by the strings and arrays runtime and called by the generated
+ * code directly. Each of them has scalar, SSE2 and AVX2 kernel, the best one supported by the CPU is
+ * selected at startup.
+ */
+
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2 = 1,
+    SIMD_AVX2 = 2
+};
+
+/// Level of the kernels currently used
+int __meta_rt_simd_level(void);
+/// Switches to the kernels of the level specified, returns false if the CPU doesn't support them
+bool __meta_rt_simd_select(int level);
+
+bool __meta_rt_memeq(const void* lhs, const void* rhs, size_t size);
+/// Returns position of the first byte equal to val or size if there is no such byte
+size_t __meta_rt_find_byte(const void* data, size_t size, uint8_t val);
+/// Returns position of the first occurrence of needle in data or size if there is no such occurrence
+size_t __meta_rt_find(const void* data, size_t size, const void* needle, size_t needle_size);
+/// Copies size bytes, the ranges could overlap
+void __meta_rt_copy(void* dest, const void* src, size_t size);
+void __meta_rt_fill_i32(int32_t* data, uint32_t count, int32_t val);
+/// Sum with two's complement wrapping the same way meta int arithmetic does
+int32_t __meta_rt_sum_i32(const int32_t* data, uint32_t count);
+/// Returns INT32_MAX for empty array
+int32_t __meta_rt_min_i32(const int32_t* data, uint32_t count);
+/// Returns INT32_MIN for empty array
+int32_t __meta_rt_max_i32(const int32_t* data, uint32_t count);
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "metastring.h"
+#include "simd.h"
+
+uint32_t __meta_rt_string_abi_version(void) {
+    return META_RT_STRING_ABI_VERSION;
+}
+
+uint32_t __meta_rt_string_length(const struct String* str) {
+    return str->size & ~STRING_INLINE;
+}
+
+const char* __meta_rt_string_data(const struct String* str) {
+    return is_inline(str) ? str->inline_data : str->ref.data;
+}
+
+bool __meta_rt_string_concat(const struct String* lhs, const struct String* rhs, struct String* dest) {
+    const uint32_t lhs_len = __meta_rt_string_length(lhs);
+    const uint32_t rhs_len = __meta_rt_string_length(rhs);
+    if (rhs_len >= STRING_INLINE - lhs_len)
+        return false;
+    const uint32_t len = lhs_len + rhs_len;
+    // Arguments could alias destination
+    struct String res;
+    char* data;
+    if (len <= STRING_INLINE_CAPACITY) {
+        data = res.inline_data;
+        res.size = len | STRING_INLINE;
+    } else {
+        // Null terminated for C callers convinience
+        res.ref.cb = __meta_rt_cb_malloc(1, len + 1);
+        if (!res.ref.cb)
+            return false;
+        data = (char*)cb_data(res.ref.cb);
+        res.ref.data = data;
+        res.size = len;
+    }
+    memcpy(data, __meta_rt_string_data(lhs), lhs_len);
+    memcpy(data + lhs_len, __meta_rt_string_data(rhs), rhs_len);
+    data[len] = '\0';
+    *dest = res;
+    return true;
+}
+
+bool __meta_rt_string_equal(const struct String* lhs, const struct String* rhs) {
+    const uint32_t len = __meta_rt_string_length(lhs);
+    return
+        len == __meta_rt_string_length(rhs) &&
+        __meta_rt_memeq(__meta_rt_string_data(lhs), __meta_rt_string_data(rhs), len)
+    ;
+}
+
+/// Returns position of the first occurrence of needle in str or -1 if there is no such occurrence
+int32_t __meta_rt_string_find(const struct String* str, const struct String* needle) {
+    const uint32_t len = __meta_rt_string_length(str);
+    const size_t pos = __meta_rt_find(
+        __meta_rt_string_data(str), len, __meta_rt_string_data(needle), __meta_rt_string_length(needle)
+    );
+    return pos == len && __meta_rt_string_length(needle) != 0 ? -1 : (int32_t)pos;
+}
+
+void __meta_rt_string_release(struct String* str) {
+    if (is_inline(str) || !str->ref.cb)
+        return;
+    cb_release(str->ref.cb);
+}
+
+void __meta_rt_string_attach(const struct String* target, struct String* dest) {
+    *dest = *target;
+    if (is_inline(dest) || !dest->ref.cb)
+        return;
+    rc_attach(&dest->ref.cb->refcnt);
+}
+
+uint32_t __meta_rt_string_usecount(const struct String* str) {
+    if (is_inline(str) || !str->ref.cb)
+        return 0;
+    return rc_count(&str->ref.cb->refcnt);
+}
@@ -0,0 +1,12 @@
+#include <stdlib.h>
+
+#include "alloc.h"
+
+void* __meta_rt_mem_alloc(size_t size) {
+    return malloc(size);
+}
+
+void __meta_rt_mem_free(void* block, size_t size) {
+    (void)size;
+    free(block);
+}
@@ -0,0 +1,227 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Measures meta-rt arrays allocation, region allocation and reference counting throughput in 1, 4 and
+ * 16 threads, cost of the cache line contention on the shared control blocks and single threaded
+ * throughput of the SIMD kernels of each level supported by the CPU. The same source is linked with each
+ * of the runtime variants. Run with the number of iterations as the only optional argument.
+ */
+
+struct MArray {
+    void* cb;
+    void* data;
+    uint32_t count;
+};
+
+struct MRegion {
+    void* fields[4];
+};
+
+extern "C" {
+
+bool __meta_rt_array_malloc(uint32_t elem_sz, uint32_t elems_max, MArray* dest);
+void __meta_rt_array_release(MArray* dest);
+void __meta_rt_array_attach(const MArray* target, MArray* dest);
+bool __meta_rt_region_array_malloc(uint32_t elem_sz, uint32_t elems_max, MArray* dest);
+
+void __meta_rt_region_begin(MRegion* region);
+void __meta_rt_region_end(MRegion* region);
+
+bool __meta_rt_simd_select(int level);
+size_t __meta_rt_find(const void* data, size_t size, const void* needle, size_t needle_size);
+int32_t __meta_rt_sum_i32(const int32_t* data, uint32_t count);
+
+}
+
+/// Keeps results of the computations measured alive, atomic to stay quiet under ThreadSanitizer
+std::atomic<int64_t> sink{0};
+
+/// Runs func(iterations) in each of the threads and prints operations throughput
+template<typename F>
+void measure(const char* name, int iterations, int threadsCount, F&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadsCount; ++thread)
+        threads.emplace_back([&] {func(iterations);});
+    for (auto& thread: threads)
+        thread.join();
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    const double operations = static_cast<double>(iterations)*threadsCount;
+    std::cout <<
+        name << " threads " << threadsCount << ": " <<
+        operations/ns*1000 << " M operations/s, " <<
+        static_cast<double>(ns)*threadsCount/operations << " ns per operation per thread" << std::endl
+    ;
+}
+
+MArray allocate(uint32_t count) {
+    MArray res{nullptr, nullptr, 0};
+    if (!__meta_rt_array_malloc(sizeof(int), count, &res))
+        std::abort();
+    res.count = count;
+    return res;
+}
+
+/// Each thread keeps up to window arrays alive releasing the oldest one on every allocation
+auto allocations(size_t window, uint32_t maxCount) {
+    return [=](int iterations) {
+        std::vector<MArray> alive(window, MArray{nullptr, nullptr, 0});
+        for (int i = 0; i < iterations; ++i) {
+            MArray& slot = alive[i%window];
+            __meta_rt_array_release(&slot);
+            slot = allocate(1 + (i*7919u)%maxCount);
+        }
+        for (MArray& array: alive)
+            __meta_rt_array_release(&array);
+    };
+}
+
+/// Arrays allocated per request and all dropped at its end: released one by one or freed with the region
+auto batches(size_t batch, uint32_t maxCount, bool region) {
+    return [=](int iterations) {
+        std::vector<MArray> alive;
+        alive.reserve(batch);
+        MRegion storage;
+        if (region)
+            __meta_rt_region_begin(&storage);
+        for (int i = 0; i < iterations; ++i) {
+            if (alive.size() == batch) {
+                if (region) {
+                    __meta_rt_region_end(&storage);
+                    __meta_rt_region_begin(&storage);
+                } else {
+                    for (MArray& array: alive)
+                        __meta_rt_array_release(&array);
+                }
+                alive.clear();
+            }
+            const uint32_t count = 1 + (i*7919u)%maxCount;
+            MArray array{nullptr, nullptr, 0};
+            if (!__meta_rt_region_array_malloc(sizeof(int), count, &array))
+                std::abort();
+            alive.push_back(array);
+        }
+        for (MArray& array: alive)
+            __meta_rt_array_release(&array);
+        if (region)
+            __meta_rt_region_end(&storage);
+    };
+}
+
+/// Attach and release pairs on the array: copies passed around the code
+void attachRelease(MArray& array, int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+        MArray copy;
+        __meta_rt_array_attach(&array, &copy);
+        __meta_rt_array_release(&copy);
+    }
+}
+
+/// Reads elements placed right after the control block so they share its cache line
+void readHead(const MArray& array, int iterations) {
+    const volatile int* data = static_cast<const int*>(array.data);
+    int64_t res = 0;
+    for (int i = 0; i < iterations; ++i)
+        res += data[i%4];
+    sink.store(res, std::memory_order_relaxed);
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (iterations <= 0) {
+        std::cerr << "Ussage: " << argv[0] << " [ITERATIONS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+#ifdef META_RT_SINGLE_THREADED
+    const auto threadCounts = {1};
+#else
+    const auto threadCounts = {1, 4, 16};
+#endif
+    for (int threads: threadCounts) {
+        measure("alloc small", iterations, threads, allocations(1, 16));
+        measure("alloc mixed", iterations, threads, allocations(64, 1000));
+        measure("alloc large", iterations, threads, allocations(16, 4000));
+        measure("alloc batch heap", iterations, threads, batches(64, 1000, false));
+        measure("alloc batch region", iterations, threads, batches(64, 1000, true));
+        // Every thread counts references to its own array
+        measure("attach/release own", iterations, threads, [](int n) {
+            MArray array = allocate(16);
+            attachRelease(array, n);
+            __meta_rt_array_release(&array);
+        });
+#ifndef META_RT_SINGLE_THREADED
+        // All threads count references to the array created by the main thread
+        MArray shared = allocate(16);
+        measure("attach/release shared", iterations, threads, [&shared](int n) {attachRelease(shared, n);});
+        // Each thread counts references to its own array created by the main thread: the same
+        // operations as above without contention
+        std::vector<MArray> separate;
+        for (int thread = 0; thread < threads; ++thread)
+            separate.push_back(allocate(16));
+        std::atomic<int> next{0};
+        measure("attach/release separate", iterations, threads, [&separate, &next](int n) {
+            attachRelease(separate[next++], n);
+        });
+        for (MArray& array: separate)
+            __meta_rt_array_release(&array);
+        // Readers of the array data slowed down by the reference counter updates of another thread
+        measure("read near refcount quiet", iterations, threads, [&shared](int n) {readHead(shared, n);});
+        std::atomic<bool> stop{false};
+        std::thread writer([&shared, &stop] {
+            while (!stop.load(std::memory_order_relaxed))
+                attachRelease(shared, 100);
+        });
+        measure("read near refcount contended", iterations, threads, [&shared](int n) {readHead(shared, n);});
+        stop = true;
+        writer.join();
+        __meta_rt_array_release(&shared);
+#endif
+    }
+
+    const std::vector<int32_t> numbers(1024, 1);
+    std::string text(4096, 'a');
+    text.replace(text.size() - 3, 3, "abc");
+    const int kernelIterations = std::max(iterations/100, 1);
+    for (int level = 0; level <= 2; ++level) {
+        if (!__meta_rt_simd_select(level))
+            continue;
+        const std::string suffix = " level " + std::to_string(level);
+        measure(("sum 1024 ints" + suffix).c_str(), kernelIterations, 1, [&numbers](int n) {
+            for (int i = 0; i < n; ++i)
+                sink.store(__meta_rt_sum_i32(numbers.data(), static_cast<uint32_t>(numbers.size())), std::memory_order_relaxed);
+        });
+        measure(("find in 4096 bytes" + suffix).c_str(), kernelIterations, 1, [&text](int n) {
+            for (int i = 0; i < n; ++i)
+                sink.store(static_cast<int64_t>(__meta_rt_find(text.data(), text.size(), "abc", 3)), std::memory_order_relaxed);
+        });
+    }
+    return EXIT_SUCCESS;
+}
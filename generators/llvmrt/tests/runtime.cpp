@@ -0,0 +1,546 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+struct MArray {
+    void* cb;
+    void* data;
+    uint32_t count;
+};
+
+struct MRegion {
+    void* fields[4];
+};
+
+struct MString {
+    void* cb;
+    const char* data;
+    uint32_t size;
+};
+
+extern "C" {
+
+bool __meta_rt_array_malloc(uint32_t elem_sz, uint32_t elems_max, MArray* dest);
+void __meta_rt_array_release(MArray* dest);
+void __meta_rt_array_attach(const MArray* target, MArray* dest);
+uint32_t __meta_rt_array_usecount(MArray* dest);
+bool __meta_rt_array_unique(uint32_t elem_sz, MArray* dest);
+bool __meta_rt_string_array_malloc(uint32_t elems_max, MArray* dest);
+bool __meta_rt_region_array_malloc(uint32_t elem_sz, uint32_t elems_max, MArray* dest);
+
+uint32_t __meta_rt_string_abi_version();
+uint32_t __meta_rt_string_length(const MString* str);
+const char* __meta_rt_string_data(const MString* str);
+bool __meta_rt_string_concat(const MString* lhs, const MString* rhs, MString* dest);
+void __meta_rt_string_release(MString* str);
+void __meta_rt_string_attach(const MString* target, MString* dest);
+uint32_t __meta_rt_string_usecount(const MString* str);
+bool __meta_rt_string_equal(const MString* lhs, const MString* rhs);
+int32_t __meta_rt_string_find(const MString* str, const MString* needle);
+
+int __meta_rt_simd_level();
+bool __meta_rt_simd_select(int level);
+bool __meta_rt_memeq(const void* lhs, const void* rhs, size_t size);
+size_t __meta_rt_find_byte(const void* data, size_t size, uint8_t val);
+size_t __meta_rt_find(const void* data, size_t size, const void* needle, size_t needle_size);
+void __meta_rt_copy(void* dest, const void* src, size_t size);
+void __meta_rt_fill_i32(int32_t* data, uint32_t count, int32_t val);
+int32_t __meta_rt_sum_i32(const int32_t* data, uint32_t count);
+int32_t __meta_rt_min_i32(const int32_t* data, uint32_t count);
+int32_t __meta_rt_max_i32(const int32_t* data, uint32_t count);
+
+void __meta_rt_region_begin(MRegion* region);
+void __meta_rt_region_end(MRegion* region);
+bool __meta_rt_region_active();
+void* __meta_rt_region_alloc(size_t size);
+
+}
+
+namespace {
+
+MString literal(const char* str) {
+    return MString{nullptr, str, static_cast<uint32_t>(std::strlen(str))};
+}
+
+std::string content(const MString& str) {
+    return {__meta_rt_string_data(&str), __meta_rt_string_length(&str)};
+}
+
+TEST(Runtime, refcounting) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 10, &array));
+    array.count = 10;
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    MArray copy{};
+    __meta_rt_array_attach(&array, &copy);
+    EXPECT_EQ(copy.data, array.data);
+    EXPECT_EQ(copy.count, array.count);
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 2u);
+    __meta_rt_array_release(&copy);
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    __meta_rt_array_release(&array);
+}
+
+TEST(Runtime, emptyArray) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 0, &array));
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    __meta_rt_array_release(&array);
+    MArray null{};
+    EXPECT_EQ(__meta_rt_array_usecount(&null), 0u);
+    __meta_rt_array_release(&null);
+}
+
+TEST(Runtime, tooLarge) {
+    MArray array{};
+    EXPECT_FALSE(__meta_rt_array_malloc(UINT32_MAX, UINT32_MAX, &array));
+}
+
+TEST(Runtime, dataAlignment) {
+    for (uint32_t count = 0; count < 300; ++count) {
+        MArray array{};
+        ASSERT_TRUE(__meta_rt_array_malloc(sizeof(double), count, &array));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data)%alignof(double), 0u) << "count: " << count;
+        __meta_rt_array_release(&array);
+    }
+}
+
+TEST(Runtime, attachReleaseCycles) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 4, &array));
+    std::vector<MArray> copies(100);
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        for (MArray& copy: copies)
+            __meta_rt_array_attach(&array, &copy);
+        EXPECT_EQ(__meta_rt_array_usecount(&array), 101u);
+        for (MArray& copy: copies)
+            __meta_rt_array_release(&copy);
+        EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    }
+    __meta_rt_array_release(&array);
+}
+
+TEST(Runtime, copyOnWrite) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 4, &array));
+    array.count = 4;
+    for (int pos = 0; pos < 4; ++pos)
+        static_cast<int*>(array.data)[pos] = pos;
+    // Single reference is written in place
+    void* data = array.data;
+    ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &array));
+    EXPECT_EQ(array.data, data);
+    MArray copy{};
+    __meta_rt_array_attach(&array, &copy);
+    ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &copy));
+    EXPECT_NE(copy.data, array.data);
+    EXPECT_EQ(copy.count, 4u);
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    EXPECT_EQ(__meta_rt_array_usecount(&copy), 1u);
+    static_cast<int*>(copy.data)[2] = 42;
+    EXPECT_EQ(static_cast<int*>(array.data)[2], 2);
+    EXPECT_EQ(static_cast<int*>(copy.data)[3], 3);
+    __meta_rt_array_release(&copy);
+    __meta_rt_array_release(&array);
+
+    MArray null{};
+    EXPECT_TRUE(__meta_rt_array_unique(sizeof(int), &null));
+}
+
+TEST(Runtime, copyOnWriteStringArray) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_string_array_malloc(2, &array));
+    array.count = 2;
+    const MString hello = literal("Hello");
+    const MString world = literal(", heap allocated world");
+    MString* elements = static_cast<MString*>(array.data);
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &elements[0]));
+    MArray copy{};
+    __meta_rt_array_attach(&array, &copy);
+    ASSERT_TRUE(__meta_rt_array_unique(sizeof(MString), &copy));
+    // Elements are shared by both arrays
+    EXPECT_EQ(__meta_rt_string_usecount(&elements[0]), 2u);
+    EXPECT_EQ(content(static_cast<MString*>(copy.data)[0]), "Hello, heap allocated world");
+    __meta_rt_array_release(&array);
+    EXPECT_EQ(__meta_rt_string_usecount(&static_cast<MString*>(copy.data)[0]), 1u);
+    __meta_rt_array_release(&copy);
+}
+
+TEST(Runtime, copyOnWriteRegionArray) {
+    MRegion region;
+    __meta_rt_region_begin(&region);
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_region_array_malloc(sizeof(int), 2, &array));
+    array.count = 2;
+    static_cast<int*>(array.data)[1] = 7;
+    MArray copy{};
+    __meta_rt_array_attach(&array, &copy);
+    ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &copy));
+    EXPECT_NE(copy.data, array.data);
+    EXPECT_EQ(static_cast<int*>(copy.data)[1], 7);
+    // Copy is not bound to the region
+    __meta_rt_region_end(&region);
+    EXPECT_EQ(static_cast<int*>(copy.data)[1], 7);
+    __meta_rt_array_release(&copy);
+}
+
+TEST(Runtime, shortStringsInline) {
+    const MString hello = literal("Hello");
+    const MString world = literal(", world");
+    MString res{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &res));
+    EXPECT_EQ(content(res), "Hello, world");
+    // No heap block to count references to
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 0u);
+    MString copy{};
+    __meta_rt_string_attach(&res, &copy);
+    EXPECT_EQ(content(copy), "Hello, world");
+    __meta_rt_string_release(&copy);
+    __meta_rt_string_release(&res);
+
+    const MString longest = literal("123456789012345");
+    const MString empty = literal("");
+    ASSERT_TRUE(__meta_rt_string_concat(&longest, &empty, &res));
+    EXPECT_EQ(content(res), "123456789012345");
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 0u);
+    EXPECT_EQ(__meta_rt_string_data(&res)[15], '\0');
+}
+
+TEST(Runtime, stringAbi) {
+    // C code built for the pointer only strings would misread inline ones
+    EXPECT_EQ(__meta_rt_string_abi_version(), 2u);
+    const MString hello = literal("Hello");
+    const MString world = literal(", world");
+    MString res{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &res));
+    EXPECT_NE(res.size, 12u);
+    EXPECT_EQ(__meta_rt_string_length(&res), 12u);
+    EXPECT_EQ(std::memcmp(__meta_rt_string_data(&res), "Hello, world", 12), 0);
+    __meta_rt_string_release(&res);
+}
+
+TEST(Runtime, heapStrings) {
+    const MString hello = literal("Hello");
+    const MString world = literal(", heap allocated world");
+    MString res{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &res));
+    EXPECT_EQ(content(res), "Hello, heap allocated world");
+    EXPECT_STREQ(__meta_rt_string_data(&res), "Hello, heap allocated world");
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 1u);
+    MString copy{};
+    __meta_rt_string_attach(&res, &copy);
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 2u);
+    // Destination could be one of the arguments
+    ASSERT_TRUE(__meta_rt_string_concat(&copy, &copy, &copy));
+    EXPECT_EQ(content(copy), "Hello, heap allocated worldHello, heap allocated world");
+    EXPECT_EQ(content(res), "Hello, heap allocated world");
+    // Replaced reference is still owned by the caller
+    EXPECT_EQ(__meta_rt_string_usecount(&res), 2u);
+    __meta_rt_string_release(&res);
+    __meta_rt_string_release(&res);
+    __meta_rt_string_release(&copy);
+}
+
+TEST(Runtime, literalStrings) {
+    const MString hello = literal("Hello");
+    MString copy{};
+    __meta_rt_string_attach(&hello, &copy);
+    EXPECT_EQ(copy.data, hello.data);
+    EXPECT_EQ(__meta_rt_string_usecount(&copy), 0u);
+    __meta_rt_string_release(&copy);
+}
+
+TEST(Runtime, stringArrayOwnsElements) {
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_string_array_malloc(3, &array));
+    MString* elements = static_cast<MString*>(array.data);
+    for (uint32_t pos = 0; pos < 3; ++pos)
+        EXPECT_EQ(__meta_rt_string_length(&elements[pos]), 0u);
+    const MString hello = literal("Hello");
+    const MString world = literal(", heap allocated world");
+    MString str{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &str));
+    __meta_rt_string_attach(&str, &elements[1]);
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &hello, &elements[2]));
+    EXPECT_EQ(__meta_rt_string_usecount(&str), 2u);
+    // Elements are released with the last array reference
+    __meta_rt_array_release(&array);
+    EXPECT_EQ(__meta_rt_string_usecount(&str), 1u);
+    __meta_rt_string_release(&str);
+}
+
+TEST(Runtime, regions) {
+    EXPECT_FALSE(__meta_rt_region_active());
+    EXPECT_EQ(__meta_rt_region_alloc(16), nullptr);
+    MRegion region;
+    __meta_rt_region_begin(&region);
+    EXPECT_TRUE(__meta_rt_region_active());
+    std::vector<char*> blocks;
+    // Small blocks, blocks larger than a chunk and empty ones
+    const size_t sizes[] = {0, 1, 7, 16, 100, 5000, 3 << 20, 24};
+    for (size_t size: sizes) {
+        char* block = static_cast<char*>(__meta_rt_region_alloc(size));
+        ASSERT_NE(block, nullptr) << "size: " << size;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block)%16, 0u) << "size: " << size;
+        std::memset(block, static_cast<int>(blocks.size()), size);
+        for (char* prev: blocks)
+            EXPECT_NE(prev, block) << "size: " << size;
+        blocks.push_back(block);
+    }
+    for (int i = 0; i < 10000; ++i)
+        ASSERT_NE(__meta_rt_region_alloc(48), nullptr);
+    // Nested region is freed independently
+    MRegion nested;
+    __meta_rt_region_begin(&nested);
+    ASSERT_NE(__meta_rt_region_alloc(64), nullptr);
+    __meta_rt_region_end(&nested);
+    EXPECT_TRUE(__meta_rt_region_active());
+    EXPECT_EQ(blocks[4][99], 4);
+    __meta_rt_region_end(&region);
+    EXPECT_FALSE(__meta_rt_region_active());
+    // Ending region which is not current is no-op
+    __meta_rt_region_end(&region);
+}
+
+TEST(Runtime, regionArrays) {
+    MArray heap{};
+    ASSERT_TRUE(__meta_rt_region_array_malloc(sizeof(int), 4, &heap));
+    EXPECT_EQ(__meta_rt_array_usecount(&heap), 1u);
+    MRegion region;
+    __meta_rt_region_begin(&region);
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_region_array_malloc(sizeof(int), 4, &array));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data)%16, 0u);
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+    static_cast<int*>(array.data)[3] = 42;
+    MArray copy{};
+    __meta_rt_array_attach(&array, &copy);
+    EXPECT_EQ(copy.data, array.data);
+    EXPECT_EQ(__meta_rt_array_usecount(&array), 2u);
+    __meta_rt_array_release(&copy);
+    __meta_rt_array_release(&array);
+    // Memory is freed by the region end only
+    EXPECT_EQ(static_cast<int*>(array.data)[3], 42);
+    EXPECT_FALSE(__meta_rt_region_array_malloc(UINT32_MAX, UINT32_MAX, &array));
+    __meta_rt_region_end(&region);
+    __meta_rt_array_release(&heap);
+}
+
+TEST(Runtime, stringsCompareAndFind) {
+    const MString hello = literal("Hello");
+    const MString world = literal(", heap allocated world");
+    MString inlined{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &hello, &inlined));
+    MString heap{};
+    ASSERT_TRUE(__meta_rt_string_concat(&hello, &world, &heap));
+    const MString sameHeap = literal("Hello, heap allocated world");
+    EXPECT_TRUE(__meta_rt_string_equal(&heap, &sameHeap));
+    EXPECT_FALSE(__meta_rt_string_equal(&heap, &inlined));
+    const MString sameInlined = literal("HelloHello");
+    EXPECT_TRUE(__meta_rt_string_equal(&sameInlined, &inlined));
+    EXPECT_EQ(__meta_rt_string_find(&heap, &world), 5);
+    EXPECT_EQ(__meta_rt_string_find(&inlined, &hello), 0);
+    EXPECT_EQ(__meta_rt_string_find(&hello, &inlined), -1);
+    const MString empty{};
+    EXPECT_EQ(__meta_rt_string_find(&hello, &empty), 0);
+    EXPECT_EQ(__meta_rt_string_find(&empty, &hello), -1);
+    __meta_rt_string_release(&heap);
+    __meta_rt_string_release(&inlined);
+}
+
+// Every kernels level supported by the CPU gives the same results as the straightforward code
+TEST(Runtime, simdKernels) {
+    const int detected = __meta_rt_simd_level();
+    EXPECT_TRUE(__meta_rt_simd_select(0));
+    std::string text;
+    for (int i = 0; i < 300; ++i)
+        text += static_cast<char>('a' + (i*7)%5);
+    std::vector<int32_t> numbers(300);
+    for (size_t i = 0; i < numbers.size(); ++i)
+        numbers[i] = static_cast<int32_t>((i*2654435761u) ^ 0x5bd1e995u);
+    const std::vector<std::string> needles = {"b", "ca", "ce", "bdace", "dacebdac", "zz", text.substr(40, 50)};
+    for (int level = 0; level <= 2; ++level) {
+        if (!__meta_rt_simd_select(level))
+            continue;
+        // All the tails and unaligned starts
+        for (size_t size = 0; size < 100; ++size) {
+            const size_t offset = size%7;
+            std::string copy = text.substr(offset, size);
+            EXPECT_TRUE(__meta_rt_memeq(text.data() + offset, copy.data(), size)) << "level " << level;
+            if (size > 0) {
+                copy[size - 1] = 'z';
+                EXPECT_FALSE(__meta_rt_memeq(text.data() + offset, copy.data(), size)) << "level " << level;
+            }
+            for (char c: {'a', 'e', 'z'}) {
+                const size_t expected = std::min(text.substr(offset, size).find(c), size);
+                EXPECT_EQ(__meta_rt_find_byte(text.data() + offset, size, static_cast<uint8_t>(c)), expected)
+                    << "level " << level << " size " << size;
+            }
+            for (const std::string& needle: needles) {
+                const size_t expected = std::min(text.substr(offset, size).find(needle), size);
+                EXPECT_EQ(__meta_rt_find(text.data() + offset, size, needle.data(), needle.size()), expected)
+                    << "level " << level << " size " << size << " needle " << needle;
+            }
+
+            const uint32_t count = static_cast<uint32_t>(size);
+            const int32_t* data = numbers.data() + offset;
+            uint32_t sum = 0;
+            int32_t min = INT32_MAX;
+            int32_t max = INT32_MIN;
+            for (uint32_t i = 0; i < count; ++i) {
+                sum += static_cast<uint32_t>(data[i]);
+                min = std::min(min, data[i]);
+                max = std::max(max, data[i]);
+            }
+            EXPECT_EQ(__meta_rt_sum_i32(data, count), static_cast<int32_t>(sum)) << "level " << level;
+            EXPECT_EQ(__meta_rt_min_i32(data, count), min) << "level " << level;
+            EXPECT_EQ(__meta_rt_max_i32(data, count), max) << "level " << level;
+
+            std::vector<int32_t> filled(size + 2, 0);
+            __meta_rt_fill_i32(filled.data() + 1, count, -42);
+            EXPECT_EQ(filled.front(), 0);
+            EXPECT_EQ(filled.back(), 0);
+            EXPECT_EQ(std::count(filled.begin(), filled.end(), -42), static_cast<long>(size));
+        }
+    }
+    EXPECT_TRUE(__meta_rt_simd_select(detected));
+    EXPECT_FALSE(__meta_rt_simd_select(3));
+
+    char overlapping[] = "abcdef";
+    __meta_rt_copy(overlapping + 1, overlapping, 4);
+    EXPECT_STREQ(overlapping, "aabcdf");
+}
+
+#ifndef META_RT_SINGLE_THREADED
+
+// Blocks of all size classes allocated in one thread and released in another are not shared by live arrays
+TEST(Runtime, crossThreadRelease) {
+    constexpr int threadsCount = 4;
+    constexpr uint32_t arraysCount = 2000;
+    std::vector<std::vector<MArray>> produced(threadsCount);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadsCount; ++thread) {
+        threads.emplace_back([thread, &produced] {
+            for (uint32_t pos = 0; pos < arraysCount; ++pos) {
+                MArray array{};
+                const uint32_t count = (pos*37)%2048;
+                ASSERT_TRUE(__meta_rt_array_malloc(1, count, &array));
+                array.count = count;
+                std::memset(array.data, thread + 1, count);
+                produced[thread].push_back(array);
+            }
+        });
+    }
+    for (auto& thread: threads)
+        thread.join();
+    threads.clear();
+    for (int thread = 0; thread < threadsCount; ++thread) {
+        // Each thread releases arrays produced by the next one
+        threads.emplace_back([thread, &produced] {
+            for (MArray& array: produced[(thread + 1)%threadsCount]) {
+                const auto* data = static_cast<const unsigned char*>(array.data);
+                for (uint32_t pos = 0; pos < array.count; ++pos)
+                    ASSERT_EQ(data[pos], (thread + 1)%threadsCount + 1);
+                __meta_rt_array_release(&array);
+            }
+        });
+    }
+    for (auto& thread: threads)
+        thread.join();
+}
+
+// References created by a live thread and released by others
+TEST(Runtime, sharedWithLiveOwner) {
+    constexpr int threadsCount = 4;
+    constexpr int cycles = 10000;
+    for (int round = 0; round < 10; ++round) {
+        MArray array{};
+        ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 16, &array));
+        // Passed to the threads without attach: main thread references are released by them
+        std::vector<MArray> passed(threadsCount);
+        for (MArray& copy: passed)
+            __meta_rt_array_attach(&array, &copy);
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < threadsCount; ++thread) {
+            threads.emplace_back([&array, &passed, thread] {
+                for (int cycle = 0; cycle < cycles; ++cycle) {
+                    MArray copy{};
+                    __meta_rt_array_attach(&passed[thread], &copy);
+                    __meta_rt_array_release(&copy);
+                }
+                __meta_rt_array_release(&passed[thread]);
+            });
+        }
+        for (int cycle = 0; cycle < cycles; ++cycle) {
+            MArray copy{};
+            __meta_rt_array_attach(&array, &copy);
+            __meta_rt_array_release(&copy);
+        }
+        for (auto& thread: threads)
+            thread.join();
+        EXPECT_EQ(__meta_rt_array_usecount(&array), 1u);
+        __meta_rt_array_release(&array);
+        // Allocation lets the owner to free blocks released by other threads
+        MArray next{};
+        ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 16, &next));
+        __meta_rt_array_release(&next);
+    }
+}
+
+// Threads writing to their references of a shared array get private copies
+TEST(Runtime, copyOnWriteShared) {
+    constexpr int threadsCount = 4;
+    MArray array{};
+    ASSERT_TRUE(__meta_rt_array_malloc(sizeof(int), 64, &array));
+    array.count = 64;
+    std::memset(array.data, 0, 64*sizeof(int));
+    std::vector<MArray> passed(threadsCount);
+    for (MArray& copy: passed)
+        __meta_rt_array_attach(&array, &copy);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadsCount; ++thread) {
+        threads.emplace_back([&passed, thread] {
+            MArray& own = passed[thread];
+            for (int pos = 0; pos < 64; ++pos) {
+                ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &own));
+                static_cast<int*>(own.data)[pos] = thread + 1;
+            }
+            for (int pos = 0; pos < 64; ++pos)
+                ASSERT_EQ(static_cast<int*>(own.data)[pos], thread + 1);
+            __meta_rt_array_release(&own);
+        });
+    }
+    for (int pos = 0; pos < 64; ++pos)
+        EXPECT_EQ(static_cast<int*>(array.data)[pos], 0);
+    for (auto& thread: threads)
+        thread.join();
+    __meta_rt_array_release(&array);
+}
+
+#endif
+
+} // anonymous namespace
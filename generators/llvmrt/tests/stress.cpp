@@ -0,0 +1,233 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/**
+ * Multithreaded stress tests of the meta-rt reference counting: references and arrays are passed
+ * between threads the way generated code does it. Checks are the same for every reference counting
+ * mode, run them with the runtime built with -DMETA_RT_SANITIZER=thread to catch data races.
+ */
+
+struct MArray {
+    void* cb;
+    void* data;
+    uint32_t count;
+};
+
+struct MString {
+    void* cb;
+    const char* data;
+    uint32_t size;
+};
+
+extern "C" {
+
+bool __meta_rt_array_malloc(uint32_t elem_sz, uint32_t elems_max, MArray* dest);
+void __meta_rt_array_release(MArray* dest);
+void __meta_rt_array_attach(const MArray* target, MArray* dest);
+uint32_t __meta_rt_array_usecount(MArray* dest);
+bool __meta_rt_array_unique(uint32_t elem_sz, MArray* dest);
+bool __meta_rt_string_array_malloc(uint32_t elems_max, MArray* dest);
+
+bool __meta_rt_string_concat(const MString* lhs, const MString* rhs, MString* dest);
+void __meta_rt_string_release(MString* str);
+void __meta_rt_string_attach(const MString* target, MString* dest);
+uint32_t __meta_rt_string_usecount(const MString* str);
+
+}
+
+namespace {
+
+constexpr int threadsCount = 8;
+constexpr int iterations = 20000;
+
+/// Arrays passed from one thread to another
+class Exchange {
+public:
+    void put(const MArray& array) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mArrays.push_back(array);
+    }
+
+    bool take(MArray& array) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mArrays.empty())
+            return false;
+        array = mArrays.front();
+        mArrays.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mMutex;
+    std::deque<MArray> mArrays;
+};
+
+template<typename F>
+void runThreads(F&& func) {
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadsCount; ++thread)
+        threads.emplace_back([&func, thread] {func(thread);});
+    for (auto& thread: threads)
+        thread.join();
+}
+
+MArray pattern(uint32_t count, int seed) {
+    MArray res{nullptr, nullptr, 0};
+    EXPECT_TRUE(__meta_rt_array_malloc(sizeof(int), count, &res));
+    res.count = count;
+    for (uint32_t pos = 0; pos < count; ++pos)
+        static_cast<int*>(res.data)[pos] = seed + static_cast<int>(pos);
+    return res;
+}
+
+bool hasPattern(const MArray& array, int seed) {
+    for (uint32_t pos = 0; pos < array.count; ++pos) {
+        if (static_cast<const int*>(array.data)[pos] != seed + static_cast<int>(pos))
+            return false;
+    }
+    return true;
+}
+
+// References to a single array are created, passed to other threads and released there
+TEST(RuntimeStress, attachReleaseStorm) {
+    MArray shared = pattern(64, 0);
+    Exchange exchange;
+    runThreads([&shared, &exchange](int thread) {
+        std::vector<MArray> own;
+        for (int i = 0; i < iterations; ++i) {
+            MArray copy;
+            __meta_rt_array_attach(&shared, &copy);
+            // Some references are released by the thread which created them, others go to the exchange
+            if ((i + thread)%3 == 0)
+                exchange.put(copy);
+            else
+                own.push_back(copy);
+            if (own.size() > 16) {
+                __meta_rt_array_release(&own.front());
+                own.erase(own.begin());
+            }
+            MArray passed;
+            if (i%2 == 0 && exchange.take(passed)) {
+                ASSERT_EQ(passed.data, shared.data);
+                __meta_rt_array_release(&passed);
+            }
+        }
+        for (MArray& copy: own)
+            __meta_rt_array_release(&copy);
+    });
+    MArray passed;
+    while (exchange.take(passed))
+        __meta_rt_array_release(&passed);
+    EXPECT_EQ(__meta_rt_array_usecount(&shared), 1u);
+    EXPECT_TRUE(hasPattern(shared, 0));
+    __meta_rt_array_release(&shared);
+}
+
+// Arrays are allocated by one thread and freed by another one which keeps allocating as well
+TEST(RuntimeStress, allocationChurn) {
+    Exchange exchange;
+    std::atomic<int> received{0};
+    runThreads([&exchange, &received](int thread) {
+        for (int i = 0; i < iterations; ++i) {
+            const uint32_t count = 1 + static_cast<uint32_t>(i*7919 + thread)%700;
+            exchange.put(pattern(count, thread*iterations + i));
+            MArray array;
+            if (!exchange.take(array))
+                continue;
+            ASSERT_TRUE(hasPattern(array, static_cast<int*>(array.data)[0]));
+            __meta_rt_array_release(&array);
+            ++received;
+        }
+    });
+    MArray array;
+    while (exchange.take(array)) {
+        EXPECT_TRUE(hasPattern(array, static_cast<int*>(array.data)[0]));
+        __meta_rt_array_release(&array);
+        ++received;
+    }
+    EXPECT_EQ(received.load(), threadsCount*iterations);
+}
+
+// Writers get private copies while readers keep attaching the original
+TEST(RuntimeStress, copyOnWriteStorm) {
+    MArray shared = pattern(32, 100);
+    runThreads([&shared](int thread) {
+        for (int i = 0; i < iterations/10; ++i) {
+            MArray copy;
+            __meta_rt_array_attach(&shared, &copy);
+            if (thread%2 == 0) {
+                ASSERT_TRUE(hasPattern(copy, 100));
+            } else {
+                ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &copy));
+                ASSERT_NE(copy.data, shared.data);
+                static_cast<int*>(copy.data)[i%32] = -1;
+                // The copy is unique now and is written in place
+                void* data = copy.data;
+                ASSERT_TRUE(__meta_rt_array_unique(sizeof(int), &copy));
+                ASSERT_EQ(copy.data, data);
+            }
+            __meta_rt_array_release(&copy);
+        }
+    });
+    EXPECT_EQ(__meta_rt_array_usecount(&shared), 1u);
+    EXPECT_TRUE(hasPattern(shared, 100));
+    __meta_rt_array_release(&shared);
+}
+
+// Heap strings shared by the string arrays released in different threads
+TEST(RuntimeStress, stringArraysStorm) {
+    const MString part{nullptr, "shared heap allocated string", 28};
+    MString str{nullptr, nullptr, 0};
+    ASSERT_TRUE(__meta_rt_string_concat(&part, &part, &str));
+    Exchange exchange;
+    runThreads([&str, &exchange](int) {
+        for (int i = 0; i < iterations/10; ++i) {
+            MArray array{nullptr, nullptr, 0};
+            ASSERT_TRUE(__meta_rt_string_array_malloc(4, &array));
+            array.count = 4;
+            MString* elements = static_cast<MString*>(array.data);
+            for (uint32_t pos = 0; pos < array.count; ++pos)
+                __meta_rt_string_attach(&str, &elements[pos]);
+            exchange.put(array);
+            MArray passed;
+            if (exchange.take(passed)) {
+                const MString* received = static_cast<const MString*>(passed.data);
+                ASSERT_EQ(std::memcmp(received[3].data, str.data, str.size), 0);
+                __meta_rt_array_release(&passed);
+            }
+        }
+    });
+    MArray passed;
+    while (exchange.take(passed))
+        __meta_rt_array_release(&passed);
+    EXPECT_EQ(__meta_rt_string_usecount(&str), 1u);
+    __meta_rt_string_release(&str);
+}
+
+} // anonymous namespace
@@ -19,6 +19,10 @@
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <map>
+#include <set>
+#include <memory>
+#include <system_error>
 #include <vector>
 
 #include <boost/program_options.hpp>
@@ -29,15 +33,28 @@
 
 #include "parser/metaparser.h"
 #include "parser/nodeexception.h"
+#include "parser/sourcefile.h"
 
 #include "analysers/actions.h"
+#include "analysers/attributes.h"
+#include "analysers/constfolder.h"
+#include "analysers/escapeanalysis.h"
 #include "analysers/metaprocessor.h"
+#include "analysers/rangeanalysis.h"
 #include "analysers/reachabilitychecker.h"
 #include "analysers/resolver.h"
 #include "analysers/semanticerror.h"
 
+#include "cache/compilecache.h"
+#include "cache/incremental.h"
+#include "cache/sourcecache.h"
+
 #include "generators/llvmgen/generator.h"
 
+#include "modules/modulefile.h"
+
+#include "server/server.h"
+
 using namespace meta;
 
 enum class ErrorVerbosity {
@@ -52,7 +69,15 @@ struct Options {
     ErrorVerbosity verbosity = ErrorVerbosity::expectedTerms;
     utils::fs::path output;
     utils::fs::path outputHeader;
+    utils::fs::path cacheDir;
+    utils::fs::path serverSocket;
+    utils::fs::path connectSocket;
+    utils::fs::path emitModule;
+    std::vector<utils::fs::path> modules;
     std::vector<utils::fs::path> sources;
+    generators::GeneratorOptions generator;
+    bool link = false;
+    bool stats = false;
 };
 
 namespace po = boost::program_options;
@@ -76,17 +101,50 @@ std::istream& operator>> (std::istream& in, ErrorVerbosity& verbosity) {
 }
 
 namespace meta {
-bool main(const Options &opts);
-}
 
-int main(int argc, char **argv) try {
-    Options opts;
+/// State reused between compilations performed by the same process
+struct Session {
+    std::unique_ptr<generators::Generator> generator = generators::llvmgen::createLlvmGenerator();
+    cache::SourceCache sources;
+    std::map<utils::fs::path, std::unique_ptr<cache::CompileCache>> caches;
+
+    cache::CompileCache& compileCache(const utils::fs::path& dir) {
+        auto& res = caches[dir];
+        if (!res)
+            res = std::make_unique<cache::CompileCache>(dir);
+        return *res;
+    }
+};
+
+bool main(const Options &opts, Session& session, std::ostream& out);
+bool serve(const Options &opts);
+
+} // namespace meta
+
+enum class ParseResult {
+    run,
+    success,
+    failure
+};
+
+ParseResult parseOptions(int argc, const char* const* argv, Options& opts, std::ostream& out) {
     po::options_description desc("Command line options");
     desc.add_options()
         ("help,h", "Show help")
         ("version,v", "Show version")
         ("output,o", po::value<utils::fs::path>(&opts.output), "Specify output file path")
         ("output-header,H", po::value<utils::fs::path>(&opts.outputHeader), "Specify output header file path")
+        ("cache-dir", po::value<utils::fs::path>(&opts.cacheDir), "Reuse results of previous compilations stored in the directory")
+        ("server", po::value<utils::fs::path>(&opts.serverSocket), "Run compile server listening on the unix socket")
+        ("connect", po::value<utils::fs::path>(&opts.connectSocket), "Pass compilation to the compile server listening on the unix socket")
+        ("emit-module", po::value<utils::fs::path>(&opts.emitModule), "Write interface of the compiled package into the module file")
+        ("module,m", po::value<std::vector<utils::fs::path>>(&opts.modules), "Use declarations from the module file instead of the package sources")
+        ("debug,g", po::bool_switch(&opts.generator.debugInfo), "Emit debug information")
+        ("profile-generate", po::bool_switch(&opts.generator.profileGenerate), "Instrument generated code to collect execution counters")
+        ("profile-use", po::value<utils::fs::path>(&opts.generator.profileUse), "Optimize generated code using execution counters merged into the .profdata file")
+        ("thinlto", po::bool_switch(&opts.generator.thinLTO), "Emit ThinLTO summaries and inline across packages when linking")
+        ("link", po::bool_switch(&opts.link), "Link bitcode files produced by meta instead of compiling sources")
+        ("stats", po::bool_switch(&opts.stats), "Print statistics of the optimizations performed by analysers")
         ("verbosity", po::value<ErrorVerbosity>(&opts.verbosity), "Error description verbosity: silent, brief, lineMarked, expectedTerms(default), parserStack")
         ("src", po::value<std::vector<utils::fs::path>>(&opts.sources), "Sources to compile")
     ;
@@ -98,53 +156,121 @@ int main(int argc, char **argv) try {
         po::store(parseRes, vm);
         po::notify(vm);
         if (vm.count("help") != 0) {
-            std::cout << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
-            std::cout << desc << std::endl;
-            return EXIT_SUCCESS;
+            out << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
+            out << "       " << argv[0] << " --server SOCKET --cache-dir DIR" << std::endl;
+            out << "       " << argv[0] << " --link [options] -o OUTPUT BITCODE_FILE..." << std::endl;
+            out << desc << std::endl;
+            return ParseResult::success;
         } else if (vm.count("version") != 0) {
-            std::cout << "0.0.0" << std::endl; /// TODO: extract version from git tags
-            return EXIT_SUCCESS;
+            out << "0.0.0" << std::endl; /// TODO: extract version from git tags
+            return ParseResult::success;
+        }
+        if (!opts.serverSocket.empty()) {
+            if (opts.cacheDir.empty()) {
+                out << "Error: compile server requires cache directory" << std::endl;
+                out << "Ussage: " << argv[0] << " --server SOCKET --cache-dir DIR" << std::endl;
+                return ParseResult::failure;
+            }
+            return ParseResult::run;
         }
         if (opts.output.empty())  {
-            std::cerr << "Error: output is not specified" << std::endl;
-            std::cerr << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
-            return EXIT_FAILURE;
+            out << "Error: output is not specified" << std::endl;
+            out << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
+            return ParseResult::failure;
         }
         if (opts.sources.empty()) {
-            std::cerr << "Error: no source files specified" << std::endl;
-            std::cerr << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
-            return EXIT_FAILURE;
+            out << "Error: no source files specified" << std::endl;
+            out << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
+            return ParseResult::failure;
+        }
+        if (opts.generator.profileGenerate && !opts.generator.profileUse.empty()) {
+            out << "Error: profile can't be used by instrumented code" << std::endl;
+            return ParseResult::failure;
+        }
+        if (opts.link && (!opts.cacheDir.empty() || !opts.emitModule.empty() || !opts.modules.empty())) {
+            out << "Error: link mode accepts bitcode files only" << std::endl;
+            return ParseResult::failure;
+        }
+        if (!opts.cacheDir.empty() && (!opts.emitModule.empty() || !opts.modules.empty())) {
+            out << "Error: module files can't be used with compilation cache" << std::endl;
+            return ParseResult::failure;
+        }
+        // Packages reused from the cache are not analysed so their statistics is unknown
+        if (!opts.cacheDir.empty() && opts.stats) {
+            out << "Error: statistics can't be collected with compilation cache" << std::endl;
+            return ParseResult::failure;
         }
     } catch(std::exception &err) {
-        std::cerr << "Error: " << err.what() << std::endl;
-        std::cerr << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
-        std::cerr << desc << std::endl;
-        return EXIT_FAILURE;
+        out << "Error: " << err.what() << std::endl;
+        out << "Ussage: " << argv[0] << " [options] -o OUTPUT SRC_FILE..." << std::endl;
+        out << desc << std::endl;
+        return ParseResult::failure;
     }
-    return meta::main(opts) ? EXIT_SUCCESS : EXIT_FAILURE;
-} catch(const NodeException& err) {
-    std::cerr <<
+    return ParseResult::run;
+}
+
+void reportInternalError(const NodeException& err, std::ostream& out) {
+    out <<
         err.sourcePath().string() << ':' << err.tokens().begin()->line <<
         ':' << err.tokens().begin()->column << ": Internal compiler error: " << err.what() <<
         ":" << std::endl
     ;
-    std::cerr << err.tokens().lineStr() << "..." << std::endl;
+    out << err.tokens().lineStr() << "..." << std::endl;
     for (int i = 1; i < err.tokens().colnum(); ++i)
-        std::cerr << ' ';
-    std::cerr << '^' << std::endl;
+        out << ' ';
+    out << '^' << std::endl;
     for (const auto &frame: err.backtrace())
-        std::cerr << "\t" << frame << std::endl;
+        out << "\t" << frame << std::endl;
+}
+
+void reportInternalError(const utils::Exception& err, std::ostream& out) {
+    out << "Internal compiler error: " << err.what() << std::endl;
+    for (const auto &frame: err.backtrace())
+        out << "\t" << frame << std::endl;
+}
+
+int main(int argc, char **argv) try {
+    Options opts;
+    switch (parseOptions(argc, argv, opts, std::cout)) {
+    case ParseResult::success: return EXIT_SUCCESS;
+    case ParseResult::failure: return EXIT_FAILURE;
+    case ParseResult::run: break;
+    }
+    if (!opts.serverSocket.empty())
+        return meta::serve(opts) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (!opts.connectSocket.empty()) {
+        const std::vector<std::string> args{argv + 1, argv + argc};
+        return server::request(opts.connectSocket, args, std::cerr) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    Session session;
+    return meta::main(opts, session, std::cerr) ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch(const NodeException& err) {
+    reportInternalError(err, std::cerr);
     return EXIT_FAILURE;
 } catch(const utils::Exception &err) {
-    std::cerr << "Internal compiler error: " << err.what() << std::endl;
-    for (const auto &frame: err.backtrace())
-        std::cerr << "\t" << frame << std::endl;
+    reportInternalError(err, std::cerr);
+    return EXIT_FAILURE;
+} catch(const std::system_error &err) {
+    // compile server socket failures
+    std::cerr << "Error: " << err.what() << std::endl;
     return EXIT_FAILURE;
 }
 
 namespace meta {
 
-bool main(const Options &opts) try {
+bool main(const Options &opts, Session& session, std::ostream& out) try {
+    session.generator->setOptions(opts.generator);
+    if (opts.link) {
+        session.generator->link(opts.sources, opts.output);
+        return true;
+    }
+    if (!opts.cacheDir.empty()) {
+        cache::buildIncremental(
+            opts.sources, session.sources, session.compileCache(opts.cacheDir), *session.generator,
+            opts.output
+        );
+        return true;
+    }
     // parse
     std::vector<utils::SourceFile> sources;
     sources.reserve(opts.sources.size());
@@ -157,47 +283,132 @@ bool main(const Options &opts) try {
         parser.parse(sources.back());
     }
     auto ast = parser.ast();
+    std::vector<std::unique_ptr<modules::Module>> loadedModules;
+    for (const auto& modpath: opts.modules) {
+        loadedModules.push_back(std::make_unique<modules::Module>(modpath));
+        loadedModules.back()->load(act.dictionary());
+    }
     // analyse
     analysers::resolve(ast, act.dictionary());
+    analysers::foldConstants(ast);
     analysers::checkReachability(ast);
     analysers::processMeta(ast);
+    analysers::inferAttributes(ast);
+    analysers::eliminateBoundsChecks(ast);
+    const size_t stackArrays = analysers::allocateArraysOnStack(ast);
+    if (opts.stats)
+        out << "Array allocations moved to the stack: " << stackArrays << std::endl;
     // generate
-    generators::llvmgen::createLlvmGenerator()->generate(ast, opts.output);
+    if (opts.emitModule.empty()) {
+        session.generator->generate(ast, opts.output);
+        return true;
+    }
+    std::set<utils::string_view> packages;
+    walk<SourceFile, TopDown>(*ast, [&packages](SourceFile* node) {
+        packages.insert(node->package());
+        return false;
+    });
+    if (packages.size() != 1) {
+        out << "Error: module file can be emitted for a single package only" << std::endl;
+        return false;
+    }
+    // Non private functions must stay callable by the packages using the module
+    session.generator->generate(ast, *packages.begin(), opts.output);
+    modules::writeModule(act.dictionary(), *packages.begin(), opts.emitModule);
 
     return true;
 } catch(const SyntaxError &err) {
     if (opts.verbosity > ErrorVerbosity::silent) {
-        std::cerr <<
+        out <<
             err.sourcePath().string() << ':' << err.token().line << ':' <<
             err.token().column << ": " << err.what()
         ;
     }
     if (opts.verbosity == ErrorVerbosity::brief)
-        std::cerr << std::endl;
+        out << std::endl;
     if (opts.verbosity > ErrorVerbosity::brief) {
-        std::cerr << ':' << std::endl;
-        std::cerr << err.line() << std::endl;
+        out << ':' << std::endl;
+        out << err.line() << std::endl;
     }
     if (opts.verbosity > ErrorVerbosity::lineMarked)
-        std::cerr << "Expected one of the following terms:" << std::endl << err.expected();
+        out << "Expected one of the following terms:" << std::endl << err.expected();
     if (opts.verbosity > ErrorVerbosity::expectedTerms)
-        std::cerr << "Parser stack dump:" << std::endl << err.parserStack();
+        out << "Parser stack dump:" << std::endl << err.parserStack();
 
     return false;
 } catch(const analysers::SemanticError &err) {
     if (opts.verbosity > ErrorVerbosity::silent)
-        std::cerr <<
+        out <<
             err.sourcePath().string() << ':' << err.tokens().begin()->line <<
             ':' << err.tokens().begin()->column << ": " << err.what() <<
             (opts.verbosity == ErrorVerbosity::brief ? "" : ":") << std::endl
         ;
     if (opts.verbosity > ErrorVerbosity::brief) {
-        std::cerr << err.tokens().lineStr() << "..." << std::endl;
+        out << err.tokens().lineStr() << "..." << std::endl;
         for (int i = 1; i < err.tokens().colnum(); ++i)
-            std::cerr << ' ';
-        std::cerr << '^' << std::endl;
+            out << ' ';
+        out << '^' << std::endl;
     }
     return false;
+} catch(const modules::ModuleFileError &err) {
+    out << "Error: " << err.what() << std::endl;
+    return false;
+}
+
+bool serve(const Options &opts) {
+    Session session;
+    server::serve(opts.serverSocket, [&session, &opts](
+        const utils::fs::path& cwd, const std::vector<std::string>& args, std::ostream& out
+    ) {
+        std::vector<const char*> argv{"meta"};
+        for (const auto& arg: args)
+            argv.push_back(arg.c_str());
+        Options reqOpts;
+        switch (parseOptions(static_cast<int>(argv.size()), argv.data(), reqOpts, out)) {
+        case ParseResult::success: return true;
+        case ParseResult::failure: return false;
+        case ParseResult::run: break;
+        }
+        if (!reqOpts.serverSocket.empty()) {
+            out << "Error: compile server can't start another server" << std::endl;
+            return false;
+        }
+        // Paths are relative to the client working directory
+        const auto absolute = [&cwd](utils::fs::path& path) {
+            if (!path.empty())
+                path = utils::fs::absolute(path, cwd);
+        };
+        absolute(reqOpts.output);
+        absolute(reqOpts.outputHeader);
+        absolute(reqOpts.cacheDir);
+        absolute(reqOpts.emitModule);
+        absolute(reqOpts.generator.profileUse);
+        for (auto& mod: reqOpts.modules)
+            absolute(mod);
+        for (auto& src: reqOpts.sources)
+            absolute(src);
+        if (reqOpts.cacheDir.empty())
+            reqOpts.cacheDir = opts.cacheDir;
+        // Server always compiles with the cache so the options incompatible with it are rejected
+        // even if the cache directory is not passed by the client
+        if (!reqOpts.link && (!reqOpts.emitModule.empty() || !reqOpts.modules.empty())) {
+            out << "Error: module files can't be used with compile server" << std::endl;
+            return false;
+        }
+        if (!reqOpts.link && reqOpts.stats) {
+            out << "Error: statistics can't be collected by compile server" << std::endl;
+            return false;
+        }
+        try {
+            return main(reqOpts, session, out);
+        } catch(const NodeException& err) {
+            reportInternalError(err, out);
+        } catch(const utils::Exception &err) {
+            reportInternalError(err, out);
+        }
+        return false;
+    });
+    return true;
 }
 
 } // namespace meta
@@ -0,0 +1,112 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace meta::modules::format {
+
+/**
+ * Module file layout. All integers are in the host byte order, all records are 4 bytes aligned
+ * so that they can be accessed directly in the memory mapped file:
+ *
+ *     Header
+ *     Function[header.funcCount]
+ *     Struct[header.structCount]
+ *     Var[header.varCount]       // function arguments and struct members
+ *     char[header.stringsSize]   // string table referenced with StrRef
+ *
+ * Every string in the string table is followed by '\n' so that diagnostics printing the line
+ * of a token never reads past the string.
+ */
+
+constexpr char magic[8] = {'M', 'E', 'T', 'A', 'M', 'O', 'D', '\0'};
+constexpr uint32_t version = 2;
+
+struct StrRef {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    StrRef package;
+    uint32_t funcCount;
+    uint32_t structCount;
+    uint32_t varCount;
+    uint32_t stringsSize;
+};
+
+enum FuncFlags: uint8_t {
+    customSymbol = 1 << 0,
+    pure = 1 << 1,
+    noRecurse = 1 << 2,
+    cold = 1 << 3
+};
+
+struct Function {
+    StrRef name;
+    StrRef retType;
+    StrRef symbol;
+    uint8_t visibility;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t firstArg;
+    uint32_t argCount;
+};
+
+enum StructFlags: uint8_t {
+    packed = 1 << 0,
+    reordered = 1 << 1,
+    soa = 1 << 2
+};
+
+struct Struct {
+    StrRef name;
+    uint8_t visibility;
+    uint8_t flags;
+    /// Alignment requested by @align or 0
+    uint16_t alignment;
+    uint32_t firstMember;
+    uint32_t memberCount;
+};
+
+enum class InitKind: uint8_t {
+    none,
+    number,
+    boolean
+};
+
+struct Var {
+    StrRef name;
+    StrRef type;
+    /// Source text of the default value
+    StrRef initText;
+    InitKind init;
+    uint8_t reserved[3];
+    int32_t value;
+};
+
+static_assert(sizeof(Header) % 4 == 0, "Module file records must be 4 bytes aligned");
+static_assert(sizeof(Function) % 4 == 0, "Module file records must be 4 bytes aligned");
+static_assert(sizeof(Struct) % 4 == 0, "Module file records must be 4 bytes aligned");
+static_assert(sizeof(Var) % 4 == 0, "Module file records must be 4 bytes aligned");
+
+} // namespace meta::modules::format
@@ -0,0 +1 @@
+#include "modulefile.hpp"
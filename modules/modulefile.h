@@ -0,0 +1,117 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "utils/exception.h"
+#include "utils/sourcefile.h"
+#include "utils/types.h"
+
+#include "parser/metaparser.h"
+
+#include "analysers/dictionary.h"
+
+#include "modules/format.h"
+
+namespace meta::modules {
+
+class ModuleFileError: public utils::Exception {
+public:
+    ModuleFileError(const utils::fs::path& path, const char* msg):
+        utils::Exception(utils::captureBacktrace()),
+        mMsg(path.string() + ": " + msg)
+    {}
+
+    template<typename... A>
+    ModuleFileError(const utils::fs::path& path, const char* fmt, A&& ...a):
+        utils::Exception(utils::captureBacktrace()),
+        mMsg(path.string() + ": " + str((boost::format(fmt) % ... % std::forward<A>(a))))
+    {}
+    const char* what() const noexcept override {return mMsg.c_str();}
+
+private:
+    std::string mMsg;
+};
+
+/**
+ * Writes compact binary interface of the package: its non private functions and structs with
+ * resolved types and custom symbol names. Must be called after resolve and constant folding.
+ *
+ * Default argument values must be compile time constants.
+ */
+void writeModule(const Dictionary& dict, utils::string_view package, const utils::fs::path& path);
+
+/**
+ * Memory mapped module file.
+ *
+ * Declarations loaded from the module reference mapped memory so the module object must outlive
+ * everything which uses the dictionary it was loaded into.
+ */
+class Module {
+public:
+    explicit Module(const utils::fs::path& path);
+
+    Module(const Module&) = delete;
+    Module& operator= (const Module&) = delete;
+
+    utils::string_view package() const;
+
+    /// Adds declarations from the module into the dictionary as declarations without body
+    void load(Dictionary& dict);
+
+private:
+    /// Read only mapping of the whole file unmapped on destruction
+    class Mapping {
+    public:
+        Mapping() = default;
+        Mapping(const char* data, size_t size): mData(data), mSize(size) {}
+        Mapping(Mapping&& rhs): mData(rhs.mData), mSize(rhs.mSize) {rhs.mData = nullptr;}
+        Mapping& operator= (Mapping&& rhs);
+        Mapping(const Mapping&) = delete;
+        Mapping& operator= (const Mapping&) = delete;
+        ~Mapping();
+
+        const char* data() const {return mData;}
+        size_t size() const {return mSize;}
+
+    private:
+        const char* mData = nullptr;
+        size_t mSize = 0;
+    };
+
+    template<typename T>
+    const T* records(size_t offset, size_t count) const;
+    utils::string_view str(const format::StrRef& ref) const;
+    Visibility visibility(uint8_t val, utils::string_view name) const;
+    TokenSequence tokens(utils::string_view str) const;
+    Node::Ptr<VarDecl> var(const format::Var& rec);
+
+private:
+    utils::SourceFile mSource;
+    Mapping mMapping;
+    /// Declarations reference mapped memory so they are destroyed before the mapping
+    std::vector<Node::Ptr<Declaration>> mDecls;
+};
+
+} // namespace meta::modules
@@ -0,0 +1,350 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/contract.h"
+#include "utils/io.h"
+
+#include "parser/function.h"
+#include "parser/literal.h"
+#include "parser/number.h"
+#include "parser/struct.h"
+#include "parser/vardecl.h"
+
+#include "modules/format.h"
+#include "modules/modulefile.h"
+
+namespace meta::modules {
+namespace {
+
+class Writer {
+public:
+    explicit Writer(const utils::fs::path& path): mPath(path) {}
+
+    format::StrRef add(utils::string_view str) {
+        format::StrRef res{static_cast<uint32_t>(mStrings.size()), static_cast<uint32_t>(str.size())};
+        mStrings.append(str.begin(), str.end());
+        mStrings.push_back('\n');
+        return res;
+    }
+
+    void addFunction(Function* func) {
+        PRECONDITION(func->type());
+        format::Function rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.name = add(func->name());
+        rec.retType = add(func->type()->name());
+        if (func->mangledName()) {
+            rec.flags |= format::customSymbol;
+            rec.symbol = add(*func->mangledName());
+        }
+        if (func->flags() & FuncFlags::pure)
+            rec.flags |= format::pure;
+        if (func->flags() & FuncFlags::noRecurse)
+            rec.flags |= format::noRecurse;
+        if (func->flags() & FuncFlags::cold)
+            rec.flags |= format::cold;
+        rec.visibility = static_cast<uint8_t>(func->visibility());
+        rec.firstArg = static_cast<uint32_t>(mVars.size());
+        rec.argCount = static_cast<uint32_t>(func->args().size());
+        for (const auto& arg: func->args())
+            addVar(func, arg);
+        mFuncs.push_back(rec);
+    }
+
+    void addStruct(Struct* strct) {
+        format::Struct rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.name = add(strct->name());
+        rec.visibility = static_cast<uint8_t>(strct->visibility());
+        // Layout is a part of the interface: values are passed between packages
+        if (strct->packed())
+            rec.flags |= format::packed;
+        if (strct->reordered())
+            rec.flags |= format::reordered;
+        if (strct->soa())
+            rec.flags |= format::soa;
+        rec.alignment = static_cast<uint16_t>(strct->requestedAlignment());
+        rec.firstMember = static_cast<uint32_t>(mVars.size());
+        rec.memberCount = static_cast<uint32_t>(strct->members().size());
+        for (const auto& member: strct->members())
+            addVar(strct, member);
+        mStructs.push_back(rec);
+    }
+
+    void save(utils::string_view package) {
+        format::Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, format::magic, sizeof(header.magic));
+        header.version = format::version;
+        header.package = add(package);
+        header.funcCount = static_cast<uint32_t>(mFuncs.size());
+        header.structCount = static_cast<uint32_t>(mStructs.size());
+        header.varCount = static_cast<uint32_t>(mVars.size());
+        header.stringsSize = static_cast<uint32_t>(mStrings.size());
+
+        auto out = utils::open<utils::IO::out>(mPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        write(out, &header, 1);
+        write(out, mFuncs.data(), mFuncs.size());
+        write(out, mStructs.data(), mStructs.size());
+        write(out, mVars.data(), mVars.size());
+        out.write(mStrings.data(), mStrings.size());
+        if (!out)
+            throw std::system_error(errno, std::system_category(), mPath.string());
+    }
+
+private:
+    template<typename T>
+    static void write(std::ostream& out, const T* records, size_t count) {
+        out.write(reinterpret_cast<const char*>(records), sizeof(T)*count);
+    }
+
+    void addVar(Declaration* owner, VarDecl* var) {
+        struct {
+            bool operator() (Node*, format::Var&) {return false;}
+            bool operator() (Number* node, format::Var& rec) {
+                rec.init = format::InitKind::number;
+                rec.value = node->value();
+                return true;
+            }
+            bool operator() (Literal* node, format::Var& rec) {
+                rec.init = format::InitKind::boolean;
+                rec.value = node->value() == Literal::trueVal ? 1 : 0;
+                return true;
+            }
+        } initValue;
+
+        format::Var rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.name = add(var->name());
+        rec.type = add(var->type() ? var->type()->name() : var->typeName());
+        rec.init = format::InitKind::none;
+        if (var->inited()) {
+            if (!dispatch(initValue, var->initExpr(), rec))
+                throw ModuleFileError(
+                    mPath, "Default value of '%s' in '%s' is not a compile time constant",
+                    var->name(), owner->name()
+                );
+            rec.initText = add(var->initExpr()->tokens());
+        }
+        mVars.push_back(rec);
+    }
+
+private:
+    utils::fs::path mPath;
+    std::vector<format::Function> mFuncs;
+    std::vector<format::Struct> mStructs;
+    std::vector<format::Var> mVars;
+    std::string mStrings;
+};
+
+} // anonymous namespace
+
+void writeModule(const Dictionary& dict, utils::string_view package, const utils::fs::path& path) {
+    Writer writer{path};
+    auto it = dict.find(package);
+    if (it != dict.end()) {
+        for (Function* func: it->second.functions) {
+            // entrypoint is called by the program loader only
+            if (func->visibility() != Visibility::Private && !(func->flags() & FuncFlags::entrypoint))
+                writer.addFunction(func);
+        }
+        for (Struct* strct: it->second.structs) {
+            if (strct->visibility() != Visibility::Private)
+                writer.addStruct(strct);
+        }
+    }
+    writer.save(package);
+}
+
+Module::Module(const utils::fs::path& path): mSource(path, {}) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), path.string());
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::system_category(), path.string());
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size < sizeof(format::Header)) {
+        ::close(fd);
+        throw ModuleFileError(path, "file is too short");
+    }
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int err = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+        throw std::system_error(err, std::system_category(), path.string());
+    mMapping = Mapping{static_cast<const char*>(data), size};
+
+    const auto& header = *records<format::Header>(0, 1);
+    if (std::memcmp(header.magic, format::magic, sizeof(format::magic)) != 0)
+        throw ModuleFileError(path, "not a meta module file");
+    if (header.version != format::version)
+        throw ModuleFileError(path, "unsupported module file version %u", header.version);
+    const uint64_t expectedSize =
+        sizeof(format::Header) +
+        uint64_t{header.funcCount}*sizeof(format::Function) +
+        uint64_t{header.structCount}*sizeof(format::Struct) +
+        uint64_t{header.varCount}*sizeof(format::Var) +
+        header.stringsSize
+    ;
+    if (expectedSize != mMapping.size())
+        throw ModuleFileError(path, "file size doesn't match its header");
+}
+
+Module::Mapping& Module::Mapping::operator= (Mapping&& rhs) {
+    if (this == &rhs)
+        return *this;
+    if (mData)
+        ::munmap(const_cast<char*>(mData), mSize);
+    mData = rhs.mData;
+    mSize = rhs.mSize;
+    rhs.mData = nullptr;
+    return *this;
+}
+
+Module::Mapping::~Mapping() {
+    if (mData)
+        ::munmap(const_cast<char*>(mData), mSize);
+}
+
+utils::string_view Module::package() const {
+    return str(records<format::Header>(0, 1)->package);
+}
+
+template<typename T>
+const T* Module::records(size_t offset, size_t count) const {
+    if (offset + sizeof(T)*count > mMapping.size())
+        throw ModuleFileError(mSource.path(), "record is out of file bounds");
+    return reinterpret_cast<const T*>(mMapping.data() + offset);
+}
+
+utils::string_view Module::str(const format::StrRef& ref) const {
+    const auto& header = *records<format::Header>(0, 1);
+    if (uint64_t{ref.offset} + ref.size >= header.stringsSize)
+        throw ModuleFileError(mSource.path(), "string is out of string table bounds");
+    return {mMapping.data() + mMapping.size() - header.stringsSize + ref.offset, ref.size};
+}
+
+Visibility Module::visibility(uint8_t val, utils::string_view name) const {
+    if (val > static_cast<uint8_t>(Visibility::Export))
+        throw ModuleFileError(mSource.path(), "unknown visibility of '%s'", name);
+    return static_cast<Visibility>(val);
+}
+
+TokenSequence Module::tokens(utils::string_view str) const {
+    Token token;
+    token.start = str.data();
+    token.end = str.data() + str.size();
+    token.line = 1;
+    token.column = 1;
+    return token;
+}
+
+Node::Ptr<VarDecl> Module::var(const format::Var& rec) {
+    const auto name = str(rec.name);
+    Node::Ptr<Expression> init;
+    switch (rec.init) {
+    case format::InitKind::none:
+        break;
+    case format::InitKind::number:
+        init = new Number(mSource, tokens(str(rec.initText)), rec.value);
+        break;
+    case format::InitKind::boolean:
+        init = new Literal(mSource, tokens(str(rec.initText)), rec.value ? Literal::trueVal : Literal::falseVal);
+        break;
+    default:
+        throw ModuleFileError(mSource.path(), "unknown default value kind of '%s'", name);
+    }
+    return new VarDecl(mSource, tokens(name), name, str(rec.type), init);
+}
+
+void Module::load(Dictionary& dict) {
+    const auto& header = *records<format::Header>(0, 1);
+    const auto pkgName = package();
+    if (dict.count(pkgName) != 0)
+        throw ModuleFileError(mSource.path(), "package '%s' is already defined by compiled sources", pkgName);
+    auto& pkg = dict[pkgName];
+
+    size_t offset = sizeof(format::Header);
+    const auto* funcs = records<format::Function>(offset, header.funcCount);
+    offset += sizeof(format::Function)*header.funcCount;
+    const auto* structs = records<format::Struct>(offset, header.structCount);
+    offset += sizeof(format::Struct)*header.structCount;
+    const auto* vars = records<format::Var>(offset, header.varCount);
+
+    const auto varRange = [&](uint32_t first, uint32_t count) {
+        if (uint64_t{first} + count > header.varCount)
+            throw ModuleFileError(mSource.path(), "variable is out of bounds");
+        std::vector<Node::Ptr<VarDecl>> res;
+        res.reserve(count);
+        for (uint32_t i = first; i < first + count; ++i)
+            res.push_back(var(vars[i]));
+        return res;
+    };
+
+    for (uint32_t i = 0; i < header.funcCount; ++i) {
+        const auto& rec = funcs[i];
+        const auto name = str(rec.name);
+        Node::Ptr<Function> func = new Function(
+            mSource, tokens(name), name, str(rec.retType), varRange(rec.firstArg, rec.argCount)
+        );
+        func->setPackage(pkgName);
+        func->setVisibility(visibility(rec.visibility, name));
+        if (rec.flags & format::customSymbol)
+            func->setMangledName(str(rec.symbol));
+        if (rec.flags & format::pure)
+            func->flags() |= FuncFlags::pure;
+        if (rec.flags & format::noRecurse)
+            func->flags() |= FuncFlags::noRecurse;
+        if (rec.flags & format::cold)
+            func->flags() |= FuncFlags::cold;
+        pkg.functions.emplace(func.get());
+        mDecls.push_back(func);
+    }
+    for (uint32_t i = 0; i < header.structCount; ++i) {
+        const auto& rec = structs[i];
+        const auto name = str(rec.name);
+        Node::Ptr<Struct> strct = new Struct(mSource, tokens(name), name, varRange(rec.firstMember, rec.memberCount));
+        strct->setPackage(pkgName);
+        strct->setVisibility(visibility(rec.visibility, name));
+        strct->setPacked(rec.flags & format::packed);
+        strct->setReordered(rec.flags & format::reordered);
+        strct->setSoa(rec.flags & format::soa);
+        strct->setRequestedAlignment(rec.alignment);
+        pkg.structs.emplace(strct.get());
+        mDecls.push_back(strct);
+    }
+}
+
+} // namespace meta::modules
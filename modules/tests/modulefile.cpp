@@ -0,0 +1,257 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstddef>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "utils/io.h"
+#include "utils/testtools.h"
+#include "utils/types.h"
+
+#include "parser/call.h"
+#include "parser/function.h"
+#include "parser/metaparser.h"
+#include "parser/number.h"
+#include "parser/struct.h"
+
+#include "analysers/actions.h"
+#include "analysers/constfolder.h"
+#include "analysers/metaprocessor.h"
+#include "analysers/resolver.h"
+
+#include "modules/modulefile.h"
+
+namespace meta::modules::tests {
+namespace {
+
+using namespace meta::analysers;
+
+class ModuleFileTest: public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = utils::fs::temp_directory_path()/("meta-module-test-" + std::to_string(::getpid()) + ".metam");
+    }
+
+    void TearDown() override {
+        utils::fs::remove(path);
+    }
+
+    void emit(utils::SourceFile src) {
+        Parser parser;
+        Actions act;
+        parser.setParseActions(&act);
+        parser.setNodeActions(&act);
+        ASSERT_PARSE(parser, src);
+        ASSERT_ANALYSE(resolve(parser.ast(), act.dictionary()));
+        ASSERT_ANALYSE(foldConstants(parser.ast()));
+        ASSERT_ANALYSE(processMeta(parser.ast()));
+        writeModule(act.dictionary(), "test.lib"sv, path);
+    }
+
+    utils::fs::path path;
+};
+
+TEST_F(ModuleFileTest, roundtrip) {
+    ASSERT_NO_FATAL_FAILURE(emit(R"META(
+        package test.lib;
+
+        public int foo(int x, int y = 2*3) {return x + y;}
+        protected auto isPositive(int x, bool strict = true) {return x > 0 && strict;}
+        int hidden() {return 5;}
+
+        public struct Point {int x; int y;}
+        struct Hidden {int x;}
+    )META"_fake_src));
+
+    Module module{path};
+    EXPECT_EQ(module.package(), "test.lib");
+    Dictionary dict;
+    module.load(dict);
+    const auto& pkg = dict["test.lib"sv];
+
+    ASSERT_EQ(pkg.functions.size(), 2u);
+    auto fooIt = pkg.functions.find("foo"sv);
+    ASSERT_NE(fooIt, pkg.functions.end());
+    Function* foo = *fooIt;
+    EXPECT_EQ(foo->package(), "test.lib");
+    EXPECT_EQ(foo->visibility(), Visibility::Public);
+    EXPECT_EQ(foo->retType(), "int");
+    EXPECT_EQ(foo->body(), nullptr);
+    ASSERT_EQ(foo->args().size(), 2u);
+    EXPECT_FALSE(foo->args()[0]->inited());
+    ASSERT_TRUE(foo->args()[1]->inited());
+    auto defVal = dynamic_cast<Number*>(foo->args()[1]->initExpr());
+    ASSERT_NE(defVal, nullptr);
+    EXPECT_EQ(defVal->value(), 6);
+
+    auto isPositiveIt = pkg.functions.find("isPositive"sv);
+    ASSERT_NE(isPositiveIt, pkg.functions.end());
+    EXPECT_EQ((*isPositiveIt)->visibility(), Visibility::Protected);
+    EXPECT_EQ((*isPositiveIt)->retType(), "bool");
+
+    ASSERT_EQ(pkg.structs.size(), 1u);
+    EXPECT_EQ((*pkg.structs.begin())->name(), "Point");
+    EXPECT_EQ((*pkg.structs.begin())->members().size(), 2u);
+}
+
+TEST_F(ModuleFileTest, callLoadedFunction) {
+    ASSERT_NO_FATAL_FAILURE(emit(R"META(
+        package test.lib;
+
+        public int foo(int x, int y = 3) {return x + y;}
+    )META"_fake_src));
+
+    const auto app = R"META(
+        package test.app;
+
+        import test.lib.foo;
+
+        int bar() {return foo(1);}
+    )META"_fake_src;
+    Module module{path};
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, app);
+    module.load(act.dictionary());
+    ASSERT_ANALYSE(resolve(parser.ast(), act.dictionary()));
+    auto calls = parser.ast()->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0]->function()->package(), "test.lib");
+    EXPECT_EQ(calls[0]->args().size(), 2u);
+}
+
+TEST_F(ModuleFileTest, structLayout) {
+    ASSERT_NO_FATAL_FAILURE(emit(R"META(
+        package test.lib;
+
+        @reorder
+        @align(16)
+        public struct Particle {bool alive; double mass; int id;}
+
+        public Particle spawn(int id) {
+            Particle res;
+            res.id = id;
+            return res;
+        }
+    )META"_fake_src));
+
+    const auto app = R"META(
+        package test.app;
+
+        import test.lib.spawn;
+
+        int bar() {return spawn(1).id;}
+    )META"_fake_src;
+    Module module{path};
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, app);
+    module.load(act.dictionary());
+    const auto& pkg = act.dictionary()["test.lib"sv];
+    ASSERT_EQ(pkg.structs.size(), 1u);
+    Struct* particle = *pkg.structs.begin();
+    EXPECT_FALSE(particle->packed());
+    EXPECT_TRUE(particle->reordered());
+    EXPECT_EQ(particle->requestedAlignment(), 16u);
+
+    ASSERT_ANALYSE(resolve(parser.ast(), act.dictionary()));
+    auto calls = parser.ast()->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(calls.size(), 1u);
+    ASSERT_TRUE(calls[0]->type());
+    EXPECT_EQ(calls[0]->type()->aggregate(), particle);
+    const auto layout = particle->layout();
+    EXPECT_EQ(layout.offsets, (std::vector<size_t>{12, 0, 8}));
+    EXPECT_EQ(layout.size, 16u);
+    EXPECT_EQ(layout.alignment, 16u);
+}
+
+TEST_F(ModuleFileTest, structArrays) {
+    ASSERT_NO_FATAL_FAILURE(emit(R"META(
+        package test.lib;
+
+        @soa
+        public struct Particle {bool alive = true; double mass; int id;}
+
+        public struct Particle[] spawn(int count) {
+            return struct Particle[count];
+        }
+    )META"_fake_src));
+
+    const auto app = R"META(
+        package test.app;
+
+        import test.lib.spawn;
+
+        double bar() {return spawn(3)[1].mass;}
+    )META"_fake_src;
+    Module module{path};
+    Parser parser;
+    Actions act;
+    parser.setParseActions(&act);
+    parser.setNodeActions(&act);
+    ASSERT_PARSE(parser, app);
+    module.load(act.dictionary());
+    const auto& pkg = act.dictionary()["test.lib"sv];
+    ASSERT_EQ(pkg.structs.size(), 1u);
+    Struct* particle = *pkg.structs.begin();
+    EXPECT_TRUE(particle->soa());
+    EXPECT_FALSE(particle->reordered());
+
+    ASSERT_ANALYSE(resolve(parser.ast(), act.dictionary()));
+    auto calls = parser.ast()->getChildren<Call>(infinitDepth);
+    ASSERT_EQ(calls.size(), 1u);
+    ASSERT_TRUE(calls[0]->type());
+    EXPECT_EQ(*calls[0]->type(), typesystem::Type::arrayOf(particle));
+    const auto columns = particle->columns();
+    EXPECT_EQ(columns.order, (std::vector<size_t>{1, 2, 0}));
+    EXPECT_EQ(columns.starts, (std::vector<size_t>{12, 0, 8}));
+    EXPECT_EQ(columns.rowSize, 13u);
+}
+
+TEST_F(ModuleFileTest, corruptedFileRejected) {
+    utils::open<utils::IO::out>(path, std::ios_base::out | std::ios_base::binary) << "METAMOD";
+    EXPECT_THROW(Module{path}, ModuleFileError);
+}
+
+TEST_F(ModuleFileTest, unknownVisibilityRejected) {
+    ASSERT_NO_FATAL_FAILURE(emit(R"META(
+        package test.lib;
+
+        public int foo(int x) {return x;}
+    )META"_fake_src));
+    {
+        std::fstream file{path.string(), std::ios_base::in | std::ios_base::out | std::ios_base::binary};
+        file.seekp(sizeof(format::Header) + offsetof(format::Function, visibility));
+        file.put(static_cast<char>(static_cast<uint8_t>(Visibility::Export) + 1));
+    }
+
+    Module module{path};
+    Dictionary dict;
+    EXPECT_THROW(module.load(dict), ModuleFileError);
+}
+
+} // anonymous namespace
+} // namespace meta::modules::tests
@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include "utils/string.h"
 #include "utils/types.h"
 
 #include "parser/metaparser.h"
@@ -31,7 +32,9 @@ public:
     Annotation(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
         Visitable<Node, Annotation>(src, reduction)
     {
-        PRECONDITION(reduction.size() == 1);
+        // 1: {<annotation>}
+        // 4: {<annotation>, '(', <num>, ')'}
+        PRECONDITION(reduction.size() == 1 || reduction.size() == 4);
         PRECONDITION(reduction[0].tokens.begin() != reduction[0].tokens.end());
         PRECONDITION(reduction[0].tokens.begin()->termNum == annotation);
         PRECONDITION(countNodes(reduction) == 0);
@@ -39,9 +42,13 @@ public:
         Token token = *(reduction[0].tokens.begin());
         ++token.start; // skip '@' character in the beggining of annotation
         mName = token;
+        if (reduction.size() == 4)
+            mArgument = utils::number<int>(reduction[2].tokens);
     }
 
     const utils::string_view& name() const {return mName;}
+    /// Value passed in parentheses after the annotation name if any
+    const utils::optional<int>& argument() const {return mArgument;}
 
     void setTarget(Declaration* val) {mTarget = val;}
     Declaration* target() {return mTarget;}
@@ -54,6 +61,7 @@ public:
 
 private:
     utils::string_view mName;
+    utils::optional<int> mArgument;
     Declaration* mTarget;
 };
 
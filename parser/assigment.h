@@ -51,6 +51,7 @@ public:
     }
 
     Expression* value() {return mValue;}
+    void setValue(Expression* val) {mValue = val;}
     Expression* target() {return mTarget;}
 
 private:
@@ -28,6 +28,8 @@ public:
 
     Expression* left() {return mLeft;}
     Expression* right() {return mRight;}
+    void setLeft(Expression* val) {mLeft = val;}
+    void setRight(Expression* val) {mRight = val;}
 
     enum Operation {
         // Arythmetic
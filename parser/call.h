@@ -33,6 +33,11 @@ public:
     void setFunction(Function* func);
 
     utils::array_view<Node::Ptr<Expression>> args() const {return mArgs;}
+    void setArg(size_t pos, Expression* val) {mArgs[pos] = val;}
+
+    /// Call result is returned immediately by the caller: "return f(...)"
+    bool tailCall() const {return mTailCall;}
+    void setTailCall(bool val) {mTailCall = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0) {
@@ -46,6 +51,7 @@ private:
     std::vector<Node::Ptr<Expression>> mArgs;
     utils::string_view mFunctionName;
     Function* mFunction = nullptr;
+    bool mTailCall = false;
 };
 
 } // namespace meta
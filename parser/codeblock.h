@@ -28,6 +28,7 @@ public:
 
     void add(Node* statement);
     const std::vector<Node::Ptr<Node>>& statements() const;
+    void setStatements(std::vector<Node::Ptr<Node>>&& statements);
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0) {
@@ -36,4 +36,8 @@ const std::vector<Node::Ptr<Node>>& CodeBlock::statements() const {
     return mChildren;
 }
 
+void CodeBlock::setStatements(std::vector<Node::Ptr<Node>>&& statements) {
+    mChildren = std::move(statements);
+}
+
 } // namespace meta
@@ -29,6 +29,12 @@ class Declaration: public Node {
 public:
     using AttributesMap = std::map<std::string, std::function<void(Declaration*)>>;
     virtual const AttributesMap &attributes() const = 0;
+    /// Attributes taking integer argument. Setter returns false if the argument value is not acceptable.
+    using ArgAttributesMap = std::map<std::string, std::function<bool(Declaration*, int)>>;
+    virtual const ArgAttributesMap &argAttributes() const {
+        static const ArgAttributesMap none;
+        return none;
+    }
 
     utils::string_view name() const {return mName;}
 
@@ -36,6 +42,10 @@ protected:
     Declaration(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
         Node(src, reduction)
     {}
+    Declaration(const utils::SourceFile& src, const TokenSequence& tokens, utils::string_view name):
+        Node(src, tokens),
+        mName(name)
+    {}
     utils::string_view mName;
 };
 
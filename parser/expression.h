@@ -28,6 +28,9 @@ protected:
     Expression(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
         Node(src, reduction)
     {}
+    Expression(const utils::SourceFile& src, const TokenSequence& tokens):
+        Node(src, tokens)
+    {}
 };
 
 } // namespace meta
@@ -34,6 +34,7 @@ public:
     }
 
     Expression* expression() {return mExpression;}
+    void setExpression(Expression* val) {mExpression = val;}
 
 private:
     Node::Ptr<Expression> mExpression;
@@ -0,0 +1,62 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/contract.h"
+
+#include "parser/for.h"
+
+namespace meta {
+
+For::For(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
+    Visitable<Node, For>(src, reduction)
+{
+    constexpr size_t initPos = 2;
+    constexpr size_t condPos = 4;
+    constexpr size_t stepPos = 6;
+    constexpr size_t bodyPos = 8;
+    // {'for', '(', [2]<VarDecl>, ';', [4]<Expr>, ';', [6]<Expr>, ')', [8]<Sttmnt>}
+    PRECONDITION(reduction.size() == 9);
+    PRECONDITION(reduction[initPos].nodes.size() == 1);
+    PRECONDITION(reduction[condPos].nodes.size() == 1);
+    PRECONDITION(reduction[stepPos].nodes.size() == 1);
+    PRECONDITION(reduction[bodyPos].nodes.size() <= 1);
+    POSTCONDITION(mInit != nullptr);
+    POSTCONDITION(mConditon != nullptr);
+    POSTCONDITION(mStep != nullptr);
+    POSTCONDITION(mBody != nullptr || reduction[bodyPos].nodes.empty());
+
+    mInit = dynamic_cast<VarDecl*>(reduction[initPos].nodes[0].get());
+    mConditon = dynamic_cast<Expression*>(reduction[condPos].nodes[0].get());
+    mStep = dynamic_cast<Expression*>(reduction[stepPos].nodes[0].get());
+    if (!reduction[bodyPos].nodes.empty())
+        mBody = reduction[bodyPos].nodes[0];
+}
+
+void For::walk(Visitor* visitor, int depth) {
+    if (accept(visitor) && depth != 0) {
+        mInit->walk(visitor, depth - 1);
+        mConditon->walk(visitor, depth - 1);
+        mStep->walk(visitor, depth - 1);
+        if (mBody)
+            mBody->walk(visitor, depth - 1);
+    }
+    seeOff(visitor);
+}
+
+} // namespace meta
@@ -32,17 +32,37 @@
 namespace meta {
 
 enum class FuncFlags {
-    entrypoint
+    entrypoint,
+    /// Result depends on arguments only, calls have no side effects and always return
+    pure,
+    /// Function never calls itself directly or through other functions
+    noRecurse,
+    alwaysInline,
+    noInline,
+    /// Rarely executed function
+    cold,
+    /// All recursive calls must be eliminated by tail recursion elimination
+    tailRec,
+    /// Arrays created by the function are allocated in a meta-rt region freed when it returns
+    region
 };
 
 class Function: public Visitable<Declaration, Function>, public Typed {
 public:
     Function(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+    /// Creates declaration without body loaded from a compiled module file
+    Function(
+        const utils::SourceFile& src, const TokenSequence& tokens,
+        utils::string_view name, utils::string_view retType, std::vector<Node::Ptr<VarDecl>>&& args
+    );
     ~Function();
 
     const Declaration::AttributesMap &attributes() const override {return attrMap;}
 
     const utils::string_view &retType() const {return mRetType;}
+    /// Return type named by a struct declaration found by the resolver, nullopt for built in types
+    const utils::optional<typesystem::Type>& declaredRetType() const {return mDeclaredRetType;}
+    void setDeclaredRetType(typesystem::Type val) {mDeclaredRetType = val;}
     const utils::string_view &package() const {return mPackage;}
     void setPackage(const utils::string_view &pkg) {mPackage = pkg;}
     void setMangledName(const utils::string_view &val) {mMangledName = val;}
@@ -57,6 +77,11 @@ public:
     const auto& flags() const {return mFlags;}
     auto& flags() {return mFlags;}
 
+    /// Number of slots occupied by arguments and local variables
+    size_t slotsCount() const {return mSlotsCount;}
+    /// Reserves next slot for an argument or local variable declared in this function
+    size_t addSlot() {return mSlotsCount++;}
+
     void walk(Visitor* visitor, int depth = infinitDepth) override;
 
 private:
@@ -65,9 +90,11 @@ private:
     Node::Ptr<CodeBlock> mBody;
     utils::string_view mPackage;
     utils::string_view mRetType;
+    utils::optional<typesystem::Type> mDeclaredRetType;
     utils::optional<utils::string_view> mMangledName;
     Visibility mVisibility = Visibility::Default;
     utils::Bitmask<FuncFlags> mFlags;
+    size_t mSlotsCount = 0;
 
     static const Declaration::AttributesMap attrMap;
 };
@@ -66,6 +66,18 @@ Function::Function(const utils::SourceFile& src, utils::array_view<StackFrame> r
         mBody = &(dynamic_cast<CodeBlock&>(*funcReduction[bodyPos].nodes[0]));
 }
 
+Function::Function(
+    const utils::SourceFile& src, const TokenSequence& tokens,
+    utils::string_view name, utils::string_view retType, std::vector<Node::Ptr<VarDecl>>&& args
+):
+    Visitable<Declaration, Function>(src, tokens, name),
+    mArgs(std::move(args)),
+    mRetType(retType)
+{
+    for (auto& arg: mArgs)
+        arg->flags() |= VarFlags::argument;
+}
+
 Function::~Function() = default;
 
 void Function::walk(Visitor* visitor, int depth) {
@@ -83,6 +95,24 @@ void Function::walk(Visitor* visitor, int depth) {
 const Declaration::AttributesMap Function::attrMap = {
     {"entrypoint", [](Declaration *decl) {
         dynamic_cast<Function&>(*decl).flags() |= FuncFlags::entrypoint;
+    }},
+    {"pure", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::pure;
+    }},
+    {"inline", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::alwaysInline;
+    }},
+    {"noinline", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::noInline;
+    }},
+    {"cold", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::cold;
+    }},
+    {"tailrec", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::tailRec;
+    }},
+    {"region", [](Declaration *decl) {
+        dynamic_cast<Function&>(*decl).flags() |= FuncFlags::region;
     }}
 };
 
@@ -28,8 +28,11 @@ public:
     If(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
 
     Expression* condition() {return mConditon;}
+    void setCondition(Expression* val) {mConditon = val;}
     Node* thenBlock() {return mThen;}
+    void setThenBlock(Node* val) {mThen = val;}
     Node* elseBlock() {return mElse;}
+    void setElseBlock(Node* val) {mElse = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0) {
@@ -0,0 +1,54 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "parser/expression.h"
+#include "parser/metaparser.h"
+
+namespace meta {
+
+/// Array element access: array[index]
+class Index: public Visitable<Expression, Index> {
+public:
+    Index(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+
+    Expression* array() const {return mArray;}
+    void setArray(Expression* val) {mArray = val;}
+    Expression* index() const {return mIndex;}
+    void setIndex(Expression* val) {mIndex = val;}
+
+    /// False if index is proven to be in bounds and runtime check is not needed
+    bool boundsChecked() const {return mBoundsChecked;}
+    void setBoundsChecked(bool val) {mBoundsChecked = val;}
+
+    void walk(Visitor* visitor, int depth) override {
+        if (accept(visitor) && depth != 0) {
+            mArray->walk(visitor, depth - 1);
+            mIndex->walk(visitor, depth - 1);
+        }
+        seeOff(visitor);
+    }
+
+private:
+    Node::Ptr<Expression> mArray;
+    Node::Ptr<Expression> mIndex;
+    bool mBoundsChecked = true;
+};
+
+} // namespace meta
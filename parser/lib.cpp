@@ -2,10 +2,13 @@
 #include "call.hpp"
 #include "codeblock.hpp"
 #include "exprstatement.hpp"
+#include "for.hpp"
 #include "function.hpp"
 #include "if.hpp"
 #include "import.hpp"
+#include "index.hpp"
 #include "literal.hpp"
+#include "newarray.hpp"
 #include "number.hpp"
 #include "prefixop.hpp"
 #include "sourcefile.hpp"
@@ -14,3 +17,4 @@
 #include "var.hpp"
 #include "vardecl.hpp"
 #include "visibility.hpp"
+#include "while.hpp"
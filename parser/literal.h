@@ -30,6 +30,12 @@ public:
         // boolean
         trueVal, falseVal
     };
+
+    /// Creates literal evaluated at compile time from the expression represented by tokens
+    Literal(const utils::SourceFile& src, const TokenSequence& tokens, Value value):
+        Visitable<Expression, Literal>(src, tokens),
+        mVal(value)
+    {}
     Value value() const {return mVal;}
 
     void walk(Visitor* visitor, int) override {
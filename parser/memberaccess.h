@@ -42,14 +42,16 @@ public:
         mMemberName = reduction[2].tokens;
     }
 
-    Struct* targetStruct() const {return mTargetStruct;}
-    void setTargetStruct(Struct* val) {mTargetStruct = val;}
+    /// Struct declaring the member or null for members of built in types
+    const Struct* targetStruct() const {return mTargetStruct;}
+    void setTargetStruct(const Struct* val) {mTargetStruct = val;}
 
     VarDecl* memberDecl() const {return mMemberDecl;}
     void setMemberDecl(VarDecl* val) {mMemberDecl = val;}
 
     utils::string_view memberName() const {return mMemberName;}
     Expression* parent() const {return mParent;}
+    void setParent(Expression* val) {mParent = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (this->accept(visitor) && depth != 0) {
@@ -60,7 +62,7 @@ public:
 
 private:
     Node::Ptr<Expression> mParent;
-    Struct* mTargetStruct = nullptr;
+    const Struct* mTargetStruct = nullptr;
     VarDecl* mMemberDecl = nullptr;
     utils::string_view mMemberName;
 };
@@ -24,11 +24,14 @@
 #include "parser/call.h"
 #include "parser/codeblock.h"
 #include "parser/exprstatement.h"
+#include "parser/for.h"
 #include "parser/function.h"
 #include "parser/if.h"
 #include "parser/import.h"
+#include "parser/index.h"
 #include "parser/literal.h"
 #include "parser/memberaccess.h"
+#include "parser/newarray.h"
 #include "parser/number.h"
 #include "parser/prefixop.h"
 #include "parser/return.h"
@@ -37,3 +40,4 @@
 #include "parser/struct.h"
 #include "parser/var.h"
 #include "parser/vardecl.h"
+#include "parser/while.h"
@@ -0,0 +1,51 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "parser/expression.h"
+#include "parser/metaparser.h"
+
+namespace meta {
+
+/// Allocation of the array with the given number of zero initialized elements: int[size]
+class NewArray: public Visitable<Expression, NewArray> {
+public:
+    NewArray(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+
+    utils::string_view elementTypeName() const {return mElementTypeName;}
+    Expression* size() const {return mSize;}
+    void setSize(Expression* val) {mSize = val;}
+
+    /// True if the array never outlives the function frame and is placed there without control block
+    bool stackAllocated() const {return mStackAllocated;}
+    void setStackAllocated(bool val) {mStackAllocated = val;}
+
+    void walk(Visitor* visitor, int depth) override {
+        if (accept(visitor) && depth != 0)
+            mSize->walk(visitor, depth - 1);
+        seeOff(visitor);
+    }
+
+private:
+    utils::string_view mElementTypeName;
+    Node::Ptr<Expression> mSize;
+    bool mStackAllocated = false;
+};
+
+} // namespace meta
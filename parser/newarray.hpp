@@ -0,0 +1,38 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/contract.h"
+
+#include "parser/newarray.h"
+
+namespace meta {
+
+NewArray::NewArray(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
+    Visitable<Expression, NewArray>(src, reduction)
+{
+    // {<element type>, '[', [2]<Expr>, ']'}
+    PRECONDITION(reduction.size() == 4);
+    PRECONDITION(reduction[0].nodes.empty());
+    PRECONDITION(reduction[2].nodes.size() == 1);
+    POSTCONDITION(mSize != nullptr);
+    mElementTypeName = reduction[0].tokens;
+    mSize = dynamic_cast<Expression*>(reduction[2].nodes[0].get());
+}
+
+} // namespace meta
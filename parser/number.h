@@ -25,6 +25,11 @@ namespace meta {
 class Number: public Visitable<Expression, Number> {
 public:
     Number(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+    /// Creates number evaluated at compile time from the expression represented by tokens
+    Number(const utils::SourceFile& src, const TokenSequence& tokens, int value):
+        Visitable<Expression, Number>(src, tokens),
+        mValue(value)
+    {}
 
     int value() const {return mValue;}
 
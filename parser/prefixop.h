@@ -35,6 +35,7 @@ public:
     Operation operation() const {return mOperation;}
 
     Expression* operand() {return mOperand;}
+    void setOperand(Expression* val) {mOperand = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0)
@@ -38,6 +38,7 @@ public:
     }
 
     Expression* value() {return mRetVal;}
+    void setValue(Expression* val) {mRetVal = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0 && mRetVal)
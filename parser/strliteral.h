@@ -18,17 +18,28 @@
  */
 #pragma once
 
+#include <string>
 #include <vector>
 
+#include "utils/types.h"
+
 #include "parser/expression.h"
 
 namespace meta {
 
+/// Replaces escape sequences in the string literal text with the characters they denote
+std::string unescape(utils::string_view text);
+
 class StrLiteral: public Visitable<Expression, StrLiteral> {
 public:
     StrLiteral(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
 
-    const std::vector<char> &value() const {return mVal;}
+    /// Literal text as written in the source without quotes and escape sequences processing
+    utils::string_view text() const {return mText;}
+    std::vector<char> value() const {
+        const std::string res = unescape(mText);
+        return {res.begin(), res.end()};
+    }
 
     void walk(Visitor* visitor, int) override {
         accept(visitor);
@@ -36,7 +47,7 @@ public:
     }
 
 private:
-    std::vector<char> mVal;
+    utils::string_view mText;
 };
 
 } // namespace meta
@@ -23,37 +23,44 @@
 
 namespace meta {
 
-StrLiteral::StrLiteral(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
-    Visitable<Expression, StrLiteral>(src, reduction)
-{
-    PRECONDITION(reduction.size() == 1);
-    PRECONDITION(reduction[0].symbol == strLiteral);
-    PRECONDITION(countNodes(reduction) == 0);
-    auto token = *reduction[0].tokens.begin();
+std::string unescape(utils::string_view text) {
+    std::string res;
+    res.reserve(text.size());
     bool escape = false;
-    for (const char *cur = token.start + 1; cur < token.end - 1; ++cur) {
-        if (!escape && *cur == '\\') {
+    for (char cur: text) {
+        if (!escape && cur == '\\') {
             escape = true;
             continue;
         }
         if (escape) {
-            switch (*cur) {
-                case '\\': mVal.push_back('\\'); break;
-                case '"': mVal.push_back('"'); break;
-                case 'n': mVal.push_back('\n'); break;
-                case 'r': mVal.push_back('\r'); break;
-                case 't': mVal.push_back('\t'); break;
-                case 'a': mVal.push_back('\a'); break;
-                case 'b': mVal.push_back('\b'); break;
-                case 'f': mVal.push_back('\f'); break;
-                case '0': mVal.push_back('\0'); break;
-                default: mVal.push_back('\\'); mVal.push_back(*cur);
+            switch (cur) {
+                case '\\': res.push_back('\\'); break;
+                case '"': res.push_back('"'); break;
+                case 'n': res.push_back('\n'); break;
+                case 'r': res.push_back('\r'); break;
+                case 't': res.push_back('\t'); break;
+                case 'a': res.push_back('\a'); break;
+                case 'b': res.push_back('\b'); break;
+                case 'f': res.push_back('\f'); break;
+                case '0': res.push_back('\0'); break;
+                default: res.push_back('\\'); res.push_back(cur);
             }
             escape = false;
             continue;
         }
-        mVal.push_back(*cur);
+        res.push_back(cur);
     }
+    return res;
+}
+
+StrLiteral::StrLiteral(const utils::SourceFile& src, utils::array_view<StackFrame> reduction):
+    Visitable<Expression, StrLiteral>(src, reduction)
+{
+    PRECONDITION(reduction.size() == 1);
+    PRECONDITION(reduction[0].symbol == strLiteral);
+    PRECONDITION(countNodes(reduction) == 0);
+    auto token = *reduction[0].tokens.begin();
+    mText = utils::string_view{token.start + 1, static_cast<size_t>(token.end - token.start - 2)};
 }
 
 } // namespace meta
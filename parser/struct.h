@@ -18,8 +18,12 @@
  */
 #pragma once
 
+#include <string>
+
 #include "utils/types.h"
 
+#include "typesystem/type.h"
+
 #include "parser/annotation.h"
 #include "parser/declaration.h"
 #include "parser/metaparser.h"
@@ -28,11 +32,28 @@
 
 namespace meta {
 
-class Struct: public Visitable<Declaration, Struct> {
+/// Struct declaration describes the layout of its values used by the code generator
+class Struct: public Visitable<Declaration, Struct>, public typesystem::Aggregate {
 public:
     Struct(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+    /// Creates declaration loaded from a compiled module file
+    Struct(
+        const utils::SourceFile& src, const TokenSequence& tokens,
+        utils::string_view name, std::vector<Node::Ptr<VarDecl>>&& members
+    ):
+        Visitable<Declaration, Struct>(src, tokens, name),
+        mMembers(std::move(members)),
+        mArrayTypeName(static_cast<std::string>(name) + "[]")
+    {
+        for (auto& member: mMembers)
+            member->flags() |= VarFlags::member;
+    }
 
     const Declaration::AttributesMap& attributes() const override {return attrMap;}
+    const Declaration::ArgAttributesMap& argAttributes() const override {return argAttrMap;}
+
+    utils::string_view typeName() const override {return name();}
+    utils::string_view arrayTypeName() const override {return mArrayTypeName;}
 
     const auto& members() const {return mMembers;}
 
@@ -55,10 +76,12 @@ public:
 private:
     std::vector<Node::Ptr<Annotation>> mAnnotations;
     std::vector<Node::Ptr<VarDecl>> mMembers;
+    std::string mArrayTypeName;
     utils::string_view mPackage;
     Visibility mVisibility = Visibility::Default;
 
     static const Declaration::AttributesMap attrMap;
+    static const Declaration::ArgAttributesMap argAttrMap;
 };
 
 }
@@ -41,6 +41,7 @@ Struct::Struct(const utils::SourceFile& src, utils::array_view<StackFrame> reduc
     if (!structReduction[0].tokens.empty())
         mVisibility = fromToken(*structReduction[0].tokens.begin());
     mName = structReduction[2].tokens;
+    mArrayTypeName = static_cast<std::string>(mName) + "[]";
     for (auto& node: structReduction[4].nodes) {
         auto& member = dynamic_cast<VarDecl&>(*node);
         member.flags() |= VarFlags::member;
@@ -48,6 +49,28 @@ Struct::Struct(const utils::SourceFile& src, utils::array_view<StackFrame> reduc
     }
 }
 
-const Declaration::AttributesMap Struct::attrMap = {};
+const Declaration::AttributesMap Struct::attrMap = {
+    {"packed", [](Declaration *decl) {
+        dynamic_cast<Struct&>(*decl).setPacked(true);
+    }},
+    {"reorder", [](Declaration *decl) {
+        dynamic_cast<Struct&>(*decl).setReordered(true);
+    }},
+    {"soa", [](Declaration *decl) {
+        dynamic_cast<Struct&>(*decl).setSoa(true);
+    }}
+};
+
+/// Alignment of a struct could only be a power of two up to the page size
+constexpr int maxStructAlignment = 4096;
+
+const Declaration::ArgAttributesMap Struct::argAttrMap = {
+    {"align", [](Declaration *decl, int val) {
+        if (val <= 0 || val > maxStructAlignment || (val & (val - 1)) != 0)
+            return false;
+        dynamic_cast<Struct&>(*decl).setRequestedAlignment(static_cast<size_t>(val));
+        return true;
+    }}
+};
 
 }
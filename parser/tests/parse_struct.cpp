@@ -24,7 +24,10 @@
 
 #include "parser/annotation.h"
 #include "parser/assigment.h"
+#include "parser/index.h"
+#include "parser/memberaccess.h"
 #include "parser/metaparser.h"
+#include "parser/newarray.h"
 #include "parser/struct.h"
 #include "parser/vardecl.h"
 
@@ -81,6 +84,32 @@ TEST(StructParsing, annotatedStruct) {
     EXPECT_EQ(annotations[1]->target(), structs[0]);
 }
 
+TEST(StructParsing, annotationArgument) {
+     const auto input = utils::SourceFile::fake(R"META(
+        package test;
+
+        @packed
+        @align(16)
+        struct Point {
+            int x;
+            int y;
+        }
+    )META");
+    Parser parser;
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    auto structs = ast->getChildren<Struct>();
+    ASSERT_EQ(structs.size(), 1u);
+    auto annotations = structs[0]->getChildren<Annotation>();
+    ASSERT_EQ(annotations.size(), 2u);
+    EXPECT_EQ(annotations[0]->name(), "packed");
+    EXPECT_FALSE(annotations[0]->argument());
+    EXPECT_EQ(annotations[1]->name(), "align");
+    ASSERT_TRUE(annotations[1]->argument());
+    EXPECT_EQ(*annotations[1]->argument(), 16);
+    EXPECT_EQ(annotations[1]->target(), structs[0]);
+}
+
 TEST(StructParsing, defaultValsOnMembers) {
      const auto input = utils::SourceFile::fake(R"META(
         package test;
@@ -150,5 +179,37 @@ TEST(StructParsing, memberAccess) {
 //    EXPECT_EQ(assigments[3]->typeName(), "Point");
 }
 
+TEST(StructParsing, structArray) {
+     const auto input = utils::SourceFile::fake(R"META(
+        package test;
+
+        @soa
+        struct Point {
+            int x = 0;
+            int y = 0;
+        }
+
+        void foo(int n) {
+            struct Point[] pts = struct Point[n];
+            pts[0].x = 5;
+        }
+    )META");
+    Parser parser;
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    auto vars = ast->getChildren<VarDecl>(infinitDepth);
+    ASSERT_EQ(vars.size(), 4u);
+    EXPECT_EQ(vars[3]->name(), "pts");
+    EXPECT_EQ(vars[3]->typeName(), "struct Point[]");
+    auto allocations = ast->getChildren<NewArray>(infinitDepth);
+    ASSERT_EQ(allocations.size(), 1u);
+    EXPECT_EQ(allocations[0]->elementTypeName(), "struct Point");
+    auto assigments = ast->getChildren<Assigment>(infinitDepth);
+    ASSERT_EQ(assigments.size(), 1u);
+    auto member = dynamic_cast<MemberAccess*>(assigments[0]->target());
+    ASSERT_NE(member, nullptr);
+    EXPECT_NE(dynamic_cast<Index*>(member->parent()), nullptr);
+}
+
 } // anonymous namespace
 } // namespace meta
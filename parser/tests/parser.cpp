@@ -33,6 +33,7 @@
 #include "parser/binaryop.h"
 #include "parser/call.h"
 #include "parser/codeblock.h"
+#include "parser/for.h"
 #include "parser/if.h"
 #include "parser/import.h"
 #include "parser/function.h"
@@ -41,6 +42,7 @@
 #include "parser/return.h"
 #include "parser/var.h"
 #include "parser/vardecl.h"
+#include "parser/while.h"
 
 namespace meta::parser {
 namespace {
@@ -353,6 +355,97 @@ TEST(MetaParser, ifElseBlockStatement) {
     ASSERT_EQ(ifs[0]->elseBlock()->getChildren<Call>(-1)[0], calls[1]);
 }
 
+TEST(MetaParser, whileStatement) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        void foo0(int x)
+        {
+            while (x > 0)
+                x = foo1(x);
+            while (x < 0)
+                ;
+            foo2(x);
+        }
+    )META"_fake_src;
+    Parser parser;
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    auto loops = ast->getChildren<While>(-1);
+    ASSERT_EQ(loops.size(), 2u);
+    auto calls = ast->getChildren<Call>(-1);
+    ASSERT_EQ(calls.size(), 2u);
+
+    ASSERT_NE(loops[0]->condition(), nullptr);
+    ASSERT_NE(loops[0]->body(), nullptr);
+    ASSERT_EQ(loops[0]->body()->getChildren<Call>(-1).size(), 1u);
+    ASSERT_EQ(loops[0]->body()->getChildren<Call>(-1)[0], calls[0]);
+
+    ASSERT_NE(loops[1]->condition(), nullptr);
+    ASSERT_EQ(loops[1]->body(), nullptr);
+}
+
+TEST(MetaParser, forStatement) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        int foo0(int n)
+        {
+            int sum = 0;
+            for (int i = 0; i < n; i = i + 1) {
+                sum = sum + i;
+            }
+            return sum;
+        }
+    )META"_fake_src;
+    Parser parser;
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    auto loops = ast->getChildren<For>(-1);
+    ASSERT_EQ(loops.size(), 1u);
+
+    ASSERT_NE(loops[0]->init(), nullptr);
+    ASSERT_EQ(loops[0]->init()->name(), "i");
+    ASSERT_NE(dynamic_cast<BinaryOp*>(loops[0]->condition()), nullptr);
+    ASSERT_NE(dynamic_cast<Assigment*>(loops[0]->step()), nullptr);
+    ASSERT_NE(dynamic_cast<CodeBlock*>(loops[0]->body()), nullptr);
+    ASSERT_EQ(loops[0]->body()->getChildren<Assigment>(-1).size(), 1u);
+}
+
+TEST(MetaParser, arrays) {
+    const utils::SourceFile input = R"META(
+        package test;
+
+        int foo(int[] values)
+        {
+            int[] copy = int[values.length];
+            copy[0] = values[1];
+            return copy.length;
+        }
+    )META"_fake_src;
+    Parser parser;
+    ASSERT_PARSE(parser, input);
+    auto ast = parser.ast();
+    auto args = ast->getChildren<Function>(-1)[0]->args();
+    ASSERT_EQ(args.size(), 1u);
+    EXPECT_EQ(args[0]->typeName(), "int[]");
+
+    auto allocations = ast->getChildren<NewArray>(-1);
+    ASSERT_EQ(allocations.size(), 1u);
+    EXPECT_EQ(allocations[0]->elementTypeName(), "int");
+    ASSERT_NE(dynamic_cast<MemberAccess*>(allocations[0]->size()), nullptr);
+
+    auto indexes = ast->getChildren<Index>(-1);
+    ASSERT_EQ(indexes.size(), 2u);
+    for (auto index: indexes) {
+        EXPECT_NE(dynamic_cast<Var*>(index->array()), nullptr);
+        EXPECT_NE(dynamic_cast<Number*>(index->index()), nullptr);
+        EXPECT_TRUE(index->boundsChecked());
+    }
+    EXPECT_NE(dynamic_cast<Index*>(ast->getChildren<Assigment>(-1)[0]->target()), nullptr);
+    EXPECT_EQ(ast->getChildren<MemberAccess>(-1).size(), 2u);
+}
+
 TEST(MetaParser, multipleFiles) {
     const utils::SourceFile src1 = "package test; int foo() {return 0;}"_fake_src;
     const utils::SourceFile src2 = "package test; bool bar() {return false;}"_fake_src;
@@ -30,12 +30,23 @@ namespace meta {
 
 enum class VarFlags {
     argument,
-    member
+    member,
+    /// Local array variable holding stack allocated arrays only, see analysers::allocateArraysOnStack
+    stackArray
 };
 
 class VarDecl: public Visitable<Declaration, VarDecl>, public Typed {
 public:
     VarDecl(const utils::SourceFile& src, utils::array_view<StackFrame> reduction);
+    /// Creates declaration loaded from a compiled module file
+    VarDecl(
+        const utils::SourceFile& src, const TokenSequence& tokens,
+        utils::string_view name, utils::string_view typeName, Expression* initExpr = nullptr
+    ):
+        Visitable<Declaration, VarDecl>(src, tokens, name),
+        mInitExpr(initExpr),
+        mTypeName(typeName)
+    {}
 
     const AttributesMap& attributes() const override;
 
@@ -43,8 +54,12 @@ public:
 
     bool inited() const {return mInitExpr != nullptr;}
     Expression* initExpr() const {return mInitExpr;}
+    void setInitExpr(Expression* val) {mInitExpr = val;}
     auto flags() const {return mFlags;}
     auto& flags() {return mFlags;}
+    /// Dense index of the variable among arguments and locals of its function assigned by resolver
+    size_t slot() const {return mSlot;}
+    void setSlot(size_t val) {mSlot = val;}
 
     void walk(Visitor* visitor, int depth) override {
         if (accept(visitor) && depth != 0) {
@@ -58,6 +73,7 @@ private:
     Node::Ptr<Expression> mInitExpr;
     utils::string_view mTypeName;
     utils::Bitmask<VarFlags> mFlags;
+    size_t mSlot = 0;
 };
 
 }
@@ -0,0 +1,2 @@
+#include "server.hpp"
+#include "socket.hpp"
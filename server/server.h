@@ -0,0 +1,58 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+
+namespace meta::server {
+
+/**
+ * Performs compilation requested by the client.
+ *
+ * @param cwd working directory of the client which should be used to resolve relative paths
+ * @param args command line arguments passed to the client
+ * @param out receives everything which should be reported to the client user
+ * @return true on success
+ */
+using Handler = std::function<bool(
+    const utils::fs::path& cwd, const std::vector<std::string>& args, std::ostream& out
+)>;
+
+/// Clients not sending the request or not reading the response during this time are disconnected
+constexpr std::chrono::milliseconds defaultClientTimeout{30000};
+
+/**
+ * Serves requests one by one until the process is terminated. Failures to accept connections are
+ * logged to stderr, clients failed to communicate are disconnected silently.
+ */
+void serve(
+    const utils::fs::path& socket, const Handler& handler,
+    std::chrono::milliseconds clientTimeout = defaultClientTimeout
+);
+
+/// Sends request to the server and writes its report into out. Returns request handling result.
+bool request(const utils::fs::path& socket, const std::vector<std::string>& args, std::ostream& out);
+
+} // namespace meta::server
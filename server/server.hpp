@@ -0,0 +1,120 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cerrno>
+#include <exception>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include "utils/string.h"
+
+#include "server/server.h"
+#include "server/socket.h"
+
+namespace meta::server {
+namespace {
+
+// Request is client working directory followed by command line arguments each terminated with
+// '\0'. Response is a status character followed by the text report.
+constexpr char fieldEnd = '\0';
+constexpr char successStatus = '+';
+constexpr char failureStatus = '-';
+
+constexpr std::chrono::milliseconds acceptRetryDelay{100};
+
+bool outOfResources(const std::error_code& code) {
+    return
+        code == std::errc::too_many_files_open ||
+        code == std::errc::too_many_files_open_in_system ||
+        code == std::errc::not_enough_memory ||
+        code == std::errc::no_buffer_space
+    ;
+}
+
+void handle(Socket& conn, const Handler& handler) {
+    const std::string request = conn.receiveAll();
+    std::vector<std::string> fields;
+    for (utils::string_view field: utils::split(request, fieldEnd))
+        fields.emplace_back(field);
+    // split yields empty tail after the last terminator
+    if (!fields.empty() && fields.back().empty())
+        fields.pop_back();
+
+    std::ostringstream out;
+    bool res = false;
+    if (fields.empty())
+        out << "Error: malformed request" << std::endl;
+    else try {
+        const utils::fs::path cwd = fields.front();
+        fields.erase(fields.begin());
+        res = handler(cwd, fields, out);
+    } catch (const std::exception& err) {
+        out << "Error: " << err.what() << std::endl;
+    }
+    conn.send({res ? &successStatus : &failureStatus, 1});
+    conn.send(out.str());
+}
+
+} // anonymous namespace
+
+void serve(const utils::fs::path& socket, const Handler& handler, std::chrono::milliseconds clientTimeout) {
+    Socket listener = Socket::listen(socket);
+    while (true) {
+        utils::optional<Socket> conn;
+        try {
+            conn.emplace(listener.accept());
+        } catch (const std::system_error& err) {
+            std::cerr << "Error: " << err.what() << std::endl;
+            // Pending connection stays in the backlog until resources are released so immediate retry
+            // fails again
+            if (outOfResources(err.code()))
+                std::this_thread::sleep_for(acceptRetryDelay);
+            continue;
+        }
+        try {
+            conn->setTimeout(clientTimeout);
+            handle(*conn, handler);
+        } catch (const std::system_error&) {
+            // client gone away or stalled, nothing to report to
+        }
+    }
+}
+
+bool request(const utils::fs::path& socket, const std::vector<std::string>& args, std::ostream& out) {
+    Socket conn = Socket::connect(socket);
+    std::string request = utils::fs::current_path().string();
+    request.push_back(fieldEnd);
+    for (const auto& arg: args) {
+        request += arg;
+        request.push_back(fieldEnd);
+    }
+    conn.send(request);
+    conn.finishSending();
+    const std::string response = conn.receiveAll();
+    if (response.empty())
+        throw std::system_error(ECONNRESET, std::system_category(), "compile server response");
+    out << utils::string_view{response}.substr(1);
+    return response.front() == successStatus;
+}
+
+} // namespace meta::server
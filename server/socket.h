@@ -0,0 +1,59 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "utils/types.h"
+
+namespace meta::server {
+
+/**
+ * Unix domain stream socket. Errors are reported with std::system_error.
+ */
+class Socket {
+public:
+    static Socket listen(const utils::fs::path& path);
+    static Socket connect(const utils::fs::path& path);
+
+    Socket(Socket&& rhs): mFd(rhs.mFd) {rhs.mFd = -1;}
+    Socket& operator= (Socket&& rhs);
+    Socket(const Socket&) = delete;
+    Socket& operator= (const Socket&) = delete;
+    ~Socket();
+
+    Socket accept();
+
+    /// Makes send and receive fail with EAGAIN if peer doesn't respond during the timeout
+    void setTimeout(std::chrono::milliseconds timeout);
+
+    void send(utils::string_view data);
+    /// Signals peer that nothing more will be sent
+    void finishSending();
+    /// Reads everything until peer finishes sending
+    std::string receiveAll();
+
+private:
+    explicit Socket(int fd): mFd(fd) {}
+
+    int mFd;
+};
+
+} // namespace meta::server
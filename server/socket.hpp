@@ -0,0 +1,148 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server/socket.h"
+
+namespace meta::server {
+namespace {
+
+[[noreturn]] void throwErrno(const std::string& what) {
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+sockaddr_un address(const utils::fs::path& path) {
+    sockaddr_un res;
+    std::memset(&res, 0, sizeof(res));
+    res.sun_family = AF_UNIX;
+    const std::string& str = path.native();
+    if (str.size() >= sizeof(res.sun_path))
+        throw std::system_error(ENAMETOOLONG, std::system_category(), str);
+    std::memcpy(res.sun_path, str.c_str(), str.size());
+    return res;
+}
+
+int createSocket() {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throwErrno("socket");
+    return fd;
+}
+
+} // anonymous namespace
+
+Socket Socket::listen(const utils::fs::path& path) {
+    Socket res{createSocket()};
+    const sockaddr_un addr = address(path);
+    // Socket file left by the previous server instance prevents bind
+    if (utils::fs::is_socket(path))
+        utils::fs::remove(path);
+    if (::bind(res.mFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        throwErrno(path.string());
+    if (::listen(res.mFd, SOMAXCONN) != 0)
+        throwErrno(path.string());
+    return res;
+}
+
+Socket Socket::connect(const utils::fs::path& path) {
+    Socket res{createSocket()};
+    const sockaddr_un addr = address(path);
+    if (::connect(res.mFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        throwErrno(path.string());
+    return res;
+}
+
+Socket& Socket::operator= (Socket&& rhs) {
+    if (this == &rhs)
+        return *this;
+    if (mFd >= 0)
+        ::close(mFd);
+    mFd = rhs.mFd;
+    rhs.mFd = -1;
+    return *this;
+}
+
+Socket::~Socket() {
+    if (mFd >= 0)
+        ::close(mFd);
+}
+
+Socket Socket::accept() {
+    int fd;
+    do
+        fd = ::accept4(mFd, nullptr, nullptr, SOCK_CLOEXEC);
+    while (fd < 0 && errno == EINTR);
+    if (fd < 0)
+        throwErrno("accept");
+    return Socket{fd};
+}
+
+void Socket::setTimeout(std::chrono::milliseconds timeout) {
+    timeval val;
+    val.tv_sec = static_cast<time_t>(timeout.count()/1000);
+    val.tv_usec = static_cast<suseconds_t>(timeout.count()%1000*1000);
+    if (::setsockopt(mFd, SOL_SOCKET, SO_RCVTIMEO, &val, sizeof(val)) != 0)
+        throwErrno("setsockopt");
+    if (::setsockopt(mFd, SOL_SOCKET, SO_SNDTIMEO, &val, sizeof(val)) != 0)
+        throwErrno("setsockopt");
+}
+
+void Socket::send(utils::string_view data) {
+    while (!data.empty()) {
+        // peer may disconnect at any moment which should not kill the process with SIGPIPE
+        const ssize_t sent = ::send(mFd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0)
+            throwErrno("send");
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+}
+
+void Socket::finishSending() {
+    if (::shutdown(mFd, SHUT_WR) != 0)
+        throwErrno("shutdown");
+}
+
+std::string Socket::receiveAll() {
+    std::string res;
+    char buf[4096];
+    while (true) {
+        const ssize_t received = ::recv(mFd, buf, sizeof(buf), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0)
+            throwErrno("recv");
+        if (received == 0)
+            break;
+        res.append(buf, static_cast<size_t>(received));
+    }
+    return res;
+}
+
+} // namespace meta::server
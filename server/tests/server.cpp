@@ -0,0 +1,155 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "utils/types.h"
+
+#include "server/server.h"
+#include "server/socket.h"
+
+namespace meta::server::tests {
+namespace {
+
+/// Reports request back to the client: "fail" argument fails the request and "throw" breaks the handler
+bool echo(const utils::fs::path& cwd, const std::vector<std::string>& args, std::ostream& out) {
+    out << cwd.string() << '\n';
+    for (const auto& arg: args) {
+        if (arg == "throw")
+            throw std::runtime_error("handler failure");
+        out << arg << '\n';
+    }
+    return args.empty() || args.front() != "fail";
+}
+
+class ServerTest: public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = utils::fs::temp_directory_path()/("meta-server-test-" + std::to_string(::getpid()) + ".sock");
+        serverPid = ::fork();
+        ASSERT_GE(serverPid, 0);
+        if (serverPid == 0) {
+            try {
+                serve(path, echo, clientTimeout);
+            } catch (...) {
+            }
+            ::_exit(EXIT_FAILURE);
+        }
+    }
+
+    void TearDown() override {
+        ::kill(serverPid, SIGTERM);
+        ::waitpid(serverPid, nullptr, 0);
+        utils::fs::remove(path);
+    }
+
+    static constexpr std::chrono::milliseconds clientTimeout{200};
+
+    /// Server process may not listen yet when the test connects to it
+    static constexpr int maxAttempts = 500;
+
+    Socket connect() {
+        for (int attempt = 0; ; ++attempt) {
+            try {
+                return Socket::connect(path);
+            } catch (const std::system_error&) {
+                if (attempt == maxAttempts)
+                    throw;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    bool send(const std::vector<std::string>& args, std::ostream& out) {
+        for (int attempt = 0; ; ++attempt) {
+            try {
+                return request(path, args, out);
+            } catch (const std::system_error&) {
+                if (attempt == maxAttempts)
+                    throw;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    utils::fs::path path;
+    pid_t serverPid = -1;
+};
+
+TEST_F(ServerTest, roundTrip) {
+    std::ostringstream out;
+    EXPECT_TRUE(send({"-o", "out.bc", "src.meta"}, out));
+    EXPECT_EQ(out.str(), utils::fs::current_path().string() + "\n-o\nout.bc\nsrc.meta\n");
+}
+
+TEST_F(ServerTest, requestFailure) {
+    std::ostringstream out;
+    EXPECT_FALSE(send({"fail", "src.meta"}, out));
+    EXPECT_EQ(out.str(), utils::fs::current_path().string() + "\nfail\nsrc.meta\n");
+}
+
+TEST_F(ServerTest, handlerError) {
+    std::ostringstream out;
+    EXPECT_FALSE(send({"throw"}, out));
+    EXPECT_EQ(out.str(), utils::fs::current_path().string() + "\nError: handler failure\n");
+}
+
+TEST_F(ServerTest, malformedRequest) {
+    Socket conn = connect();
+    conn.finishSending();
+    EXPECT_EQ(conn.receiveAll(), "-Error: malformed request\n");
+}
+
+TEST_F(ServerTest, clientDisconnect) {
+    {
+        Socket conn = connect();
+        conn.send("/");
+    }
+    // Server keeps serving after a client gone away in the middle of the request
+    std::ostringstream out;
+    EXPECT_TRUE(send({"src.meta"}, out));
+    EXPECT_EQ(out.str(), utils::fs::current_path().string() + "\nsrc.meta\n");
+}
+
+TEST_F(ServerTest, stalledClient) {
+    // Connection is kept open without finishing the request
+    Socket stalled = connect();
+    stalled.send("/");
+    const auto start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    EXPECT_TRUE(send({"src.meta"}, out));
+    EXPECT_EQ(out.str(), utils::fs::current_path().string() + "\nsrc.meta\n");
+    EXPECT_GE(std::chrono::steady_clock::now() - start, clientTimeout);
+    // Stalled client is disconnected without response
+    stalled.finishSending();
+    EXPECT_EQ(stalled.receiveAll(), "");
+}
+
+} // anonymous namespace
+} // namespace meta::server::tests
@@ -18,6 +18,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -35,6 +36,11 @@ constexpr static utils::string_view String = "string"sv;
 constexpr static utils::string_view Void = "void"sv;
 constexpr static utils::string_view Double = "double"sv;
 
+constexpr static utils::string_view IntArray = "int[]"sv;
+constexpr static utils::string_view BoolArray = "bool[]"sv;
+constexpr static utils::string_view DoubleArray = "double[]"sv;
+constexpr static utils::string_view StringArray = "string[]"sv;
+
 };
 
 enum class TypeProp {
@@ -47,7 +53,9 @@ enum class TypeProp {
     sum,
     array,
     namedComponents,
-    sret
+    sret,
+    /// Values share memory block released when the last reference to it is released
+    refcounted
 };
 using TypeProps = utils::Bitmask<TypeProp>;
 constexpr
@@ -55,6 +63,8 @@ TypeProps operator| (TypeProp lhs, TypeProp rhs) {
     return TypeProps{lhs} | rhs;
 }
 
+class Aggregate;
+
 class Type {
 public:
     enum TypeId {
@@ -66,20 +76,124 @@ public:
         Int,
         Bool,
         Double,
-        String
+        String,
+        /// Refcounted array of elements of some other built in type or struct backed by meta-rt
+        Array,
+
+        // User defined types
+        /// Value type composed of named fields described by Aggregate
+        Struct
     };
 
-    constexpr Type(TypeId id): mId(id) {}
+    constexpr Type(TypeId id): mId(id), mElement(Auto) {}
+    /// Struct type described by the aggregate
+    constexpr explicit Type(const Aggregate* aggregate): mId(Struct), mElement(Auto), mAggregate(aggregate) {}
+    /// Array of elements of the type specified
+    static constexpr Type arrayOf(TypeId element) {return Type{Array, element};}
+    /// Array of struct values described by the aggregate
+    static constexpr Type arrayOf(const Aggregate* element) {return Type{Array, Struct, element};}
 
     utils::string_view name() const;
     TypeId typeId() const {return mId;}
     TypeProps properties() const;
+    /// Array element type, Auto for non array types
+    Type element() const {return mElement == Struct ? Type{mAggregate} : Type{mElement};}
+    /// Fields of the struct type or the struct array element, null for other types
+    const Aggregate* aggregate() const {return mAggregate;}
 
-    bool operator== (Type rhs) const {return mId == rhs.mId;}
-    bool operator!= (Type rhs) const {return mId != rhs.mId;}
+    /// Size in bytes of the value types: numbers, bool and structs
+    size_t size() const;
+    /// Alignment in bytes of the value types: numbers, bool and structs
+    size_t alignment() const;
+
+    bool operator== (Type rhs) const {
+        return mId == rhs.mId && mElement == rhs.mElement && mAggregate == rhs.mAggregate;
+    }
+    bool operator!= (Type rhs) const {return !(*this == rhs);}
 
 private:
+    constexpr Type(TypeId id, TypeId element): mId(id), mElement(element) {}
+    constexpr Type(TypeId id, TypeId element, const Aggregate* aggregate):
+        mId(id), mElement(element), mAggregate(aggregate)
+    {}
+
     TypeId mId;
+    TypeId mElement;
+    const Aggregate* mAggregate = nullptr;
+};
+
+/**
+ * Description of a struct type: its fields in the declaration order and the way they are placed in
+ * memory. Implemented by the struct declarations.
+ */
+class Aggregate {
+public:
+    struct Field {
+        utils::string_view name;
+        Type type;
+    };
+
+    /**
+     * Placement of the elements of @soa struct arrays: values of each field are stored one after
+     * another in a column, columns follow each other in the array memory block in the order of
+     * decreasing alignment so that every column is aligned as its field.
+     */
+    struct Columns {
+        /// Field positions in the declaration order listed in the order of the columns
+        std::vector<size_t> order;
+        /// Sum of the sizes of the fields placed in the preceding columns indexed by field position in
+        /// the declaration order. Column offset in the array of N elements is N*start.
+        std::vector<size_t> starts;
+        /// Bytes taken by a single element in all the columns
+        size_t rowSize = 0;
+    };
+
+    struct Layout {
+        /// Field positions in the declaration order listed in the order they are placed in memory
+        std::vector<size_t> order;
+        /// Field offsets in bytes indexed by field position in the declaration order
+        std::vector<size_t> offsets;
+        size_t size = 0;
+        size_t alignment = 1;
+    };
+
+    virtual ~Aggregate() = default;
+
+    virtual utils::string_view typeName() const = 0;
+    virtual utils::string_view arrayTypeName() const = 0;
+
+    const std::vector<Field>& fields() const {return mFields;}
+    /// False until the types of all the fields are known
+    bool complete() const {return mComplete;}
+    void setFields(std::vector<Field>&& val) {
+        mFields = std::move(val);
+        mComplete = true;
+    }
+
+    /// Fields are placed one after another without padding
+    bool packed() const {return mPacked;}
+    void setPacked(bool val) {mPacked = val;}
+    /// Fields are placed in the order of decreasing alignment instead of the declaration order
+    bool reordered() const {return mReordered;}
+    void setReordered(bool val) {mReordered = val;}
+    /// Alignment requested explicitly or 0 for the natural alignment of the fields
+    size_t requestedAlignment() const {return mAlignment;}
+    void setRequestedAlignment(size_t val) {mAlignment = val;}
+
+    /// Arrays of the struct are stored column-wise, see Columns
+    bool soa() const {return mSoa;}
+    void setSoa(bool val) {mSoa = val;}
+
+    Layout layout() const;
+    Columns columns() const;
+
+private:
+    std::vector<Field> mFields;
+    bool mComplete = false;
+    bool mPacked = false;
+    bool mReordered = false;
+    bool mSoa = false;
+    size_t mAlignment = 0;
 };
 
 utils::array_view<Type> builtinTypes();
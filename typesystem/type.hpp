@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+
 #include "utils/contract.h"
 #include "utils/exception.h"
 
@@ -15,6 +18,19 @@ utils::string_view Type::name() const {
     case Bool: return BuiltinType::Bool;
     case Double: return BuiltinType::Double;
     case String: return BuiltinType::String;
+    case Array:
+        switch (mElement) {
+        case Int: return BuiltinType::IntArray;
+        case Bool: return BuiltinType::BoolArray;
+        case Double: return BuiltinType::DoubleArray;
+        case String: return BuiltinType::StringArray;
+        case Struct: return mAggregate->arrayTypeName();
+        case Auto:
+        case Void:
+        case Array: break;
+        }
+        break;
+    case Struct: return mAggregate->typeName();
     }
     assert(false);
     return {};
@@ -26,12 +42,86 @@ TypeProps Type::properties() const {
     case Int: return TypeProp::complete | TypeProp::primitive | TypeProp::numeric;
     case Bool: return TypeProp::complete | TypeProp::primitive | TypeProp::boolean;
     case Double: return TypeProp::complete | TypeProp::primitive | TypeProp::numeric;
-    case String: return TypeProp::complete | TypeProp::primitive | TypeProp::sret;
+    case String: return TypeProp::complete | TypeProp::primitive | TypeProp::sret | TypeProp::refcounted;
+    case Array: return TypeProp::complete | TypeProp::array | TypeProp::sret | TypeProp::refcounted;
+    case Struct: return TypeProp::complete | TypeProp::namedComponents | TypeProp::sret;
     case Auto: break;
     }
     return {};
 }
 
+size_t Type::size() const {
+    switch (mId) {
+    case Int: return 4;
+    case Bool: return 1;
+    case Double: return 8;
+    case Struct: return mAggregate->layout().size;
+    case Auto:
+    case Void:
+    case String:
+    case Array: break;
+    }
+    assert(false);
+    return 0;
+}
+
+size_t Type::alignment() const {
+    if (mId == Struct)
+        return mAggregate->layout().alignment;
+    return size();
+}
+
+namespace {
+
+size_t alignUp(size_t offset, size_t alignment) {
+    return (offset + alignment - 1)/alignment*alignment;
+}
+
+} // anonymous namespace
+
+Aggregate::Layout Aggregate::layout() const {
+    PRECONDITION(mComplete);
+    Layout res;
+    res.order.resize(mFields.size());
+    std::iota(res.order.begin(), res.order.end(), 0);
+    // Sorting by decreasing alignment leaves no padding between fields since all the alignments are
+    // powers of two. Stable sort keeps the declaration order of the fields with the same alignment.
+    if (mReordered) {
+        std::stable_sort(res.order.begin(), res.order.end(), [this](size_t lhs, size_t rhs) {
+            return mFields[lhs].type.alignment() > mFields[rhs].type.alignment();
+        });
+    }
+    res.offsets.resize(mFields.size());
+    for (size_t pos: res.order) {
+        const size_t alignment = mPacked ? 1 : mFields[pos].type.alignment();
+        res.size = alignUp(res.size, alignment);
+        res.offsets[pos] = res.size;
+        res.size += mFields[pos].type.size();
+        res.alignment = std::max(res.alignment, alignment);
+    }
+    res.alignment = std::max(res.alignment, mAlignment);
+    res.size = alignUp(res.size, res.alignment);
+    return res;
+}
+
+Aggregate::Columns Aggregate::columns() const {
+    PRECONDITION(mComplete);
+    Columns res;
+    res.order.resize(mFields.size());
+    std::iota(res.order.begin(), res.order.end(), 0);
+    // Column sizes are multiples of their alignments which are powers of two so the columns with
+    // greater alignment placed first keep the following ones aligned for any number of elements.
+    std::stable_sort(res.order.begin(), res.order.end(), [this](size_t lhs, size_t rhs) {
+        return mFields[lhs].type.alignment() > mFields[rhs].type.alignment();
+    });
+    res.starts.resize(mFields.size());
+    for (size_t pos: res.order) {
+        res.starts[pos] = res.rowSize;
+        res.rowSize += mFields[pos].type.size();
+    }
+    return res;
+}
+
 utils::array_view<Type> builtinTypes() {
     static const Type types[] = {
         Type::Auto,
@@ -39,7 +129,11 @@ utils::array_view<Type> builtinTypes() {
         Type::Int,
         Type::Bool,
         Type::Double,
-        Type::String
+        Type::String,
+        Type::arrayOf(Type::Int),
+        Type::arrayOf(Type::Bool),
+        Type::arrayOf(Type::Double),
+        Type::arrayOf(Type::String)
     };
     return types;
 }
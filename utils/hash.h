@@ -0,0 +1,100 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "utils/types.h"
+
+namespace meta::utils {
+
+/**
+ * 64 bit FNV-1a hash. Not cryptographically strong, use Sha256 where collision would silently
+ * produce wrong results.
+ */
+class Hasher {
+public:
+    Hasher& update(string_view data) {
+        for (unsigned char ch: data) {
+            mVal ^= ch;
+            mVal *= prime;
+        }
+        return *this;
+    }
+
+    /// Hashes data with its size so that sequences of fields are hashed unambiguously
+    Hasher& field(string_view data) {
+        uint64_t sz = data.size();
+        for (size_t i = 0; i < sizeof(sz); ++i, sz >>= 8) {
+            mVal ^= (sz & 0xff);
+            mVal *= prime;
+        }
+        return update(data);
+    }
+
+    uint64_t value() const {return mVal;}
+
+    std::string hex() const {
+        constexpr char digits[] = "0123456789abcdef";
+        std::string res(2*sizeof(mVal), '0');
+        uint64_t val = mVal;
+        for (auto it = res.rbegin(); it != res.rend(); ++it, val >>= 4)
+            *it = digits[val & 0xf];
+        return res;
+    }
+
+private:
+    static constexpr uint64_t prime = 1099511628211ull;
+    uint64_t mVal = 14695981039346656037ull;
+};
+
+/**
+ * SHA-256 hash used to key compilation cache entries: cached results are reused when keys match
+ * without any further checks.
+ */
+class Sha256 {
+public:
+    Sha256();
+
+    Sha256& update(string_view data);
+    /// Hashes data with its size so that sequences of fields are hashed unambiguously
+    Sha256& field(string_view data);
+
+    /// Finishes hashing, no more data can be added after this call
+    std::string hex();
+
+private:
+    void compress(const unsigned char* block);
+
+    std::array<uint32_t, 8> mState;
+    std::array<unsigned char, 64> mBlock;
+    size_t mBlockSize = 0;
+    uint64_t mTotalSize = 0;
+    bool mFinished = false;
+};
+
+inline
+std::string hash(string_view data) {
+    return Sha256{}.update(data).hex();
+}
+
+} // namespace meta::utils
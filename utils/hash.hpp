@@ -0,0 +1,139 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+
+#include "utils/contract.h"
+#include "utils/hash.h"
+
+namespace meta::utils {
+
+namespace {
+
+constexpr uint32_t sha256Rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t val, unsigned bits) {
+    return (val >> bits) | (val << (32 - bits));
+}
+
+} // anonymous namespace
+
+Sha256::Sha256(): mState{{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+}} {}
+
+Sha256& Sha256::update(string_view data) {
+    PRECONDITION(!mFinished);
+    mTotalSize += data.size();
+    for (unsigned char ch: data) {
+        mBlock[mBlockSize++] = ch;
+        if (mBlockSize == mBlock.size()) {
+            compress(mBlock.data());
+            mBlockSize = 0;
+        }
+    }
+    return *this;
+}
+
+Sha256& Sha256::field(string_view data) {
+    unsigned char sz[sizeof(uint64_t)];
+    uint64_t val = data.size();
+    for (size_t i = 0; i < sizeof(sz); ++i, val >>= 8)
+        sz[i] = static_cast<unsigned char>(val & 0xff);
+    update({reinterpret_cast<const char*>(sz), sizeof(sz)});
+    return update(data);
+}
+
+std::string Sha256::hex() {
+    if (!mFinished) {
+        const uint64_t bits = mTotalSize*8;
+        mBlock[mBlockSize++] = 0x80;
+        if (mBlockSize > mBlock.size() - sizeof(bits)) {
+            std::fill(mBlock.begin() + mBlockSize, mBlock.end(), 0);
+            compress(mBlock.data());
+            mBlockSize = 0;
+        }
+        std::fill(mBlock.begin() + mBlockSize, mBlock.end() - sizeof(bits), 0);
+        for (size_t i = 0; i < sizeof(bits); ++i)
+            mBlock[mBlock.size() - 1 - i] = static_cast<unsigned char>((bits >> 8*i) & 0xff);
+        compress(mBlock.data());
+        mFinished = true;
+    }
+    constexpr char digits[] = "0123456789abcdef";
+    std::string res;
+    res.reserve(2*sizeof(uint32_t)*mState.size());
+    for (uint32_t word: mState) {
+        for (int shift = 28; shift >= 0; shift -= 4)
+            res.push_back(digits[(word >> shift) & 0xf]);
+    }
+    return res;
+}
+
+void Sha256::compress(const unsigned char* block) {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] =
+            uint32_t{block[4*i]} << 24 | uint32_t{block[4*i + 1]} << 16 |
+            uint32_t{block[4*i + 2]} << 8 | uint32_t{block[4*i + 3]}
+        ;
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+    uint32_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+    for (size_t i = 0; i < 64; ++i) {
+        const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        const uint32_t ch = (e & f) ^ (~e & g);
+        const uint32_t tmp1 = h + s1 + ch + sha256Rounds[i] + w[i];
+        const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t tmp2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + tmp1;
+        d = c;
+        c = b;
+        b = a;
+        a = tmp1 + tmp2;
+    }
+    mState[0] += a;
+    mState[1] += b;
+    mState[2] += c;
+    mState[3] += d;
+    mState[4] += e;
+    mState[5] += f;
+    mState[6] += g;
+    mState[7] += h;
+}
+
+} // namespace meta::utils
@@ -1,2 +1,3 @@
 #include "exception.hpp"
+#include "hash.hpp"
 #include "term.hpp"
@@ -15,6 +15,11 @@ public:
         mPath(std::move(path)),
         mContent(readAll(mPath))
     {}
+    /// Source which content is provided by the caller, e.g. compiled module file
+    SourceFile(fs::path path, std::string content):
+        mPath(std::move(path)),
+        mContent(std::move(content))
+    {}
 
 #if defined(META_UNIT_TEST)
     static SourceFile fake(std::string&& content, utils::fs::path&& path = "test.meta") {
@@ -0,0 +1,71 @@
+/*
+ * Meta language compiler
+ * Copyright (C) 2016  Sergey Vidyuk <sir.vestnik@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include "utils/hash.h"
+
+namespace meta::utils {
+namespace {
+
+TEST(Hasher, fnv1aVectors) {
+    EXPECT_EQ(Hasher{}.value(), 0xcbf29ce484222325ull);
+    EXPECT_EQ(Hasher{}.update("a").value(), 0xaf63dc4c8601ec8cull);
+    EXPECT_EQ(Hasher{}.update("foobar").value(), 0x85944171f73967e8ull);
+}
+
+TEST(Hasher, incremental) {
+    EXPECT_EQ(Hasher{}.update("foo").update("bar").value(), Hasher{}.update("foobar").value());
+}
+
+TEST(Hasher, fieldsAreUnambiguous) {
+    EXPECT_NE(Hasher{}.field("foo").field("bar").value(), Hasher{}.field("fo").field("obar").value());
+}
+
+TEST(Hasher, hex) {
+    EXPECT_EQ(Hasher{}.hex(), "cbf29ce484222325");
+}
+
+TEST(Sha256, vectors) {
+    EXPECT_EQ(Sha256{}.hex(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(Sha256{}.update("abc").hex(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    // Padding doesn't fit into the last block
+    EXPECT_EQ(
+        Sha256{}.update("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").hex(),
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+    );
+    EXPECT_EQ(
+        Sha256{}.update(std::string(1000000, 'a')).hex(),
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"
+    );
+    EXPECT_EQ(hash("a"), "ca978112ca1bbdcafac231b39a23dc4da786eff8147c4e72b9807785afee48bb");
+}
+
+TEST(Sha256, incremental) {
+    EXPECT_EQ(Sha256{}.update("foo").update("bar").hex(), Sha256{}.update("foobar").hex());
+    Sha256 hasher;
+    hasher.update("foo");
+    EXPECT_EQ(hasher.hex(), hasher.hex());
+}
+
+TEST(Sha256, fieldsAreUnambiguous) {
+    EXPECT_NE(Sha256{}.field("foo").field("bar").hex(), Sha256{}.field("fo").field("obar").hex());
+}
+
+} // anonymous namespace
+} // namespace meta::utils